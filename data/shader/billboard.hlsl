@@ -7,7 +7,22 @@ cbuffer VSBuffer : register(b0) // Register the constant buffer on slot 0
     float4x4 g_ViewProjectionMatrix;
     float3 g_WSCameraPosition;
     float3 g_WSLightPosition;
-    float3 g_WSBillboardPosition;
+};
+
+// -----------------------------------------------------------------------------
+// The constants of all billboards of a frame are uploaded at once into the
+// object buffer. Per draw only the index of its constants is uploaded.
+// -----------------------------------------------------------------------------
+#define MAX_NUMBER_OF_OBJECT_REGISTERS 4096
+
+cbuffer DrawBuffer : register(b1)
+{
+    int g_IndexOfObject;
+};
+
+cbuffer ObjectBuffer : register(b2)
+{
+    float4 g_ObjectConstants[MAX_NUMBER_OF_OBJECT_REGISTERS]; // xyz: World Space Billboard Position
 };
 
 cbuffer PSBuffer : register(b0) // Register the constant buffer in the pixel constant buffer state on slot 0
@@ -16,6 +31,34 @@ cbuffer PSBuffer : register(b0) // Register the constant buffer in the pixel con
     float4 g_DiffuseLightColor;
     float4 g_SpecularLightColor;
     float g_SpecularExponent;
+    float g_UseNormalMap; // 0 skips the normal map and uses the normal of the quad
+};
+
+// -----------------------------------------------------------------------------
+// Clustered point lights, see 'clustered_lighting.h'. The index list of a
+// cluster holds the lights touching it, eight 16 bit indices are packed per
+// uint4.
+// -----------------------------------------------------------------------------
+#define MAX_NUMBER_OF_POINT_LIGHTS 1024
+#define NUMBER_OF_CLUSTERS 2048
+#define MAX_NUMBER_OF_LIGHT_INDICES 32768
+
+cbuffer LightBuffer : register(b1)
+{
+    float4 g_LightPositionRadius[MAX_NUMBER_OF_POINT_LIGHTS]; // World space position and radius
+    float4 g_LightColor[MAX_NUMBER_OF_POINT_LIGHTS];
+};
+
+cbuffer ClusterBuffer : register(b2)
+{
+    float4 g_ClusterScale; // Pixel to tile scale in x and y, log(depth) to slice scale and bias
+    uint4 g_NumberOfClusters;
+    uint4 g_ClusterCells[NUMBER_OF_CLUSTERS / 4]; // Offset in the low and number of lights in the high 16 bits
+};
+
+cbuffer LightIndexBuffer : register(b3)
+{
+    uint4 g_LightIndices[MAX_NUMBER_OF_LIGHT_INDICES / 8];
 };
 
 // -----------------------------------------------------------------------------
@@ -51,6 +94,8 @@ struct PSInput
     float3 m_WSView : TEXCOORD2; // World Space View
     float3 m_WSLight : TEXCOORD3; // World Space Light
     float2 m_TexCoord : TEXCOORD4; // Actual Texture Coordinate
+    float3 m_WSPosition : TEXCOORD5; // World Space Position
+    float m_ViewDepth : TEXCOORD6; // Distance to the camera plane, selects the cluster
 };
 
 // -----------------------------------------------------------------------------
@@ -59,6 +104,8 @@ struct PSInput
 PSInput VSShader(VSInput _Input)
 {
     PSInput Output = (PSInput) 0;
+
+    float3 WSBillboardPosition = g_ObjectConstants[g_IndexOfObject].xyz;
     
     // Rotation only happens around the y axis as the billboard will
     // always look "straight" at the camera
@@ -66,7 +113,7 @@ PSInput VSShader(VSInput _Input)
     yBaseVector = normalize(yBaseVector);
     
     // the zBaseVector describes the negative direction of where the camera is looking
-    float3 zBaseVector = g_WSBillboardPosition - g_WSCameraPosition;
+    float3 zBaseVector = WSBillboardPosition - g_WSCameraPosition;
     zBaseVector.y = 0.0f;
     zBaseVector = normalize(zBaseVector);
     
@@ -86,12 +133,14 @@ PSInput VSShader(VSInput _Input)
 	// -------------------------------------------------------------------------------
 	// Get the world space position.
 	// -------------------------------------------------------------------------------
-    float3 WSPosition = g_WSBillboardPosition + mul(_Input.m_OSPosition, rotationMatrix);
+    float3 WSPosition = WSBillboardPosition + mul(_Input.m_OSPosition, rotationMatrix);
 
 	// -------------------------------------------------------------------------------
 	// Get the clip space position.
 	// -------------------------------------------------------------------------------
     Output.m_CSPosition = mul(float4(WSPosition, 1.0f), g_ViewProjectionMatrix);
+    Output.m_WSPosition = WSPosition;
+    Output.m_ViewDepth = Output.m_CSPosition.w;
     
     // -------------------------------------------------------------------------------
 	// Get world space values from the object space positions.
@@ -145,10 +194,13 @@ float4 PSShader(PSInput _Input) : SV_Target
 
     // The normal map has rgb values between 0..255, those need to be
     // mapped to values between -1..1 and for b (z-axis) between 0..1
-    TSNormal = g_NormalMap.Sample(g_ColorMapSampler, _Input.m_TexCoord).rgb * 2.0f - 1.0f;
-    // Convert the normal map which is in tangent space to world space coordinates
-    WSNormal = mul(TSNormal, TS2WSMatrix);
-    WSNormal = normalize(WSNormal);
+    if (g_UseNormalMap > 0.5f)
+    {
+        TSNormal = g_NormalMap.Sample(g_ColorMapSampler, _Input.m_TexCoord).rgb * 2.0f - 1.0f;
+        // Convert the normal map which is in tangent space to world space coordinates
+        WSNormal = mul(TSNormal, TS2WSMatrix);
+        WSNormal = normalize(WSNormal);
+    }
 
     // Calculate light values based on good values
     AmbientLight = g_AmbientLightColor;
@@ -156,6 +208,37 @@ float4 PSShader(PSInput _Input) : SV_Target
     SpecularLight = g_SpecularLightColor * pow(max(dot(WSNormal, WSHalf), 0.0f), g_SpecularExponent);
 	
     Light = AmbientLight + DiffuseLight + SpecularLight;
+
+    // Find the cluster of this pixel and add the point lights touching it
+    uint3 Cluster;
+    Cluster.x = min((uint) (_Input.m_CSPosition.x * g_ClusterScale.x), g_NumberOfClusters.x - 1);
+    Cluster.y = min((uint) (_Input.m_CSPosition.y * g_ClusterScale.y), g_NumberOfClusters.y - 1);
+    Cluster.z = (uint) clamp(log(_Input.m_ViewDepth) * g_ClusterScale.z + g_ClusterScale.w, 0.0f, g_NumberOfClusters.z - 1.0f);
+
+    uint IndexOfCluster = (Cluster.z * g_NumberOfClusters.y + Cluster.y) * g_NumberOfClusters.x + Cluster.x;
+    uint Cell = g_ClusterCells[IndexOfCluster >> 2][IndexOfCluster & 3];
+    uint Offset = Cell & 0xffff;
+    uint NumberOfLights = Cell >> 16;
+
+    for (uint IndexOfEntry = Offset; IndexOfEntry < Offset + NumberOfLights; ++IndexOfEntry)
+    {
+        uint PackedIndices = g_LightIndices[IndexOfEntry >> 3][(IndexOfEntry >> 1) & 3];
+        uint IndexOfLight = (PackedIndices >> ((IndexOfEntry & 1) * 16)) & 0xffff;
+
+        float3 WSPointLight = g_LightPositionRadius[IndexOfLight].xyz - _Input.m_WSPosition;
+        float Distance = length(WSPointLight);
+
+        // Fade out smoothly towards the radius of the light
+        float Attenuation = saturate(1.0f - Distance / g_LightPositionRadius[IndexOfLight].w);
+        Attenuation *= Attenuation;
+
+        WSPointLight /= max(Distance, 0.0001f);
+
+        float3 WSPointHalf = normalize(WSView + WSPointLight);
+
+        Light += g_LightColor[IndexOfLight] * Attenuation * max(dot(WSNormal, WSPointLight), 0.0f);
+        Light += g_SpecularLightColor * g_LightColor[IndexOfLight] * Attenuation * pow(max(dot(WSNormal, WSPointHalf), 0.0f), g_SpecularExponent);
+    }
     
     // Render the given texture
     return g_ColorMap.Sample(g_ColorMapSampler, _Input.m_TexCoord) * Light;
@@ -0,0 +1,103 @@
+
+#include "allocation_counter.h"
+
+#include <stdlib.h>
+#include <atomic>
+#include <new>
+
+namespace
+{
+	std::atomic<long long> g_NumberOfAllocations(0);
+	std::atomic<long long> g_NumberOfBytes(0);
+
+	// -----------------------------------------------------------------------------
+
+	void* Allocate(size_t _NumberOfBytes)
+	{
+		g_NumberOfAllocations.fetch_add(1, std::memory_order_relaxed);
+		g_NumberOfBytes.fetch_add(static_cast<long long>(_NumberOfBytes), std::memory_order_relaxed);
+
+		void* pMemory = malloc(_NumberOfBytes > 0 ? _NumberOfBytes : 1);
+
+		if(pMemory == nullptr)
+		{
+			throw std::bad_alloc();
+		}
+
+		return pMemory;
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+void GetAllocationCounters(SAllocationCounters& _rCounters)
+{
+	_rCounters.m_NumberOfAllocations = g_NumberOfAllocations.load(std::memory_order_relaxed);
+	_rCounters.m_NumberOfBytes       = g_NumberOfBytes.load(std::memory_order_relaxed);
+}
+
+// -----------------------------------------------------------------------------
+
+void* operator new(size_t _NumberOfBytes)
+{
+	return Allocate(_NumberOfBytes);
+}
+
+void* operator new[](size_t _NumberOfBytes)
+{
+	return Allocate(_NumberOfBytes);
+}
+
+void* operator new(size_t _NumberOfBytes, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return Allocate(_NumberOfBytes);
+	}
+	catch(const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void* operator new[](size_t _NumberOfBytes, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return Allocate(_NumberOfBytes);
+	}
+	catch(const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void operator delete(void* _pMemory) noexcept
+{
+	free(_pMemory);
+}
+
+void operator delete[](void* _pMemory) noexcept
+{
+	free(_pMemory);
+}
+
+void operator delete(void* _pMemory, size_t) noexcept
+{
+	free(_pMemory);
+}
+
+void operator delete[](void* _pMemory, size_t) noexcept
+{
+	free(_pMemory);
+}
+
+void operator delete(void* _pMemory, const std::nothrow_t&) noexcept
+{
+	free(_pMemory);
+}
+
+void operator delete[](void* _pMemory, const std::nothrow_t&) noexcept
+{
+	free(_pMemory);
+}
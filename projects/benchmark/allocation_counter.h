@@ -0,0 +1,18 @@
+
+#pragma once
+
+// -----------------------------------------------------------------------------
+// Counts the heap allocations of the whole process. The benchmark replaces the
+// global 'operator new' and 'operator delete' with versions which forward to
+// 'malloc' and 'free' and count each call. Allocations with 'malloc' directly
+// are not counted. The counters only ever grow, measure by taking the
+// difference of two snapshots.
+// -----------------------------------------------------------------------------
+
+struct SAllocationCounters
+{
+	long long m_NumberOfAllocations;
+	long long m_NumberOfBytes;          // The bytes requested by the allocations.
+};
+
+void GetAllocationCounters(SAllocationCounters& _rCounters);
@@ -0,0 +1,586 @@
+
+#include "yoshix.h"
+#include "allocation_counter.h"
+#include "application.h"
+#include "clustered_lighting.h"
+#include "forest.h"
+#include "parallel.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace gfx;
+
+// -----------------------------------------------------------------------------
+// Command line tool which measures the CPU side of the engine without opening a
+// window. By default it bins growing numbers of point lights into the clusters
+// of a fixed view, once on a single thread and once on all cores.
+//
+//     benchmark [-f <frames per measurement>]
+//     benchmark -replay <input file> [-timings <csv file>]
+//     benchmark -stress [-f <frames>] [-billboards <n,n,...>] [-threads <n,n,...>]
+//               [-density <billboards per square unit>] [-walls <share of walls>]
+//               [-level <quality level>] [-label <text>] [-csv <csv file>]
+//
+// With '-replay' it runs the billboard application on the input recorded with
+// 'billboard -record'. The headless YoshiX neither draws nor waits for the
+// vertical blank, so the frame times are the pure CPU cost of the frames.
+//
+// With '-stress' it generates forests of 1k to 10M billboards and runs the
+// frames of the billboard application along scripted camera paths, once for
+// each number of threads. Every run prints one CSV row with the average time
+// of the frame stages, the frame time percentiles, the heap allocations per
+// frame and the speedup over the first number of threads. The label, e.g. the
+// commit, is copied into each row, so the rows of several commits can be
+// collected in one file and compared.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+	// -----------------------------------------------------------------------------
+	// Spreads the lights over the same area as the point lights of the billboard
+	// application, so the numbers match what the application sees.
+	// -----------------------------------------------------------------------------
+	void CreateLights(int _NumberOfLights, std::vector<SPointLight>& _rLights)
+	{
+		std::mt19937 Random(1234);
+		std::uniform_real_distribution<float> Uniform(0.0f, 1.0f);
+
+		_rLights.resize(_NumberOfLights);
+
+		for(SPointLight& rLight : _rLights)
+		{
+			rLight.m_Position[0] = -32.0f + 64.0f * Uniform(Random);
+			rLight.m_Position[2] = -32.0f + 64.0f * Uniform(Random);
+			rLight.m_Position[1] = -0.5f + Uniform(Random);
+			rLight.m_Radius      = 2.0f + 2.0f * Uniform(Random);
+			rLight.m_Color[0]    = 1.0f;
+			rLight.m_Color[1]    = 0.5f + 0.3f * Uniform(Random);
+			rLight.m_Color[2]    = 0.2f + 0.2f * Uniform(Random);
+			rLight.m_Intensity   = 1.0f;
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+
+	void BenchmarkLightBinning(int _NumberOfFrames)
+	{
+		const int Width  = 800;
+		const int Height = 600;
+
+		float ViewMatrix[16];
+		float ProjectionMatrix[16];
+
+		float Eye[3] = { 0.0f, 1.2f, -5.0f };
+		float At[3]  = { 0.0f, 0.0f,  0.0f };
+		float Up[3]  = { 0.0f, 1.0f,  0.0f };
+
+		GetViewMatrix(Eye, At, Up, ViewMatrix);
+		GetProjectionMatrix(60.0f, static_cast<float>(Width) / static_cast<float>(Height), 0.1f, 100.0f, ProjectionMatrix);
+
+		std::cout << "Light binning, " << g_NumberOfClustersX << " x " << g_NumberOfClustersY << " x " << g_NumberOfClustersZ << " clusters, " << _NumberOfFrames << " frames per row" << std::endl;
+		std::cout << std::setw(8) << "lights" << std::setw(10) << "visible" << std::setw(10) << "indices" << std::setw(10) << "max" << std::setw(10) << "dropped" << std::setw(14) << "1 thread ms" << std::setw(14) << "all cores ms" << std::endl;
+
+		for(int NumberOfLights = 1; NumberOfLights <= g_MaxNumberOfPointLights; NumberOfLights *= 2)
+		{
+			std::vector<SPointLight> Lights;
+
+			CreateLights(NumberOfLights, Lights);
+
+			double Times[2];
+
+			CClusteredLighting ClusteredLighting;
+
+			for(int IndexOfRun = 0; IndexOfRun < 2; ++ IndexOfRun)
+			{
+				SClusteredLightingSettings Settings;
+
+				Settings.m_NumberOfThreads = IndexOfRun == 0 ? 1 : 0;
+
+				ClusteredLighting.Create(Settings);
+
+				// Warm up the caches and the allocations of the first frame.
+				ClusteredLighting.Update(ViewMatrix, ProjectionMatrix, Width, Height, Lights.data(), NumberOfLights);
+
+				std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+				for(int IndexOfFrame = 0; IndexOfFrame < _NumberOfFrames; ++ IndexOfFrame)
+				{
+					ClusteredLighting.Update(ViewMatrix, ProjectionMatrix, Width, Height, Lights.data(), NumberOfLights);
+				}
+
+				Times[IndexOfRun] = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count() / _NumberOfFrames;
+			}
+
+			const SClusteredLightingStatistics& rStatistics = ClusteredLighting.GetStatistics();
+
+			std::cout << std::setw(8) << NumberOfLights
+			          << std::setw(10) << rStatistics.m_NumberOfVisibleLights
+			          << std::setw(10) << rStatistics.m_NumberOfLightIndices
+			          << std::setw(10) << rStatistics.m_MaxLightsInCluster
+			          << std::setw(10) << rStatistics.m_NumberOfDroppedIndices
+			          << std::setw(14) << std::fixed << std::setprecision(4) << Times[0]
+			          << std::setw(14) << Times[1] << std::endl;
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+
+	bool BenchmarkReplay(const char* _pReplayFileName, const char* _pTimingFileName)
+	{
+		int Width;
+		int Height;
+
+		CApplication Application;
+
+		if(!Application.StartReplay(_pReplayFileName, _pTimingFileName, Width, Height))
+		{
+			return false;
+		}
+
+		RunApplication(Width, Height, "benchmark", &Application);
+
+		return true;
+	}
+
+	// -----------------------------------------------------------------------------
+
+	struct SStressSettings
+	{
+		SStressSettings()
+			: m_NumberOfFrames      (60)
+			, m_NumberOfWarmUpFrames(10)
+			, m_QualityLevel        (0)
+		{
+		}
+
+		std::vector<int> m_NumberOfBillboards;  // One forest for each number.
+		std::vector<int> m_NumberOfThreads;     // One run on each path for each number.
+		SForestSettings  m_Forest;
+		int              m_NumberOfFrames;
+		int              m_NumberOfWarmUpFrames;
+		int              m_QualityLevel;        // Fixed, so every run does the same work.
+		std::string      m_Label;
+		std::string      m_CSVFileName;
+	};
+
+	struct SCameraPath
+	{
+		enum EType
+		{
+			Orbit,                              // Circles through the forest at eye height.
+			Dolly,                              // Walks from the edge of the forest to its center.
+			Overview,                           // Circles high above, looking down on many billboards.
+			NumberOfTypes,
+		};
+	};
+
+	const char* g_pCameraPathNames[SCameraPath::NumberOfTypes] = { "orbit", "dolly", "overview" };
+
+	// -----------------------------------------------------------------------------
+	// Places the camera on the path, the time runs from 0 to 1. The camera always
+	// looks at the center of the forest.
+	// -----------------------------------------------------------------------------
+	void SetCameraOnPath(CApplication& _rApplication, SCameraPath::EType _Path, float _Time, float _ForestSize)
+	{
+		float Radius = std::max(std::min(0.25f * _ForestSize, 30.0f), 4.0f);
+
+		switch(_Path)
+		{
+			case SCameraPath::Orbit:
+				_rApplication.SetCameraOrbit(Radius, 6.2831853f * _Time, 1.2f);
+				break;
+
+			case SCameraPath::Dolly:
+				_rApplication.SetCameraOrbit(std::max(0.45f * _ForestSize, 4.0f) * (1.0f - _Time) + 2.0f * _Time, 0.5f, 1.2f);
+				break;
+
+			default:
+				_rApplication.SetCameraOrbit(Radius, 6.2831853f * _Time, 40.0f);
+				break;
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+
+	double GetPercentile(std::vector<double> _Values, double _Percentile)
+	{
+		if(_Values.empty())
+		{
+			return 0.0;
+		}
+
+		size_t Index = std::min(static_cast<size_t>(_Percentile * _Values.size()), _Values.size() - 1);
+
+		std::nth_element(_Values.begin(), _Values.begin() + Index, _Values.end());
+
+		return _Values[Index];
+	}
+
+	// -----------------------------------------------------------------------------
+
+	void WriteStressHeader(std::ostream& _rStream)
+	{
+		_rStream << "label,billboards,walls,density,size,path,threads,frames,"
+		         << "update_ms,terrain_ms,lighting_ms,occluders_ms,culling_ms,submit_ms,streaming_ms,"
+		         << "frame_ms,frame_p50_ms,frame_p95_ms,frame_max_ms,speedup,"
+		         << "allocations_per_frame,bytes_per_frame,occluders,visible,drawn,generation_ms" << std::endl;
+	}
+
+	// -----------------------------------------------------------------------------
+
+	bool BenchmarkStress(const SStressSettings& _rSettings)
+	{
+		const int Width  = 800;
+		const int Height = 600;
+
+		std::ofstream CSVFile;
+
+		if(!_rSettings.m_CSVFileName.empty())
+		{
+			CSVFile.open(_rSettings.m_CSVFileName.c_str());
+
+			if(!CSVFile)
+			{
+				std::cout << "Can not write " << _rSettings.m_CSVFileName << std::endl;
+
+				return false;
+			}
+
+			WriteStressHeader(CSVFile);
+		}
+
+		WriteStressHeader(std::cout);
+
+		for(int NumberOfBillboards : _rSettings.m_NumberOfBillboards)
+		{
+			SForestSettings   ForestSettings = _rSettings.m_Forest;
+			SForestStatistics ForestStatistics;
+
+			ForestSettings.m_NumberOfBillboards = NumberOfBillboards;
+
+			CApplication Application;
+
+			// The application keeps its own copy, so the generated one is freed right away.
+			{
+				std::vector<SBillboard> Billboards;
+
+				CreateForest(ForestSettings, Billboards, ForestStatistics);
+
+				Application.SetScene(Billboards);
+			}
+
+			Application.SetQualityLevel(_rSettings.m_QualityLevel);
+
+			// -----------------------------------------------------------------------------
+			// Same order as 'RunApplication', but the frames are driven from here to move
+			// the camera and to measure between them.
+			// -----------------------------------------------------------------------------
+			bool IsRunning = Application.OnStartup()
+			              && Application.OnCreateTextures()
+			              && Application.OnCreateConstantBuffers()
+			              && Application.OnCreateShader()
+			              && Application.OnCreateMaterials()
+			              && Application.OnCreateMeshes()
+			              && Application.OnResize(Width, Height);
+
+			for(int Path = 0; Path < SCameraPath::NumberOfTypes && IsRunning; ++ Path)
+			{
+				double FirstFrameTime = 0.0;
+
+				for(size_t IndexOfRun = 0; IndexOfRun < _rSettings.m_NumberOfThreads.size() && IsRunning; ++ IndexOfRun)
+				{
+					int NumberOfThreads = _rSettings.m_NumberOfThreads[IndexOfRun];
+
+					Application.SetNumberOfThreads(NumberOfThreads);
+
+					// Warm up the caches, the streaming and the memory the frames keep.
+					for(int IndexOfFrame = 0; IndexOfFrame < _rSettings.m_NumberOfWarmUpFrames && IsRunning; ++ IndexOfFrame)
+					{
+						SetCameraOnPath(Application, static_cast<SCameraPath::EType>(Path), 0.0f, ForestStatistics.m_Size);
+
+						IsRunning = Application.OnUpdate() && Application.OnFrame();
+					}
+
+					std::vector<SFrameStatistics> FrameStatistics;
+					std::vector<double>           FrameTimes;
+
+					FrameStatistics.reserve(_rSettings.m_NumberOfFrames);
+					FrameTimes     .reserve(_rSettings.m_NumberOfFrames);
+
+					SAllocationCounters StartCounters;
+
+					GetAllocationCounters(StartCounters);
+
+					for(int IndexOfFrame = 0; IndexOfFrame < _rSettings.m_NumberOfFrames && IsRunning; ++ IndexOfFrame)
+					{
+						SetCameraOnPath(Application, static_cast<SCameraPath::EType>(Path), static_cast<float>(IndexOfFrame) / _rSettings.m_NumberOfFrames, ForestStatistics.m_Size);
+
+						std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+						IsRunning = Application.OnUpdate() && Application.OnFrame();
+
+						FrameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count());
+
+						FrameStatistics.push_back(Application.GetFrameStatistics());
+					}
+
+					SAllocationCounters EndCounters;
+
+					GetAllocationCounters(EndCounters);
+
+					// -----------------------------------------------------------------------------
+					// Average the stages over the frames of the run.
+					// -----------------------------------------------------------------------------
+					SFrameStatistics Average = SFrameStatistics();
+					double           Counts[3] = { 0.0, 0.0, 0.0 };
+					double           FrameTime = 0.0;
+
+					for(size_t IndexOfFrame = 0; IndexOfFrame < FrameStatistics.size(); ++ IndexOfFrame)
+					{
+						const SFrameStatistics& rFrame = FrameStatistics[IndexOfFrame];
+
+						Average.m_UpdateTime    += rFrame.m_UpdateTime;
+						Average.m_TerrainTime   += rFrame.m_TerrainTime;
+						Average.m_LightingTime  += rFrame.m_LightingTime;
+						Average.m_OccluderTime  += rFrame.m_OccluderTime;
+						Average.m_CullingTime   += rFrame.m_CullingTime;
+						Average.m_SubmitTime    += rFrame.m_SubmitTime;
+						Average.m_StreamingTime += rFrame.m_StreamingTime;
+
+						Counts[0] += rFrame.m_NumberOfOccluders;
+						Counts[1] += rFrame.m_NumberOfVisibleBillboards;
+						Counts[2] += rFrame.m_NumberOfDrawnBillboards;
+
+						FrameTime += FrameTimes[IndexOfFrame];
+					}
+
+					double NumberOfFrames = static_cast<double>(std::max(FrameTimes.size(), static_cast<size_t>(1)));
+
+					FrameTime /= NumberOfFrames;
+
+					if(IndexOfRun == 0)
+					{
+						FirstFrameTime = FrameTime;
+					}
+
+					std::ostringstream Row;
+
+					Row << _rSettings.m_Label << ',' << NumberOfBillboards << ',' << ForestStatistics.m_NumberOfWalls << ','
+					    << ForestSettings.m_Density << ',' << ForestStatistics.m_Size << ','
+					    << g_pCameraPathNames[Path] << ',' << GetNumberOfWorkerThreads(NumberOfThreads) << ',' << FrameTimes.size() << ','
+					    << std::fixed << std::setprecision(4)
+					    << Average.m_UpdateTime    / NumberOfFrames << ','
+					    << Average.m_TerrainTime   / NumberOfFrames << ','
+					    << Average.m_LightingTime  / NumberOfFrames << ','
+					    << Average.m_OccluderTime  / NumberOfFrames << ','
+					    << Average.m_CullingTime   / NumberOfFrames << ','
+					    << Average.m_SubmitTime    / NumberOfFrames << ','
+					    << Average.m_StreamingTime / NumberOfFrames << ','
+					    << FrameTime << ','
+					    << GetPercentile(FrameTimes, 0.5) << ','
+					    << GetPercentile(FrameTimes, 0.95) << ','
+					    << GetPercentile(FrameTimes, 1.0) << ','
+					    << (FrameTime > 0.0 ? FirstFrameTime / FrameTime : 0.0) << ','
+					    << std::setprecision(1)
+					    << (EndCounters.m_NumberOfAllocations - StartCounters.m_NumberOfAllocations) / NumberOfFrames << ','
+					    << (EndCounters.m_NumberOfBytes - StartCounters.m_NumberOfBytes) / NumberOfFrames << ','
+					    << Counts[0] / NumberOfFrames << ','
+					    << Counts[1] / NumberOfFrames << ','
+					    << Counts[2] / NumberOfFrames << ','
+					    << ForestStatistics.m_GenerationTime;
+
+					std::cout << Row.str() << std::endl;
+
+					if(CSVFile.is_open())
+					{
+						CSVFile << Row.str() << std::endl;
+					}
+				}
+			}
+
+			Application.OnReleaseMeshes();
+			Application.OnReleaseMaterials();
+			Application.OnReleaseShader();
+			Application.OnReleaseConstantBuffers();
+			Application.OnReleaseTextures();
+			Application.OnShutdown();
+
+			if(!IsRunning)
+			{
+				std::cout << "The application failed with " << NumberOfBillboards << " billboards" << std::endl;
+
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Reads a comma separated list of positive numbers. Returns false if the list
+	// is empty or contains something else.
+	// -----------------------------------------------------------------------------
+	bool ParseNumbers(const char* _pText, std::vector<int>& _rNumbers)
+	{
+		_rNumbers.clear();
+
+		while(*_pText != '\0')
+		{
+			char* pEnd;
+
+			long Number = strtol(_pText, &pEnd, 10);
+
+			if(pEnd == _pText || Number <= 0 || (*pEnd != ',' && *pEnd != '\0'))
+			{
+				return false;
+			}
+
+			_rNumbers.push_back(static_cast<int>(Number));
+
+			_pText = *pEnd == ',' ? pEnd + 1 : pEnd;
+		}
+
+		return !_rNumbers.empty();
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+int main(int _NumberOfArguments, char** _ppArguments)
+{
+	int             NumberOfFrames  = 0;
+	bool            IsStress        = false;
+	const char*     pReplayFileName = nullptr;
+	const char*     pTimingFileName = nullptr;
+	SStressSettings StressSettings;
+
+	StressSettings.m_NumberOfBillboards = { 1000, 10000, 100000, 1000000, 10000000 };
+
+	// One thread, then doubled up to one thread per core.
+	for(int NumberOfThreads = 1; NumberOfThreads < GetNumberOfWorkerThreads(0); NumberOfThreads *= 2)
+	{
+		StressSettings.m_NumberOfThreads.push_back(NumberOfThreads);
+	}
+
+	StressSettings.m_NumberOfThreads.push_back(GetNumberOfWorkerThreads(0));
+
+	for(int IndexOfArgument = 1; IndexOfArgument < _NumberOfArguments; ++ IndexOfArgument)
+	{
+		const char* pArgument = _ppArguments[IndexOfArgument];
+		bool        HasValue  = IndexOfArgument + 1 < _NumberOfArguments;
+
+		if(strcmp(pArgument, "-f") == 0 && HasValue)
+		{
+			NumberOfFrames = std::max(atoi(_ppArguments[++ IndexOfArgument]), 1);
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-replay") == 0 && HasValue)
+		{
+			pReplayFileName = _ppArguments[++ IndexOfArgument];
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-timings") == 0 && HasValue)
+		{
+			pTimingFileName = _ppArguments[++ IndexOfArgument];
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-stress") == 0)
+		{
+			IsStress = true;
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-billboards") == 0 && HasValue && ParseNumbers(_ppArguments[IndexOfArgument + 1], StressSettings.m_NumberOfBillboards))
+		{
+			++ IndexOfArgument;
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-threads") == 0 && HasValue && ParseNumbers(_ppArguments[IndexOfArgument + 1], StressSettings.m_NumberOfThreads))
+		{
+			++ IndexOfArgument;
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-density") == 0 && HasValue && atof(_ppArguments[IndexOfArgument + 1]) > 0.0)
+		{
+			StressSettings.m_Forest.m_Density = static_cast<float>(atof(_ppArguments[++ IndexOfArgument]));
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-walls") == 0 && HasValue)
+		{
+			StressSettings.m_Forest.m_WallRatio = std::min(std::max(static_cast<float>(atof(_ppArguments[++ IndexOfArgument])), 0.0f), 1.0f);
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-level") == 0 && HasValue)
+		{
+			StressSettings.m_QualityLevel = atoi(_ppArguments[++ IndexOfArgument]);
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-label") == 0 && HasValue)
+		{
+			StressSettings.m_Label = _ppArguments[++ IndexOfArgument];
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-csv") == 0 && HasValue)
+		{
+			StressSettings.m_CSVFileName = _ppArguments[++ IndexOfArgument];
+
+			continue;
+		}
+
+		std::cout << "Usage: benchmark [-f <frames per measurement>]" << std::endl;
+		std::cout << "       benchmark -replay <input file> [-timings <csv file>]" << std::endl;
+		std::cout << "       benchmark -stress [-f <frames>] [-billboards <n,n,...>] [-threads <n,n,...>]" << std::endl;
+		std::cout << "                 [-density <billboards per square unit>] [-walls <share of walls>]" << std::endl;
+		std::cout << "                 [-level <quality level>] [-label <text>] [-csv <csv file>]" << std::endl;
+
+		return 1;
+	}
+
+	if(pReplayFileName != nullptr)
+	{
+		return BenchmarkReplay(pReplayFileName, pTimingFileName) ? 0 : 1;
+	}
+
+	if(IsStress)
+	{
+		if(NumberOfFrames > 0)
+		{
+			StressSettings.m_NumberOfFrames = NumberOfFrames;
+		}
+
+		return BenchmarkStress(StressSettings) ? 0 : 1;
+	}
+
+	BenchmarkLightBinning(NumberOfFrames > 0 ? NumberOfFrames : 200);
+
+	return 0;
+}
@@ -0,0 +1,231 @@
+
+#include "forest.h"
+
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <random>
+
+namespace
+{
+	// The side length of the sampled tile in units of the Poisson-disk radius.
+	const float g_TileSize = 32.0f;
+
+	// Candidates tried around an active point before it is retired (Bridson's k).
+	const int g_NumberOfCandidates = 30;
+
+	// -----------------------------------------------------------------------------
+	// The distance of two points on the tile, which wraps around at its borders.
+	// -----------------------------------------------------------------------------
+	float GetSquaredTileDistance(const float* _pA, const float* _pB)
+	{
+		float DeltaX = fabsf(_pA[0] - _pB[0]);
+		float DeltaZ = fabsf(_pA[1] - _pB[1]);
+
+		DeltaX = std::min(DeltaX, g_TileSize - DeltaX);
+		DeltaZ = std::min(DeltaZ, g_TileSize - DeltaZ);
+
+		return DeltaX * DeltaX + DeltaZ * DeltaZ;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Bridson's algorithm on a tile with radius 1. The background grid has cells
+	// small enough to hold one point at most, so a candidate only has to be
+	// compared with the points of the 5 x 5 cells around it.
+	// -----------------------------------------------------------------------------
+	void SampleTile(std::mt19937& _rRandom, std::vector<float>& _rPoints)
+	{
+		std::uniform_real_distribution<float> Uniform(0.0f, 1.0f);
+
+		int   NumberOfCells = static_cast<int>(ceilf(g_TileSize * sqrtf(2.0f)));
+		float CellSize      = g_TileSize / NumberOfCells;
+
+		std::vector<int> Grid(NumberOfCells * NumberOfCells, -1);
+		std::vector<int> Active;
+
+		_rPoints.clear();
+
+		float First[2] = { Uniform(_rRandom) * g_TileSize, Uniform(_rRandom) * g_TileSize };
+
+		_rPoints.push_back(First[0]);
+		_rPoints.push_back(First[1]);
+
+		Grid[static_cast<int>(First[1] / CellSize) * NumberOfCells + static_cast<int>(First[0] / CellSize)] = 0;
+
+		Active.push_back(0);
+
+		while(!Active.empty())
+		{
+			int IndexOfActive = std::min(static_cast<int>(Uniform(_rRandom) * Active.size()), static_cast<int>(Active.size()) - 1);
+			int IndexOfPoint  = Active[IndexOfActive];
+
+			bool HasFound = false;
+
+			for(int IndexOfCandidate = 0; IndexOfCandidate < g_NumberOfCandidates && !HasFound; ++ IndexOfCandidate)
+			{
+				float Angle    = Uniform(_rRandom) * 6.2831853f;
+				float Distance = 1.0f + Uniform(_rRandom);
+
+				float Candidate[2] =
+				{
+					fmodf(_rPoints[IndexOfPoint * 2 + 0] + Distance * cosf(Angle) + g_TileSize, g_TileSize),
+					fmodf(_rPoints[IndexOfPoint * 2 + 1] + Distance * sinf(Angle) + g_TileSize, g_TileSize),
+				};
+
+				int CellX = std::min(static_cast<int>(Candidate[0] / CellSize), NumberOfCells - 1);
+				int CellZ = std::min(static_cast<int>(Candidate[1] / CellSize), NumberOfCells - 1);
+
+				bool IsFree = true;
+
+				for(int OffsetZ = -2; OffsetZ <= 2 && IsFree; ++ OffsetZ)
+				{
+					for(int OffsetX = -2; OffsetX <= 2 && IsFree; ++ OffsetX)
+					{
+						int X = (CellX + OffsetX + NumberOfCells) % NumberOfCells;
+						int Z = (CellZ + OffsetZ + NumberOfCells) % NumberOfCells;
+
+						int IndexOfNeighbor = Grid[Z * NumberOfCells + X];
+
+						IsFree = IndexOfNeighbor < 0 || GetSquaredTileDistance(Candidate, &_rPoints[IndexOfNeighbor * 2]) >= 1.0f;
+					}
+				}
+
+				if(IsFree)
+				{
+					int IndexOfNewPoint = static_cast<int>(_rPoints.size()) / 2;
+
+					_rPoints.push_back(Candidate[0]);
+					_rPoints.push_back(Candidate[1]);
+
+					Grid[CellZ * NumberOfCells + CellX] = IndexOfNewPoint;
+
+					Active.push_back(IndexOfNewPoint);
+
+					HasFound = true;
+				}
+			}
+
+			if(!HasFound)
+			{
+				Active[IndexOfActive] = Active.back();
+
+				Active.pop_back();
+			}
+		}
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+SForestSettings::SForestSettings()
+	: m_NumberOfBillboards(10000)
+	, m_Density           (0.25f)
+	, m_WallRatio         (0.1f)
+	, m_Seed              (1234)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CreateForest(const SForestSettings& _rSettings, std::vector<SBillboard>& _rBillboards, SForestStatistics& _rStatistics)
+{
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+	std::mt19937 Random(_rSettings.m_Seed);
+	std::uniform_real_distribution<float> Uniform(0.0f, 1.0f);
+	std::uniform_real_distribution<double> Selection(0.0, 1.0);
+
+	std::vector<float> TilePoints;
+
+	SampleTile(Random, TilePoints);
+
+	int NumberOfTilePoints = static_cast<int>(TilePoints.size()) / 2;
+
+	// -----------------------------------------------------------------------------
+	// Scale the tile to the requested density. The forest gets a little more area
+	// than needed, so there are enough points to draw from.
+	// -----------------------------------------------------------------------------
+	int   NumberOfBillboards = std::max(_rSettings.m_NumberOfBillboards, 0);
+	float Density            = std::max(_rSettings.m_Density, 1.0e-6f);
+	float Scale              = sqrtf(NumberOfTilePoints / (g_TileSize * g_TileSize) / Density);
+	float TileSize           = g_TileSize * Scale;
+	float Size               = sqrtf(NumberOfBillboards / Density) * 1.05f;
+	int   NumberOfTiles      = std::max(static_cast<int>(ceilf(Size / TileSize)), 1);
+	float TileOrigin         = -0.5f * NumberOfTiles * TileSize;
+	float HalfSize           =  0.5f * Size;
+
+	// -----------------------------------------------------------------------------
+	// Count the points of the tiles inside of the forest, then draw the requested
+	// number from them in one pass, each with the same probability (selection
+	// sampling). The billboards keep the order of the tiles.
+	// -----------------------------------------------------------------------------
+	long long NumberOfPoints = 0;
+
+	for(int TileZ = 0; TileZ < NumberOfTiles; ++ TileZ)
+	{
+		for(int TileX = 0; TileX < NumberOfTiles; ++ TileX)
+		{
+			for(int IndexOfPoint = 0; IndexOfPoint < NumberOfTilePoints; ++ IndexOfPoint)
+			{
+				float X = TileOrigin + TileX * TileSize + TilePoints[IndexOfPoint * 2 + 0] * Scale;
+				float Z = TileOrigin + TileZ * TileSize + TilePoints[IndexOfPoint * 2 + 1] * Scale;
+
+				NumberOfPoints += fabsf(X) < HalfSize && fabsf(Z) < HalfSize ? 1 : 0;
+			}
+		}
+	}
+
+	_rBillboards.clear();
+	_rBillboards.reserve(static_cast<size_t>(std::min(static_cast<long long>(NumberOfBillboards), NumberOfPoints)));
+
+	_rStatistics.m_NumberOfWalls = 0;
+	_rStatistics.m_NumberOfTrees = 0;
+
+	long long NumberOfSeenPoints = 0;
+
+	for(int TileZ = 0; TileZ < NumberOfTiles; ++ TileZ)
+	{
+		for(int TileX = 0; TileX < NumberOfTiles; ++ TileX)
+		{
+			for(int IndexOfPoint = 0; IndexOfPoint < NumberOfTilePoints; ++ IndexOfPoint)
+			{
+				float X = TileOrigin + TileX * TileSize + TilePoints[IndexOfPoint * 2 + 0] * Scale;
+				float Z = TileOrigin + TileZ * TileSize + TilePoints[IndexOfPoint * 2 + 1] * Scale;
+
+				if(fabsf(X) >= HalfSize || fabsf(Z) >= HalfSize)
+				{
+					continue;
+				}
+
+				long long NumberOfMissing = NumberOfBillboards - static_cast<long long>(_rBillboards.size());
+
+				if(Selection(Random) * (NumberOfPoints - NumberOfSeenPoints) < NumberOfMissing)
+				{
+					SBillboard Billboard;
+
+					Billboard.m_Position[0] = X;
+					Billboard.m_Position[1] = 0.0f;
+					Billboard.m_Position[2] = Z;
+					Billboard.m_Type        = Uniform(Random) < _rSettings.m_WallRatio ? SBillboard::Wall : SBillboard::Tree;
+
+					_rBillboards.push_back(Billboard);
+
+					if(Billboard.m_Type == SBillboard::Wall)
+					{
+						++ _rStatistics.m_NumberOfWalls;
+					}
+					else
+					{
+						++ _rStatistics.m_NumberOfTrees;
+					}
+				}
+
+				++ NumberOfSeenPoints;
+			}
+		}
+	}
+
+	_rStatistics.m_Size           = Size;
+	_rStatistics.m_MinDistance    = Scale;
+	_rStatistics.m_GenerationTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+}
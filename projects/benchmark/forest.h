@@ -0,0 +1,40 @@
+
+#pragma once
+
+#include "application.h"
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Generates large scenes for the benchmark. The billboards are placed by
+// Poisson-disk sampling, so no two of them are closer than a minimum distance
+// and the forest has no clumps or holes. Sampling millions of points directly
+// would dominate the benchmark, so a single square tile is sampled with
+// Bridson's algorithm. The tile wraps around at its borders and is repeated
+// over the area of the forest without breaking the minimum distance at the
+// seams. From the points of the tiles the requested number is drawn uniformly.
+//
+// The forest is a square centered at the origin, all billboards stand on the
+// plane y = 0.
+// -----------------------------------------------------------------------------
+
+struct SForestSettings
+{
+	SForestSettings();
+
+	int          m_NumberOfBillboards;
+	float        m_Density;             // Billboards per square unit, 0.25 places one on every 2 x 2 units.
+	float        m_WallRatio;           // The share of walls, the others are trees.
+	unsigned int m_Seed;                // The same seed creates the same forest.
+};
+
+struct SForestStatistics
+{
+	int    m_NumberOfWalls;
+	int    m_NumberOfTrees;
+	float  m_Size;                      // The side length of the forest.
+	float  m_MinDistance;               // The Poisson-disk radius, no two billboards are closer.
+	double m_GenerationTime;            // Milliseconds.
+};
+
+void CreateForest(const SForestSettings& _rSettings, std::vector<SBillboard>& _rBillboards, SForestStatistics& _rStatistics);
@@ -0,0 +1,173 @@
+
+#include "yoshix.h"
+
+#include <stdint.h>
+
+// -----------------------------------------------------------------------------
+// A YoshiX without window and GPU, so the benchmark can run the billboard
+// application unthrottled on the CPU. Resources are only handed out as handles,
+// uploads and draws do nothing. 'RunApplication' calls the application frame by
+// frame without waiting for the vertical blank until 'StopApplication' is called.
+//
+// The functions here replace the ones of 'yoshix.obj'. The linker then only
+// takes the math of 'yoshix_math.obj' from the YoshiX library.
+// -----------------------------------------------------------------------------
+
+namespace
+{
+	uintptr_t g_NextHandle           = 0;
+	bool      g_IsApplicationStopped = false;
+
+	// -----------------------------------------------------------------------------
+
+	gfx::BHandle CreateHandle()
+	{
+		return reinterpret_cast<gfx::BHandle>(++ g_NextHandle);
+	}
+} // namespace
+
+namespace gfx
+{
+	IApplication::~IApplication()
+	{
+	}
+
+	// -----------------------------------------------------------------------------
+
+	bool IApplication::OnStartup()                  { return InternOnStartup(); }
+	bool IApplication::OnShutdown()                 { return InternOnShutdown(); }
+	bool IApplication::OnCreateTextures()           { return InternOnCreateTextures(); }
+	bool IApplication::OnReleaseTextures()          { return InternOnReleaseTextures(); }
+	bool IApplication::OnCreateConstantBuffers()    { return InternOnCreateConstantBuffers(); }
+	bool IApplication::OnReleaseConstantBuffers()   { return InternOnReleaseConstantBuffers(); }
+	bool IApplication::OnCreateShader()             { return InternOnCreateShader(); }
+	bool IApplication::OnReleaseShader()            { return InternOnReleaseShader(); }
+	bool IApplication::OnCreateMaterials()          { return InternOnCreateMaterials(); }
+	bool IApplication::OnReleaseMaterials()         { return InternOnReleaseMaterials(); }
+	bool IApplication::OnCreateMeshes()             { return InternOnCreateMeshes(); }
+	bool IApplication::OnReleaseMeshes()            { return InternOnReleaseMeshes(); }
+	bool IApplication::OnUpdate()                   { return InternOnUpdate(); }
+	bool IApplication::OnFrame()                    { return InternOnFrame(); }
+
+	bool IApplication::OnResize(int _Width, int _Height)
+	{
+		return InternOnResize(_Width, _Height);
+	}
+
+	bool IApplication::OnKeyEvent(unsigned int _Key, bool _IsKeyDown, bool _IsAltDown)
+	{
+		return InternOnKeyEvent(_Key, _IsKeyDown, _IsAltDown);
+	}
+
+	bool IApplication::OnMouseEvent(int _X, int _Y, int _Button, bool _IsButtonDown, bool _IsDoubleClick, int _WheelDelta)
+	{
+		return InternOnMouseEvent(_X, _Y, _Button, _IsButtonDown, _IsDoubleClick, _WheelDelta);
+	}
+
+	// -----------------------------------------------------------------------------
+
+	bool IApplication::InternOnStartup()                { return true; }
+	bool IApplication::InternOnShutdown()               { return true; }
+	bool IApplication::InternOnCreateTextures()         { return true; }
+	bool IApplication::InternOnReleaseTextures()        { return true; }
+	bool IApplication::InternOnCreateConstantBuffers()  { return true; }
+	bool IApplication::InternOnReleaseConstantBuffers() { return true; }
+	bool IApplication::InternOnCreateShader()           { return true; }
+	bool IApplication::InternOnReleaseShader()          { return true; }
+	bool IApplication::InternOnCreateMaterials()        { return true; }
+	bool IApplication::InternOnReleaseMaterials()       { return true; }
+	bool IApplication::InternOnCreateMeshes()           { return true; }
+	bool IApplication::InternOnReleaseMeshes()          { return true; }
+	bool IApplication::InternOnUpdate()                 { return true; }
+	bool IApplication::InternOnFrame()                  { return true; }
+
+	bool IApplication::InternOnResize(int, int)
+	{
+		return true;
+	}
+
+	bool IApplication::InternOnKeyEvent(unsigned int, bool, bool)
+	{
+		return true;
+	}
+
+	bool IApplication::InternOnMouseEvent(int, int, int, bool, bool, int)
+	{
+		return true;
+	}
+} // namespace gfx
+
+namespace gfx
+{
+	void RunApplication(int _Width, int _Height, const char* _pTitle, IApplication* _pApplication)
+	{
+		(void)_pTitle;
+
+		g_IsApplicationStopped = false;
+
+		// -----------------------------------------------------------------------------
+		// Same order as YoshiX: the materials need the textures, buffers and shaders,
+		// the meshes need the materials. A failing step skips the frames.
+		// -----------------------------------------------------------------------------
+		bool IsRunning = _pApplication->OnStartup()
+		              && _pApplication->OnCreateTextures()
+		              && _pApplication->OnCreateConstantBuffers()
+		              && _pApplication->OnCreateShader()
+		              && _pApplication->OnCreateMaterials()
+		              && _pApplication->OnCreateMeshes()
+		              && _pApplication->OnResize(_Width, _Height);
+
+		while(IsRunning && !g_IsApplicationStopped)
+		{
+			IsRunning = _pApplication->OnUpdate() && _pApplication->OnFrame();
+		}
+
+		_pApplication->OnReleaseMeshes();
+		_pApplication->OnReleaseMaterials();
+		_pApplication->OnReleaseShader();
+		_pApplication->OnReleaseConstantBuffers();
+		_pApplication->OnReleaseTextures();
+		_pApplication->OnShutdown();
+	}
+
+	// -----------------------------------------------------------------------------
+
+	void StopApplication()
+	{
+		g_IsApplicationStopped = true;
+	}
+} // namespace gfx
+
+namespace gfx
+{
+	void SetClearColor(const float*)           {}
+	void SetDepthTest(SDepthTest::ETest)       {}
+	void SetWireFrame(bool)                    {}
+	void SetAlphaBlending(bool)                {}
+
+	void CreateTexture(const char*, BHandle* _ppTexture)    { *_ppTexture = CreateHandle(); }
+	void CreateColorTarget(BHandle* _ppTexture)             { *_ppTexture = CreateHandle(); }
+	void CreateDepthTarget(BHandle* _ppTexture)             { *_ppTexture = CreateHandle(); }
+	void ReleaseTexture(BHandle)                            {}
+
+	void CreateConstantBuffer(int, BHandle* _ppConstantBuffer)  { *_ppConstantBuffer = CreateHandle(); }
+	void ReleaseConstantBuffer(BHandle)                         {}
+	void UploadConstantBuffer(void*, BHandle)                   {}
+
+	void CreateVertexShader(const char*, const char*, BHandle* _ppShader)  { *_ppShader = CreateHandle(); }
+	void ReleaseVertexShader(BHandle)                                      {}
+	void CreatePixelShader(const char*, const char*, BHandle* _ppShader)   { *_ppShader = CreateHandle(); }
+	void ReleasePixelShader(BHandle)                                       {}
+
+	void CreateMaterial(const SMaterialInfo&, BHandle* _ppMaterial)  { *_ppMaterial = CreateHandle(); }
+	void ReleaseMaterial(BHandle)                                     {}
+
+	void CreateMesh(const SMeshInfo&, BHandle* _ppMesh)  { *_ppMesh = CreateHandle(); }
+	void ReleaseMesh(BHandle)                            {}
+
+	void ResetRenderTargets()                          {}
+	void SetRenderTargets(BHandle*, int, BHandle)      {}
+	void ClearColorTarget(BHandle, const float*)       {}
+	void ClearDepthTarget(BHandle, float)              {}
+	void DrawMesh(BHandle)                             {}
+} // namespace gfx
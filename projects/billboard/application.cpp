@@ -0,0 +1,1383 @@
+
+#include "application.h"
+#include "mesh_import.h"
+#include "parallel.h"
+#include "resource_tracking.h"
+
+#include <math.h>
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <random>
+#include <vector>
+
+using namespace gfx;
+
+// Vertex Buffer for the billboard shader
+struct SVertexBuffer
+{
+	float m_ViewProjectionMatrix[16];
+	float m_WSCameraPosition[3];
+	float m_FILLER1;
+	float m_WSLightPosition[3];
+	float m_FILLER2;
+};
+
+// Draw Buffer for the billboard shader, selects the object constants of a draw
+struct SDrawBuffer
+{
+	int m_IndexOfObject;
+	int FILLER[3];
+};
+
+// Constants of one billboard in the object buffer of the billboard shader
+struct SObjectConstants
+{
+	float m_WSBillboardPosition[3];
+	float m_FILLER1;
+};
+
+// The size of the object buffer, the largest constant buffer possible
+const int g_NumberOfObjectBufferBytes = 65536;
+
+// Pixel Buffer for the billboard shader
+struct SPixelBuffer
+{
+	float m_AmbientLightColor[4];
+	float m_DiffuseLightColor[4];
+	float m_SpecularColor[4];
+	float m_SpecularExponent;
+	float m_UseNormalMap;
+	float FILLER[2];
+};
+
+// Vertex Buffer for the just textured shader
+struct SGroundVertexBuffer
+{
+	float m_ViewProjectionMatrix[16];
+	float m_WorldMatrix[16];
+};
+
+// The billboards are culled in blocks of this size, a thread always takes whole blocks
+const int g_NumberOfBillboardsPerBlock = 4096;
+
+// Walls nearer to the camera are rasterized as occluders, the nearest ones first
+const float g_OccluderDistance     = 20.0f;
+const int   g_MaxNumberOfOccluders = 64;
+
+namespace
+{
+	float GetSquaredDistance(const float* _pA, const float* _pB)
+	{
+		float Delta[3] = { _pA[0] - _pB[0], _pA[1] - _pB[1], _pA[2] - _pB[2] };
+
+		return Delta[0] * Delta[0] + Delta[1] * Delta[1] + Delta[2] * Delta[2];
+	}
+
+	// -----------------------------------------------------------------------------
+	// Returns the milliseconds since the start time and moves the start time to
+	// now, so the stages of a frame can be timed one after the other.
+	// -----------------------------------------------------------------------------
+	double GetStageTime(std::chrono::steady_clock::time_point& _rStartTime)
+	{
+		std::chrono::steady_clock::time_point Now = std::chrono::steady_clock::now();
+
+		double Time = std::chrono::duration<double, std::milli>(Now - _rStartTime).count();
+
+		_rStartTime = Now;
+
+		return Time;
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CApplication::CApplication()
+	: m_FieldOfViewY(60.0f)        // Set the vertical view angle of the camera to 60 degrees.
+	, m_pMeshTree(nullptr)
+	, m_pMeshWall(nullptr)
+	, m_pVertexConstantBuffer(nullptr)
+	, m_pDrawConstantBuffer(nullptr)
+	, m_pObjectConstantBuffer(nullptr)
+	, m_pPixelConstantBuffer(nullptr)
+	, m_pLightConstantBuffer(nullptr)
+	, m_pClusterConstantBuffer(nullptr)
+	, m_pLightIndexConstantBuffer(nullptr)
+	, m_pVertexShader(nullptr)
+	, m_pPixelShader(nullptr)
+	, m_pMaterialTree(nullptr)
+	, m_pMaterialWall(nullptr)
+	, m_pColorTextureTree(nullptr)
+	, m_pNormalTextureTree(nullptr)
+	, m_pColorTextureWall(nullptr)
+	, m_pNormalTextureWall(nullptr)
+	, m_IndexOfColorTextureTree(-1)
+	, m_IndexOfNormalTextureTree(-1)
+	, m_IndexOfColorTextureWall(-1)
+	, m_IndexOfNormalTextureWall(-1)
+	, m_pGroundVertexConstantBuffer(nullptr)
+	, m_pGroundVertexShader(nullptr)
+	, m_pGroundPixelShader(nullptr)
+	, m_pGroundTexture(nullptr)
+	, m_pGroundMaterial(nullptr)
+	, m_HeightmapFileName("..\\data\\images\\heightmap.dds")
+	, m_NumberOfWalls(0)
+	, m_NumberOfThreads(0)
+	, m_PointLightTime(0.0f)
+	, m_ScreenWidth(800)
+	, m_ScreenHeight(600)
+	, m_isReplaying(false)
+	, m_IndexOfFrame(0)
+	, m_FrameTime(0.0)
+	, m_CPUTime(0.0)
+	, m_FrameStatistics()
+	, m_camPosX(0.0f)
+	, m_camPosY(1.2f)
+	, m_camPosZ(-5.0f)
+	, m_camAtX(0.0f)
+	, m_camAtY(0.0f)
+	, m_camAtZ(0.0f)
+	, m_autoRotation(false)
+	, m_radius(4)
+	, m_interval(0.02)
+	, m_theta(5)
+	, m_alpha(90)
+	, m_useTree(false) 		// You can toggle useTree here to get the tree texture instead of the wall
+	, m_showGround(true)
+	, m_useTightPolygons(true)
+	, m_useOcclusionCulling(true)
+	, m_usePointLights(true)
+	, m_useQualityGovernor(true)
+{
+	m_OcclusionCuller.Create(256, 128);
+	m_ClusteredLighting.Create(SClusteredLightingSettings());
+	m_FrameArena.Create(1024 * 1024);
+	m_UploadRing.Create(g_NumberOfObjectBufferBytes);
+	m_QualityGovernor.Create(SQualityGovernorSettings());
+
+	// -----------------------------------------------------------------------------
+	// The default scene is a row of walls with a few trees in front of it. The
+	// benchmark replaces it with generated forests.
+	// -----------------------------------------------------------------------------
+	std::vector<SBillboard> Billboards =
+	{
+		{ { -4.0f, 0.0f,  2.0f  }, SBillboard::Wall },
+		{ { -2.0f, 0.0f,  2.0f  }, SBillboard::Wall },
+		{ {  0.0f, 0.0f,  2.0f  }, SBillboard::Wall },
+		{ {  2.0f, 0.0f,  2.0f  }, SBillboard::Wall },
+		{ {  4.0f, 0.0f,  2.0f  }, SBillboard::Wall },
+		{ { -2.0f, 0.0f,  0.0f  }, SBillboard::Tree },
+		{ {  2.0f, 0.0f, -0.25f }, SBillboard::Tree },
+		{ {  1.0f, 0.0f, -1.5f  }, SBillboard::Tree },
+	};
+
+	SetScene(Billboards);
+}
+
+// -----------------------------------------------------------------------------
+
+CApplication::~CApplication()
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::StartRecording(const char* _pFileName, int _Width, int _Height)
+{
+	m_InputRecorder.Start(_pFileName, _Width, _Height);
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::StartReplay(const char* _pFileName, const char* _pTimingFileName, int& _rWidth, int& _rHeight)
+{
+	if(!m_InputPlayer.Load(_pFileName))
+	{
+		return false;
+	}
+
+	m_FrameTimingFileName = _pTimingFileName != nullptr ? _pTimingFileName : "";
+	m_isReplaying         = true;
+
+	// The replay has to do the same work in every run, so the quality stays fixed.
+	m_useQualityGovernor = false;
+
+	_rWidth  = m_InputPlayer.GetWidth();
+	_rHeight = m_InputPlayer.GetHeight();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::SetHeightmap(const char* _pFileName)
+{
+	m_HeightmapFileName = _pFileName;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::SetScene(const std::vector<SBillboard>& _rBillboards)
+{
+	m_Billboards = _rBillboards;
+
+	std::vector<SBillboard>::iterator FirstTree = std::stable_partition(m_Billboards.begin(), m_Billboards.end(), [](const SBillboard& _rBillboard) { return _rBillboard.m_Type == SBillboard::Wall; });
+
+	m_NumberOfWalls = static_cast<int>(FirstTree - m_Billboards.begin());
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::SetCameraOrbit(float _Radius, float _Angle, float _Height)
+{
+	m_radius  = _Radius;
+	m_alpha   = _Angle;
+	m_camPosY = _Height;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::SetNumberOfThreads(int _NumberOfThreads)
+{
+	m_NumberOfThreads = _NumberOfThreads;
+
+	SClusteredLightingSettings LightingSettings;
+
+	LightingSettings.m_NumberOfThreads = _NumberOfThreads;
+
+	m_ClusteredLighting.Create(LightingSettings);
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::SetQualityLevel(int _Level)
+{
+	m_useQualityGovernor = false;
+
+	m_QualityGovernor.SetLevel(_Level);
+}
+
+// -----------------------------------------------------------------------------
+
+const SFrameStatistics& CApplication::GetFrameStatistics() const
+{
+	return m_FrameStatistics;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnShutdown()
+{
+	if(m_InputRecorder.IsRecording())
+	{
+		m_InputRecorder.Stop(m_IndexOfFrame);
+	}
+
+	// -----------------------------------------------------------------------------
+	// YoshiX released all textures, buffers, shaders, materials, and meshes before
+	// the shutdown, so every handle still alive here is a leak.
+	// -----------------------------------------------------------------------------
+	PrintLiveResources();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnCreateConstantBuffers()
+{
+	// -----------------------------------------------------------------------------
+	// Create a constant buffer with global data for the vertex shader. We use this
+	// buffer to upload the data defined in the 'SVertexBuffer' struct. Note that it
+	// is not possible to use the data of a constant buffer in vertex and pixel
+	// shader. Constant buffers are specific to a certain shader stage. If a 
+	// constant buffer is a vertex or a pixel buffer is defined in the material info
+	// when creating the material.
+	// -----------------------------------------------------------------------------
+	CreateTrackedConstantBuffer(sizeof(SVertexBuffer), &m_pVertexConstantBuffer, RESOURCE_SITE);
+	CreateTrackedConstantBuffer(sizeof(SPixelBuffer), &m_pPixelConstantBuffer, RESOURCE_SITE);
+	CreateTrackedConstantBuffer(sizeof(SDrawBuffer), &m_pDrawConstantBuffer, RESOURCE_SITE);
+	CreateTrackedConstantBuffer(m_UploadRing.GetNumberOfBytesPerFrame(), &m_pObjectConstantBuffer, RESOURCE_SITE);
+
+	CreateTrackedConstantBuffer(sizeof(SGroundVertexBuffer), &m_pGroundVertexConstantBuffer, RESOURCE_SITE);
+
+	CreateTrackedConstantBuffer(sizeof(SLightBuffer), &m_pLightConstantBuffer, RESOURCE_SITE);
+	CreateTrackedConstantBuffer(sizeof(SClusterBuffer), &m_pClusterConstantBuffer, RESOURCE_SITE);
+	CreateTrackedConstantBuffer(sizeof(SLightIndexBuffer), &m_pLightIndexConstantBuffer, RESOURCE_SITE);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnReleaseConstantBuffers()
+{
+	// -----------------------------------------------------------------------------
+	// Important to release the buffer again when the application is shut down.
+	// -----------------------------------------------------------------------------
+	ReleaseTrackedConstantBuffer(m_pVertexConstantBuffer);
+	ReleaseTrackedConstantBuffer(m_pPixelConstantBuffer);
+	ReleaseTrackedConstantBuffer(m_pDrawConstantBuffer);
+	ReleaseTrackedConstantBuffer(m_pObjectConstantBuffer);
+
+	ReleaseTrackedConstantBuffer(m_pGroundVertexConstantBuffer);
+
+	ReleaseTrackedConstantBuffer(m_pLightConstantBuffer);
+	ReleaseTrackedConstantBuffer(m_pClusterConstantBuffer);
+	ReleaseTrackedConstantBuffer(m_pLightIndexConstantBuffer);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnCreateShader()
+{
+	// -----------------------------------------------------------------------------
+	// Load and compile the shader programs.
+	// -----------------------------------------------------------------------------
+	CreateTrackedVertexShader("..\\data\\shader\\billboard.hlsl", "VSShader", &m_pVertexShader, RESOURCE_SITE);
+	CreateTrackedPixelShader("..\\data\\shader\\billboard.hlsl", "PSShader", &m_pPixelShader, RESOURCE_SITE);
+
+	CreateTrackedVertexShader("..\\data\\shader\\textured.fx", "VSShader", &m_pGroundVertexShader, RESOURCE_SITE);
+	CreateTrackedPixelShader("..\\data\\shader\\textured.fx", "PSShader", &m_pGroundPixelShader, RESOURCE_SITE);
+
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnReleaseShader()
+{
+	// -----------------------------------------------------------------------------
+	// Important to release the shader again when the application is shut down.
+	// -----------------------------------------------------------------------------
+	ReleaseTrackedVertexShader(m_pVertexShader);
+	ReleaseTrackedPixelShader(m_pPixelShader);
+
+	ReleaseTrackedVertexShader(m_pGroundVertexShader);
+	ReleaseTrackedPixelShader(m_pGroundPixelShader);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnCreateMaterials()
+{
+	// -----------------------------------------------------------------------------
+	// The trees and the walls use the same billboard shader, only the textures
+	// differ.
+	// -----------------------------------------------------------------------------
+	CreateBillboardMaterial(m_pColorTextureTree, m_pNormalTextureTree, &m_pMaterialTree);
+	CreateBillboardMaterial(m_pColorTextureWall, m_pNormalTextureWall, &m_pMaterialWall);
+
+	// -----------------------------------------------------------------------------
+	// Create a material spawning the mesh. This material will be used for the
+	// non billboard objects which should just be textured objects.
+	// -----------------------------------------------------------------------------
+	SMaterialInfo MaterialGroundInfo;
+
+	MaterialGroundInfo.m_NumberOfTextures = 1;									// The material does not need textures, because the pixel shader just returns a constant color.
+	MaterialGroundInfo.m_pTextures[0] = m_pGroundTexture;
+
+	MaterialGroundInfo.m_NumberOfVertexConstantBuffers = 1;						// We need one vertex constant buffer to pass world matrix and view projection matrix to the vertex shader.
+	MaterialGroundInfo.m_pVertexConstantBuffers[0] = m_pGroundVertexConstantBuffer;     // Pass the handle to the created vertex constant buffer.					// We need one vertex constant buffer to pass world matrix and view projection matrix to the vertex shader.
+	MaterialGroundInfo.m_NumberOfPixelConstantBuffers = 0;						// We do not need any global data in the pixel shader.
+
+	MaterialGroundInfo.m_pVertexShader = m_pGroundVertexShader;							// The handle to the vertex shader.
+	MaterialGroundInfo.m_pPixelShader = m_pGroundPixelShader;							// The handle to the pixel shader.
+
+	MaterialGroundInfo.m_NumberOfInputElements = 2;								// The vertex shader requests the position as only argument.
+	MaterialGroundInfo.m_InputElements[0].m_pName = "POSITION";					// The semantic name of the argument, which matches exactly the identifier in the 'VSInput' struct.
+	MaterialGroundInfo.m_InputElements[0].m_Type = SInputElement::Float3;			// The position is a 3D vector with floating points.
+	MaterialGroundInfo.m_InputElements[1].m_pName = "TEXCOORD";              // The semantic name of the second argument, which matches exactly the second identifier in the 'VSInput' struct.
+	MaterialGroundInfo.m_InputElements[1].m_Type = SInputElement::Float2;   // The texture coordinates are a 2D vector with floating points.
+
+	CreateTrackedMaterial(MaterialGroundInfo, &m_pGroundMaterial, RESOURCE_SITE);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::CreateBillboardMaterial(BHandle _pColorTexture, BHandle _pNormalTexture, BHandle* _ppMaterial)
+{
+	// -----------------------------------------------------------------------------
+	// Create a material spawning the mesh. This material will be used for the
+	// actual billboard. It is created again whenever the texture streamer replaces
+	// one of its textures.
+	// -----------------------------------------------------------------------------
+	SMaterialInfo MaterialInfo;
+
+	MaterialInfo.m_NumberOfTextures = 3;									// The material does not need textures, because the pixel shader just returns a constant color.
+	MaterialInfo.m_pTextures[0] = _pColorTexture;								// The handle to the texture.
+	MaterialInfo.m_pTextures[1] = _pNormalTexture;
+	MaterialInfo.m_pTextures[2] = m_pGroundTexture;
+
+	MaterialInfo.m_NumberOfVertexConstantBuffers = 3;						// The frame data, the object index of a draw and the object constants of the frame.
+	MaterialInfo.m_pVertexConstantBuffers[0] = m_pVertexConstantBuffer;     // Pass the handle to the created vertex constant buffer.
+	MaterialInfo.m_pVertexConstantBuffers[1] = m_pDrawConstantBuffer;
+	MaterialInfo.m_pVertexConstantBuffers[2] = m_pObjectConstantBuffer;
+
+	MaterialInfo.m_NumberOfPixelConstantBuffers = 4;						// The light colors and the clustered point lights.
+	MaterialInfo.m_pPixelConstantBuffers[0] = m_pPixelConstantBuffer;
+	MaterialInfo.m_pPixelConstantBuffers[1] = m_pLightConstantBuffer;
+	MaterialInfo.m_pPixelConstantBuffers[2] = m_pClusterConstantBuffer;
+	MaterialInfo.m_pPixelConstantBuffers[3] = m_pLightIndexConstantBuffer;
+
+	MaterialInfo.m_pVertexShader = m_pVertexShader;							// The handle to the vertex shader.
+	MaterialInfo.m_pPixelShader = m_pPixelShader;							// The handle to the pixel shader.
+
+	MaterialInfo.m_NumberOfInputElements = 5;								// The vertex shader requests the position as only argument.
+	MaterialInfo.m_InputElements[0].m_pName = "POSITION";					// The semantic name of the argument, which matches exactly the identifier in the 'VSInput' struct.
+	MaterialInfo.m_InputElements[0].m_Type = SInputElement::Float3;			// The position is a 3D vector with floating points.
+	MaterialInfo.m_InputElements[1].m_pName = "TANGENT";
+	MaterialInfo.m_InputElements[1].m_Type = SInputElement::Float3;
+	MaterialInfo.m_InputElements[2].m_pName = "BINORMAL";
+	MaterialInfo.m_InputElements[2].m_Type = SInputElement::Float3;
+	MaterialInfo.m_InputElements[3].m_pName = "NORMAL";
+	MaterialInfo.m_InputElements[3].m_Type = SInputElement::Float3;
+	MaterialInfo.m_InputElements[4].m_pName = "TEXCOORD";              // The semantic name of the second argument, which matches exactly the second identifier in the 'VSInput' struct.
+	MaterialInfo.m_InputElements[4].m_Type = SInputElement::Float2;   // The texture coordinates are a 2D vector with floating points.
+
+	CreateTrackedMaterial(MaterialInfo, _ppMaterial, RESOURCE_SITE);
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnReleaseMaterials()
+{
+	// -----------------------------------------------------------------------------
+	// Important to release the material again when the application is shut down.
+	// -----------------------------------------------------------------------------
+	ReleaseTrackedMaterial(m_pMaterialTree);
+	ReleaseTrackedMaterial(m_pMaterialWall);
+	ReleaseTrackedMaterial(m_pGroundMaterial);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnCreateTextures()
+{
+	// -----------------------------------------------------------------------------
+	// The billboard textures are streamed, the instances request the mip level
+	// they need on the screen every frame. Until then only the small levels are
+	// loaded. The normal map of the tree is no DDS and is loaded as it is.
+	// -----------------------------------------------------------------------------
+	m_TextureStreamer.Create(STextureStreamingSettings());
+
+	m_IndexOfColorTextureTree  = m_TextureStreamer.AddTexture("..\\data\\images\\tree_color_map.dds");
+	m_IndexOfNormalTextureTree = m_TextureStreamer.AddTexture("..\\data\\images\\tree_normal_map.png");
+
+	m_IndexOfColorTextureWall  = m_TextureStreamer.AddTexture("..\\data\\images\\wall_color_map.dds");
+	m_IndexOfNormalTextureWall = m_TextureStreamer.AddTexture("..\\data\\images\\wall_normal_map.dds");
+
+	m_pColorTextureTree  = m_TextureStreamer.GetTexture(m_IndexOfColorTextureTree);
+	m_pNormalTextureTree = m_TextureStreamer.GetTexture(m_IndexOfNormalTextureTree);
+	m_pColorTextureWall  = m_TextureStreamer.GetTexture(m_IndexOfColorTextureWall);
+	m_pNormalTextureWall = m_TextureStreamer.GetTexture(m_IndexOfNormalTextureWall);
+
+	CreateTrackedTexture("..\\data\\images\\ground.dds", &m_pGroundTexture, RESOURCE_SITE);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnReleaseTextures()
+{
+	m_TextureStreamer.Release();
+
+	ReleaseTrackedTexture(m_pGroundTexture);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnCreateMeshes()
+{
+	// -----------------------------------------------------------------------------
+	// Define the vertices of the mesh. This is a relatively complex data structure
+	// in the form of an interleaved storage, where we place all information for one
+	// point into the same array. Layout: Position(3D), TextureCoords(2D), 
+	// Tangent (3D), Binormal (3D), Normal (3D)
+	// -----------------------------------------------------------------------------
+	float SquareVertices[][14] =
+	{
+		{ -1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f  },
+		{  1.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f  },
+		{  1.0f,  1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f  },
+		{ -1.0f,  1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f  },
+	};
+
+	// -----------------------------------------------------------------------------
+	// Define the topology of the mesh via indices. An index addresses a vertex from
+	// the array above. Three indices represent one triangle. When defining the 
+	// triangles of a mesh imagine that you are standing in front of the triangle 
+	// and looking to the center of the triangle. If the mesh represents a closed
+	// body such as a cube, your view position has to be outside of the body. Now
+	// define the indices of the addressed vertices of the triangle in counter-
+	// clockwise order.
+	// -----------------------------------------------------------------------------
+	int SquareIndices[][3] =
+	{
+		{  0,  1,  2 },
+		{  0,  2,  3 },
+	};
+
+	// -----------------------------------------------------------------------------
+	// Derive tangent and binormal from positions, normals and texture coordinates
+	// the same way the mesh importer does, so the quad matches imported meshes.
+	// -----------------------------------------------------------------------------
+	GenerateTangentFrames(&SquareVertices[0][0], 4, &SquareIndices[0][0], 6, SImportSettings());
+
+	// -----------------------------------------------------------------------------
+	// Most of a billboard texture is usually transparent. Instead of the full quad
+	// we can draw a polygon which only covers the visible texels, so the pixel
+	// shader does not run for pixels which get discarded by the blending anyway.
+	// The polygons are kept, because the meshes are created again whenever the
+	// texture streamer replaces one of the billboard textures.
+	// -----------------------------------------------------------------------------
+	if(m_useTightPolygons)
+	{
+		SBillboardPolygonSettings PolygonSettings;
+
+		BuildBillboardPolygon("..\\data\\images\\tree_color_map.dds", PolygonSettings, m_PolygonTree);
+		BuildBillboardPolygon("..\\data\\images\\wall_color_map.dds", PolygonSettings, m_PolygonWall);
+
+		PrintBillboardPolygonReport("tree_color_map.dds", m_PolygonTree);
+		PrintBillboardPolygonReport("wall_color_map.dds", m_PolygonWall);
+	}
+	else
+	{
+		m_PolygonTree.m_Vertices.assign(&SquareVertices[0][0], &SquareVertices[0][0] + 4 * 14);
+		m_PolygonTree.m_Indices .assign(&SquareIndices[0][0], &SquareIndices[0][0] + 6);
+
+		m_PolygonWall = m_PolygonTree;
+	}
+
+	CreateBillboardMeshes();
+
+	// -----------------------------------------------------------------------------
+	// Build up the terrain for the ground. Only the root chunk is created here, the
+	// other chunks are built on worker threads while the camera moves around.
+	// -----------------------------------------------------------------------------
+	STerrainSettings TerrainSettings;
+
+	m_Terrain.Create(TerrainSettings, m_HeightmapFileName.c_str(), m_pGroundMaterial);
+
+	// -----------------------------------------------------------------------------
+	// Spread warm point lights like lanterns and fires over the terrain. The fixed
+	// seed places them the same way on every start.
+	// -----------------------------------------------------------------------------
+	std::mt19937 Random(1234);
+	std::uniform_real_distribution<float> Uniform(0.0f, 1.0f);
+
+	m_PointLights.resize(256);
+
+	for(SPointLight& rLight : m_PointLights)
+	{
+		rLight.m_Position[0] = TerrainSettings.m_Origin[0] + Uniform(Random) * TerrainSettings.m_Size;
+		rLight.m_Position[2] = TerrainSettings.m_Origin[2] + Uniform(Random) * TerrainSettings.m_Size;
+		rLight.m_Position[1] = m_Terrain.GetHeight(rLight.m_Position[0], rLight.m_Position[2]) + 0.5f + Uniform(Random);
+		rLight.m_Radius      = 2.0f + 2.0f * Uniform(Random);
+		rLight.m_Color[0]    = 1.0f;
+		rLight.m_Color[1]    = 0.5f + 0.3f * Uniform(Random);
+		rLight.m_Color[2]    = 0.2f + 0.2f * Uniform(Random);
+		rLight.m_Intensity   = 1.0f;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::CreateBillboardMeshes()
+{
+	// -----------------------------------------------------------------------------
+	// Define the mesh and its material. The material defines the look of the 
+	// surface covering the mesh. Note that you pass the number of indices and not
+	// the number of triangles.
+	// -----------------------------------------------------------------------------
+	SMeshInfo MeshInfoTree;
+
+	MeshInfoTree.m_pVertices = m_PolygonTree.m_Vertices.data();          // Pointer to the first float of the first vertex.
+	MeshInfoTree.m_NumberOfVertices = m_PolygonTree.GetNumberOfVertices(); // The number of vertices.
+	MeshInfoTree.m_pIndices = m_PolygonTree.m_Indices.data();            // Pointer to the first index.
+	MeshInfoTree.m_NumberOfIndices = m_PolygonTree.GetNumberOfIndices();   // The number of indices (has to be dividable by 3).
+	MeshInfoTree.m_pMaterial = m_pMaterialTree;                            // A handle to the material covering the mesh.
+
+	SMeshInfo MeshInfoWall;
+
+	MeshInfoWall.m_pVertices = m_PolygonWall.m_Vertices.data();          // Pointer to the first float of the first vertex.
+	MeshInfoWall.m_NumberOfVertices = m_PolygonWall.GetNumberOfVertices(); // The number of vertices.
+	MeshInfoWall.m_pIndices = m_PolygonWall.m_Indices.data();            // Pointer to the first index.
+	MeshInfoWall.m_NumberOfIndices = m_PolygonWall.GetNumberOfIndices();   // The number of indices (has to be dividable by 3).
+	MeshInfoWall.m_pMaterial = m_pMaterialWall;                            // A handle to the material covering the mesh.
+
+	CreateTrackedMesh(MeshInfoTree, &m_pMeshTree, RESOURCE_SITE);
+	CreateTrackedMesh(MeshInfoWall, &m_pMeshWall, RESOURCE_SITE);
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::RecreateBillboards()
+{
+	// -----------------------------------------------------------------------------
+	// YoshiX binds the textures when a material is created and the material when a
+	// mesh is created. So after the streamer replaced a texture both have to be
+	// created again. This only happens when a mip level changes.
+	// -----------------------------------------------------------------------------
+	ReleaseTrackedMesh(m_pMeshTree);
+	ReleaseTrackedMesh(m_pMeshWall);
+
+	ReleaseTrackedMaterial(m_pMaterialTree);
+	ReleaseTrackedMaterial(m_pMaterialWall);
+
+	m_pColorTextureTree  = m_TextureStreamer.GetTexture(m_IndexOfColorTextureTree);
+	m_pNormalTextureTree = m_TextureStreamer.GetTexture(m_IndexOfNormalTextureTree);
+	m_pColorTextureWall  = m_TextureStreamer.GetTexture(m_IndexOfColorTextureWall);
+	m_pNormalTextureWall = m_TextureStreamer.GetTexture(m_IndexOfNormalTextureWall);
+
+	CreateBillboardMaterial(m_pColorTextureTree, m_pNormalTextureTree, &m_pMaterialTree);
+	CreateBillboardMaterial(m_pColorTextureWall, m_pNormalTextureWall, &m_pMaterialWall);
+
+	CreateBillboardMeshes();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnReleaseMeshes()
+{
+	// -----------------------------------------------------------------------------
+	// Important to release the mesh again when the application is shut down.
+	// -----------------------------------------------------------------------------
+	ReleaseTrackedMesh(m_pMeshTree);
+	ReleaseTrackedMesh(m_pMeshWall);
+	m_Terrain.Release();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnResize(int _Width, int _Height)
+{
+	// -----------------------------------------------------------------------------
+	// The projection matrix defines the size of the camera frustum. The YoshiX
+	// camera has the shape of a pyramid with the eye position at the top of the
+	// pyramid. The horizontal view angle is defined by the vertical view angle
+	// and the ratio between window width and window height. Note that we do not
+	// set the projection matrix to YoshiX. Instead we store the projection matrix
+	// as a member and upload it in the 'InternOnFrame' method in a constant buffer.
+	// -----------------------------------------------------------------------------
+	GetProjectionMatrix(m_FieldOfViewY, static_cast<float>(_Width) / static_cast<float>(_Height), 0.1f, 100.0f, m_ProjectionMatrix);
+
+	// The pixel shader needs the size of the screen to find the cluster of a pixel.
+	m_ScreenWidth  = _Width;
+	m_ScreenHeight = _Height;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnUpdate()
+{
+	float Eye[3];
+	float At[3];
+	float Up[3];
+
+	// -----------------------------------------------------------------------------
+	// The time of the last frame is only known now, when the next one starts. The
+	// quality governor reacts to it before this frame is prepared.
+	// -----------------------------------------------------------------------------
+	if(m_IndexOfFrame > 0)
+	{
+		m_FrameTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_FrameStartTime).count();
+
+		if(m_useQualityGovernor)
+		{
+			m_QualityGovernor.Update(m_FrameTime, m_CPUTime);
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// During a replay the recorded input of this frame is handled before anything
+	// else, at the same point where the live input arrives between two frames.
+	// -----------------------------------------------------------------------------
+	if(m_isReplaying)
+	{
+		ReplayInput();
+	}
+
+	m_FrameStartTime = std::chrono::steady_clock::now();
+
+	// -----------------------------------------------------------------------------
+	// Define position and orientation of the camera in the world. The result is
+	// stored in the 'm_ViewMatrix' matrix and uploaded in the 'InternOnFrame'
+	// method. We use variables for the position of the camera, so it can be changed
+	// via inputs of the user.
+	// -----------------------------------------------------------------------------
+	Eye[0] = m_camPosX; At[0] = m_camAtX; Up[0] = 0.0f;
+	Eye[1] = m_camPosY; At[1] = m_camAtZ; Up[1] = 1.0f;
+	Eye[2] = m_camPosZ; At[2] = m_camAtY; Up[2] = 0.0f;
+
+	GetViewMatrix(Eye, At, Up, m_ViewMatrix);
+
+	// Let the point lights flicker, each one with its own speed.
+	m_PointLightTime += 1.0f / 60.0f;
+
+	for(int IndexOfLight = 0; IndexOfLight < static_cast<int>(m_PointLights.size()); ++ IndexOfLight)
+	{
+		m_PointLights[IndexOfLight].m_Intensity = 0.8f + 0.2f * sinf(m_PointLightTime * (5.0f + IndexOfLight % 7) + IndexOfLight);
+	}
+
+	m_FrameStatistics.m_UpdateTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_FrameStartTime).count();
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::UploadFrameConstants()
+{
+	// -----------------------------------------------------------------------------
+	// Upload the view projection matrix, camera and light to the GPU. These are the
+	// same for all billboards, so this is done once per frame before the draws.
+	// -----------------------------------------------------------------------------
+	SVertexBuffer VertexBuffer;
+
+	// Set the ViewProjectionMatrix in the vertex buffer for this frame
+	MulMatrix(m_ViewMatrix, m_ProjectionMatrix, VertexBuffer.m_ViewProjectionMatrix);
+
+
+
+	// Setting the cameraPos in the vertex buffer to the actual camera position (y should always be 0)
+	VertexBuffer.m_WSCameraPosition[0] = m_camPosX;
+	VertexBuffer.m_WSCameraPosition[1] = m_camPosY;
+	VertexBuffer.m_WSCameraPosition[2] = m_camPosZ;
+
+	// Set light to a constant position, so we can se reflections on the texture.
+	VertexBuffer.m_WSLightPosition[0] = 5.0f;
+	VertexBuffer.m_WSLightPosition[1] = 5.0f;
+	VertexBuffer.m_WSLightPosition[2] = -20.0f;
+
+	UploadConstantBuffer(&VertexBuffer, m_pVertexConstantBuffer);
+
+	SPixelBuffer PixelBuffer;
+
+	// Set the Lights Colors and Specular Color to static values
+	// which work well for lighting
+	PixelBuffer.m_AmbientLightColor[0] = 0.2f;
+	PixelBuffer.m_AmbientLightColor[1] = 0.2f;
+	PixelBuffer.m_AmbientLightColor[2] = 0.2f;
+	PixelBuffer.m_AmbientLightColor[3] = 1.0f;
+
+	PixelBuffer.m_DiffuseLightColor[0] = 0.7f;
+	PixelBuffer.m_DiffuseLightColor[1] = 0.7f;
+	PixelBuffer.m_DiffuseLightColor[2] = 0.7f;
+	PixelBuffer.m_DiffuseLightColor[3] = 1.0f;
+
+	PixelBuffer.m_SpecularColor[0] = 1.0f;
+	PixelBuffer.m_SpecularColor[1] = 1.0f;
+	PixelBuffer.m_SpecularColor[2] = 1.0f;
+	PixelBuffer.m_SpecularColor[3] = 1.0f;
+
+	PixelBuffer.m_SpecularExponent = 100.0f;
+
+	// The quality governor turns off the normal maps when the frames get too slow.
+	PixelBuffer.m_UseNormalMap = m_QualityGovernor.GetQuality().m_UseNormalMaps ? 1.0f : 0.0f;
+	PixelBuffer.FILLER[0]      = 0.0f;
+	PixelBuffer.FILLER[1]      = 0.0f;
+
+	UploadConstantBuffer(&PixelBuffer, m_pPixelConstantBuffer);
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::AddDrawCall(BHandle _pMesh, const float* _pPosition, SDrawCall* _pDrawCalls, int& _rNumberOfDrawCalls)
+{
+	// -----------------------------------------------------------------------------
+	// Place the constants of the billboard in the object buffer of the frame. The
+	// draw only remembers where they are. If the buffer is full the billboard is
+	// skipped, the upload ring reports the overflow at the start of the next frame.
+	// -----------------------------------------------------------------------------
+	SObjectConstants* pObjectConstants;
+
+	int IndexOfObject = m_UploadRing.Allocate(sizeof(SObjectConstants), reinterpret_cast<void**>(&pObjectConstants));
+
+	if(IndexOfObject < 0 || _pDrawCalls == nullptr)
+	{
+		return;
+	}
+
+	pObjectConstants->m_WSBillboardPosition[0] = _pPosition[0];
+	pObjectConstants->m_WSBillboardPosition[1] = _pPosition[1];
+	pObjectConstants->m_WSBillboardPosition[2] = _pPosition[2];
+	pObjectConstants->m_FILLER1                = 0.0f;
+
+	_pDrawCalls[_rNumberOfDrawCalls].m_pMesh         = _pMesh;
+	_pDrawCalls[_rNumberOfDrawCalls].m_IndexOfObject = IndexOfObject;
+
+	++ _rNumberOfDrawCalls;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::RequestBillboardTextures(int _IndexOfColorTexture, int _IndexOfNormalTexture, const float* _pPosition)
+{
+	// -----------------------------------------------------------------------------
+	// The billboard quad is two units high and always faces the camera, so its
+	// size on the screen only depends on the distance.
+	// -----------------------------------------------------------------------------
+	float Delta[3] = { _pPosition[0] - m_camPosX, _pPosition[1] - m_camPosY, _pPosition[2] - m_camPosZ };
+	float Distance = sqrtf(Delta[0] * Delta[0] + Delta[1] * Delta[1] + Delta[2] * Delta[2]);
+	float Size     = GetProjectedSize(m_ProjectionMatrix, m_ScreenHeight, 2.0f, Distance);
+
+	m_TextureStreamer.RequestSize(_IndexOfColorTexture, Size);
+
+	// Without normal maps the normal texture falls back to its smallest levels.
+	if(m_QualityGovernor.GetQuality().m_UseNormalMaps)
+	{
+		m_TextureStreamer.RequestSize(_IndexOfNormalTexture, Size);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::CullBillboards(int _IndexOfFirst, int _NumberOfBillboards, float _MaxDistance, const SFrustum& _rFrustum, bool _UseOcclusionCulling, std::vector<int>& _rVisibleBillboards)
+{
+	// -----------------------------------------------------------------------------
+	// The threads take whole blocks of billboards. Each block collects the visible
+	// ones in its own list, so the threads never wait for each other and the result
+	// keeps the order of the scene. The lists keep their memory from frame to frame.
+	// -----------------------------------------------------------------------------
+	int NumberOfBlocks = (_NumberOfBillboards + g_NumberOfBillboardsPerBlock - 1) / g_NumberOfBillboardsPerBlock;
+
+	if(static_cast<int>(m_CullingBlocks.size()) < NumberOfBlocks)
+	{
+		m_CullingBlocks.resize(NumberOfBlocks);
+	}
+
+	float CameraPosition[3]  = { m_camPosX, m_camPosY, m_camPosZ };
+	float MaxSquaredDistance = _MaxDistance * _MaxDistance;
+
+	std::atomic<int> NumberOfTests(0);
+	std::atomic<int> NumberOfOccluded(0);
+
+	ParallelFor(NumberOfBlocks, m_NumberOfThreads, [&](int _Begin, int _End)
+	{
+		int Tests    = 0;
+		int Occluded = 0;
+
+		for(int IndexOfBlock = _Begin; IndexOfBlock < _End; ++ IndexOfBlock)
+		{
+			std::vector<int>& rBlock = m_CullingBlocks[IndexOfBlock];
+
+			int First = _IndexOfFirst + IndexOfBlock * g_NumberOfBillboardsPerBlock;
+			int Last  = std::min(First + g_NumberOfBillboardsPerBlock, _IndexOfFirst + _NumberOfBillboards);
+
+			rBlock.clear();
+
+			for(int IndexOfBillboard = First; IndexOfBillboard < Last; ++ IndexOfBillboard)
+			{
+				const float* pPosition = m_Billboards[IndexOfBillboard].m_Position;
+
+				if(GetSquaredDistance(pPosition, CameraPosition) > MaxSquaredDistance)
+				{
+					continue;
+				}
+
+				// A billboard turns around the y axis, so its bounds are a box with the half size of the quad in all directions.
+				float Min[3] = { pPosition[0] - 1.0f, pPosition[1] - 1.0f, pPosition[2] - 1.0f };
+				float Max[3] = { pPosition[0] + 1.0f, pPosition[1] + 1.0f, pPosition[2] + 1.0f };
+
+				if(!IsBoxVisible(_rFrustum, Min, Max))
+				{
+					continue;
+				}
+
+				if(_UseOcclusionCulling)
+				{
+					++ Tests;
+
+					if(!m_OcclusionCuller.IsBoxVisibleConcurrent(Min, Max))
+					{
+						++ Occluded;
+
+						continue;
+					}
+				}
+
+				rBlock.push_back(IndexOfBillboard);
+			}
+		}
+
+		NumberOfTests    += Tests;
+		NumberOfOccluded += Occluded;
+	}, 1);
+
+	m_OcclusionCuller.AddTests(NumberOfTests, NumberOfOccluded);
+
+	_rVisibleBillboards.clear();
+
+	for(int IndexOfBlock = 0; IndexOfBlock < NumberOfBlocks; ++ IndexOfBlock)
+	{
+		_rVisibleBillboards.insert(_rVisibleBillboards.end(), m_CullingBlocks[IndexOfBlock].begin(), m_CullingBlocks[IndexOfBlock].end());
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::AddOccluders(const SFrustum& _rFrustum)
+{
+	// -----------------------------------------------------------------------------
+	// The walls are opaque, so they are used as occluders. Near walls cover the
+	// most of the screen, so only the nearest visible ones are rasterized.
+	// -----------------------------------------------------------------------------
+	CullBillboards(0, m_NumberOfWalls, g_OccluderDistance, _rFrustum, false, m_Occluders);
+
+	float CameraPosition[3] = { m_camPosX, m_camPosY, m_camPosZ };
+
+	if(static_cast<int>(m_Occluders.size()) > g_MaxNumberOfOccluders)
+	{
+		std::nth_element(m_Occluders.begin(), m_Occluders.begin() + g_MaxNumberOfOccluders, m_Occluders.end(), [&](int _IndexOfLeft, int _IndexOfRight)
+		{
+			return GetSquaredDistance(m_Billboards[_IndexOfLeft].m_Position, CameraPosition) < GetSquaredDistance(m_Billboards[_IndexOfRight].m_Position, CameraPosition);
+		});
+
+		m_Occluders.resize(g_MaxNumberOfOccluders);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Each wall is rasterized as the camera facing quad the vertex shader turns it
+	// into.
+	// -----------------------------------------------------------------------------
+	int QuadIndices[6] = { 0, 1, 2, 0, 2, 3 };
+
+	for(int IndexOfWall : m_Occluders)
+	{
+		const float* pPosition = m_Billboards[IndexOfWall].m_Position;
+
+		// Same base as in the vertex shader: z points from the camera to the billboard.
+		float ZBase[3] = { pPosition[0] - m_camPosX, 0.0f, pPosition[2] - m_camPosZ };
+		float Length   = sqrtf(ZBase[0] * ZBase[0] + ZBase[2] * ZBase[2]);
+
+		if(Length < 1.0e-4f)
+		{
+			continue;
+		}
+
+		float XBase[3] = { ZBase[2] / Length, 0.0f, -ZBase[0] / Length };
+
+		float QuadPositions[4][3] =
+		{
+			{ pPosition[0] - XBase[0], pPosition[1] - 1.0f, pPosition[2] - XBase[2] },
+			{ pPosition[0] + XBase[0], pPosition[1] - 1.0f, pPosition[2] + XBase[2] },
+			{ pPosition[0] + XBase[0], pPosition[1] + 1.0f, pPosition[2] + XBase[2] },
+			{ pPosition[0] - XBase[0], pPosition[1] + 1.0f, pPosition[2] - XBase[2] },
+		};
+
+		m_OcclusionCuller.AddOccluder(&QuadPositions[0][0], QuadIndices, 6);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::Draw(BHandle _pMesh, int _IndexOfObject)
+{
+	// -----------------------------------------------------------------------------
+	// Tell the vertex shader which object constants to use. This is the only data
+	// uploaded per draw.
+	// -----------------------------------------------------------------------------
+	SDrawBuffer DrawBuffer;
+
+	DrawBuffer.m_IndexOfObject = _IndexOfObject;
+	DrawBuffer.FILLER[0]       = 0;
+	DrawBuffer.FILLER[1]       = 0;
+	DrawBuffer.FILLER[2]       = 0;
+
+	UploadConstantBuffer(&DrawBuffer, m_pDrawConstantBuffer);
+
+	// -----------------------------------------------------------------------------
+	// Draw the mesh. This will activate the shader, constant buffers, and textures
+	// of the material on the GPU and render the mesh to the current render targets.
+	// -----------------------------------------------------------------------------
+	DrawMesh(_pMesh);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnFrame()
+{
+	std::chrono::steady_clock::time_point StageStartTime = std::chrono::steady_clock::now();
+
+	// -----------------------------------------------------------------------------
+	// Everything allocated from the frame memory during the last frame is gone now.
+	// -----------------------------------------------------------------------------
+	m_FrameArena.Reset();
+	m_UploadRing.BeginFrame();
+
+	// -----------------------------------------------------------------------------
+	// Apply the quality level chosen by the governor for this frame.
+	// -----------------------------------------------------------------------------
+	const SQualityLevel& rQuality = m_QualityGovernor.GetQuality();
+
+	m_Terrain.SetLodDistanceScale(rQuality.m_LodDistanceScale);
+	m_TextureStreamer.SetLevelBias(rQuality.m_TextureLevelBias);
+
+	SetAlphaBlending(true);
+
+	// Rotation of the camera around the center point 0,0,0 with the offset of m_alpha 
+	// which can be changed by either pressing a or d or enabling automatic rotation
+	float x = m_radius * cos(m_theta);
+	float y = 0;
+	float z = m_radius * sin(m_theta);
+	m_camPosX = z * cos(m_alpha) - x * sin(m_alpha);
+	m_camPosZ = x * cos(m_alpha) + z * sin(m_alpha);
+
+	// Automatic rotation
+	if(m_autoRotation)
+	{
+		m_alpha += m_interval;
+	}
+
+
+	if(m_showGround)
+	{
+		// -----------------------------------------------------------------------------
+		// Upload the world matrix and the view projection matrix to the GPU. This has
+		// to be done before drawing the mesh, though not necessarily in this method.
+		// -----------------------------------------------------------------------------
+		SGroundVertexBuffer GroundVertexBuffer;
+
+		GetIdentityMatrix(GroundVertexBuffer.m_WorldMatrix);
+
+		MulMatrix(m_ViewMatrix, m_ProjectionMatrix, GroundVertexBuffer.m_ViewProjectionMatrix);
+
+		UploadConstantBuffer(&GroundVertexBuffer, m_pGroundVertexConstantBuffer);
+
+		// -----------------------------------------------------------------------------
+		// The terrain chunks are in world space, so they all share the constant buffer
+		// uploaded above. Select the chunks for the current camera and draw the ones
+		// inside of the view frustum.
+		// -----------------------------------------------------------------------------
+		float CameraPosition[3] = { m_camPosX, m_camPosY, m_camPosZ };
+
+		m_Terrain.Update(CameraPosition, GroundVertexBuffer.m_ViewProjectionMatrix);
+		m_Terrain.Draw();
+	}
+
+	m_FrameStatistics.m_TerrainTime = GetStageTime(StageStartTime);
+
+	// -----------------------------------------------------------------------------
+	// Sort the point lights into the clusters of the current view and upload the
+	// result. The buffers are shared by all billboards of the frame.
+	// -----------------------------------------------------------------------------
+	int NumberOfPointLights = m_usePointLights ? std::min(static_cast<int>(m_PointLights.size()), rQuality.m_MaxNumberOfPointLights) : 0;
+
+	m_ClusteredLighting.Update(m_ViewMatrix, m_ProjectionMatrix, m_ScreenWidth, m_ScreenHeight, m_PointLights.data(), NumberOfPointLights);
+
+	UploadConstantBuffer(m_ClusteredLighting.GetLightBuffer(), m_pLightConstantBuffer);
+	UploadConstantBuffer(m_ClusteredLighting.GetClusterBuffer(), m_pClusterConstantBuffer);
+	UploadConstantBuffer(m_ClusteredLighting.GetLightIndexBuffer(), m_pLightIndexConstantBuffer);
+
+	m_FrameStatistics.m_LightingTime = GetStageTime(StageStartTime);
+
+	// -----------------------------------------------------------------------------
+	// Rasterize the occluders of the current view.
+	// -----------------------------------------------------------------------------
+	float ViewProjectionMatrix[16];
+
+	MulMatrix(m_ViewMatrix, m_ProjectionMatrix, ViewProjectionMatrix);
+
+	SFrustum Frustum;
+
+	GetFrustum(ViewProjectionMatrix, Frustum);
+
+	m_OcclusionCuller.BeginFrame(ViewProjectionMatrix);
+
+	if(m_useOcclusionCulling)
+	{
+		AddOccluders(Frustum);
+	}
+	else
+	{
+		m_Occluders.clear();
+	}
+
+	m_OcclusionCuller.EndOccluders();
+
+	m_FrameStatistics.m_OccluderTime = GetStageTime(StageStartTime);
+
+	// -----------------------------------------------------------------------------
+	// Find the billboards within the distance of the quality level, inside of the
+	// view frustum and not hidden behind the occluders.
+	// -----------------------------------------------------------------------------
+	CullBillboards(0, static_cast<int>(m_Billboards.size()), rQuality.m_BillboardDistance, Frustum, m_useOcclusionCulling, m_VisibleBillboards);
+
+	m_FrameStatistics.m_CullingTime = GetStageTime(StageStartTime);
+
+	// -----------------------------------------------------------------------------
+	// Record the draws of the visible billboards, as many as the quality level
+	// allows and the object buffer holds. If there are more, the nearest ones are
+	// kept. They are sorted back into the order of the scene, where the walls come
+	// first, so they are drawn before the transparent trees.
+	// -----------------------------------------------------------------------------
+	int MaxNumberOfDrawCalls = std::min(rQuality.m_MaxNumberOfBillboards, m_UploadRing.GetNumberOfBytesPerFrame() / static_cast<int>(sizeof(SObjectConstants)));
+	int NumberOfBillboards   = std::min(static_cast<int>(m_VisibleBillboards.size()), MaxNumberOfDrawCalls);
+
+	if(NumberOfBillboards < static_cast<int>(m_VisibleBillboards.size()))
+	{
+		float CameraPosition[3] = { m_camPosX, m_camPosY, m_camPosZ };
+
+		std::nth_element(m_VisibleBillboards.begin(), m_VisibleBillboards.begin() + NumberOfBillboards, m_VisibleBillboards.end(), [&](int _IndexOfLeft, int _IndexOfRight)
+		{
+			return GetSquaredDistance(m_Billboards[_IndexOfLeft].m_Position, CameraPosition) < GetSquaredDistance(m_Billboards[_IndexOfRight].m_Position, CameraPosition);
+		});
+
+		std::sort(m_VisibleBillboards.begin(), m_VisibleBillboards.begin() + NumberOfBillboards);
+	}
+
+	SDrawCall* pDrawCalls        = m_FrameArena.AllocateArray<SDrawCall>(NumberOfBillboards);
+	int        NumberOfDrawCalls = 0;
+
+	for(int IndexOfVisible = 0; IndexOfVisible < NumberOfBillboards; ++ IndexOfVisible)
+	{
+		const SBillboard& rBillboard = m_Billboards[m_VisibleBillboards[IndexOfVisible]];
+
+		if(rBillboard.m_Type == SBillboard::Wall)
+		{
+			AddDrawCall(m_pMeshWall, rBillboard.m_Position, pDrawCalls, NumberOfDrawCalls);
+
+			RequestBillboardTextures(m_IndexOfColorTextureWall, m_IndexOfNormalTextureWall, rBillboard.m_Position);
+		}
+		else
+		{
+			AddDrawCall(m_pMeshTree, rBillboard.m_Position, pDrawCalls, NumberOfDrawCalls);
+
+			RequestBillboardTextures(m_IndexOfColorTextureTree, m_IndexOfNormalTextureTree, rBillboard.m_Position);
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// Upload the constants of the frame and of all recorded objects at once, then
+	// submit the draws.
+	// -----------------------------------------------------------------------------
+	UploadFrameConstants();
+
+	UploadConstantBuffer(m_UploadRing.GetFrameData(), m_pObjectConstantBuffer);
+
+	m_UploadRing.EndFrame();
+
+	for(int IndexOfDrawCall = 0; IndexOfDrawCall < NumberOfDrawCalls; ++ IndexOfDrawCall)
+	{
+		Draw(pDrawCalls[IndexOfDrawCall].m_pMesh, pDrawCalls[IndexOfDrawCall].m_IndexOfObject);
+	}
+
+	m_FrameStatistics.m_SubmitTime = GetStageTime(StageStartTime);
+
+	// -----------------------------------------------------------------------------
+	// Take over the mip levels the worker thread finished and start loading the
+	// ones requested in this frame. The new meshes are used from the next frame on.
+	// -----------------------------------------------------------------------------
+	if(m_TextureStreamer.Update())
+	{
+		RecreateBillboards();
+	}
+
+	m_FrameStatistics.m_StreamingTime             = GetStageTime(StageStartTime);
+	m_FrameStatistics.m_NumberOfBillboards        = static_cast<int>(m_Billboards.size());
+	m_FrameStatistics.m_NumberOfOccluders         = static_cast<int>(m_Occluders.size());
+	m_FrameStatistics.m_NumberOfVisibleBillboards = static_cast<int>(m_VisibleBillboards.size());
+	m_FrameStatistics.m_NumberOfDrawnBillboards   = NumberOfDrawCalls;
+
+	m_CPUTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_FrameStartTime).count();
+
+	++ m_IndexOfFrame;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::ReplayInput()
+{
+	if(m_IndexOfFrame > 0)
+	{
+		m_InputPlayer.AddFrameTiming(m_FrameTime, m_CPUTime);
+	}
+
+	if(m_InputPlayer.IsFinished(m_IndexOfFrame))
+	{
+		m_InputPlayer.WriteFrameTimings(m_FrameTimingFileName.empty() ? nullptr : m_FrameTimingFileName.c_str());
+
+		m_isReplaying = false;
+
+		StopApplication();
+
+		return;
+	}
+
+	int                NumberOfEvents;
+	const SInputEvent* pEvents = m_InputPlayer.GetEvents(m_IndexOfFrame, NumberOfEvents);
+
+	for(int IndexOfEvent = 0; IndexOfEvent < NumberOfEvents; ++ IndexOfEvent)
+	{
+		const SInputEvent& rEvent = pEvents[IndexOfEvent];
+
+		// The mouse does not control anything yet, its events are only recorded.
+		if(rEvent.m_Type == SInputEvent::Key)
+		{
+			HandleKeyEvent(rEvent.m_KeyOrButton, (rEvent.m_Flags & SInputEvent::IsDown) != 0, (rEvent.m_Flags & SInputEvent::IsAltDown) != 0);
+		}
+	}
+}
+
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnKeyEvent(unsigned int _Key, bool _IsKeyDown, bool _IsAltDown)
+{
+	// -----------------------------------------------------------------------------
+	// The user input is ignored during a replay, otherwise the camera would leave
+	// the recorded path.
+	// -----------------------------------------------------------------------------
+	if(m_isReplaying)
+	{
+		return true;
+	}
+
+	m_InputRecorder.RecordKeyEvent(m_IndexOfFrame, _Key, _IsKeyDown, _IsAltDown);
+
+	HandleKeyEvent(_Key, _IsKeyDown, _IsAltDown);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CApplication::InternOnMouseEvent(int _X, int _Y, int _Button, bool _IsButtonDown, bool _IsDoubleClick, int _WheelDelta)
+{
+	if(m_isReplaying)
+	{
+		return true;
+	}
+
+	// The camera is only controlled with the keyboard so far, the mouse events are just recorded.
+	m_InputRecorder.RecordMouseEvent(m_IndexOfFrame, _X, _Y, _Button, _IsButtonDown, _IsDoubleClick, _WheelDelta);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CApplication::HandleKeyEvent(unsigned int _Key, bool _IsKeyDown, bool _IsAltDown)
+{
+	// Movement of the camera position
+	if(_Key == 'W' && _IsKeyDown)
+	{
+		m_radius -= m_interval * 2;
+		std::cout << "Move camera forward" << std::endl;
+	}
+	if((_Key == 'A' || _Key == 37) && _IsKeyDown)
+	{
+		m_alpha += m_interval;
+		std::cout << "Move camera right" << std::endl;
+	}
+	if(_Key == 'S' && _IsKeyDown)
+	{
+		m_radius += m_interval * 2;
+		std::cout << "Move camera backward" << std::endl;
+	}
+	if((_Key == 'D' || _Key == 39) && _IsKeyDown)
+	{
+		m_alpha -= m_interval;
+		std::cout << "Move camera left" << std::endl;
+	}
+	if(_Key == 40 && _IsKeyDown)
+	{
+		m_camPosY -= m_interval * 2;
+		std::cout << "Move camera down" << std::endl;
+	}
+	if(_Key == 38 && _IsKeyDown)
+	{
+		m_camPosY += m_interval * 2;
+		std::cout << "Move camera up" << std::endl;
+	}
+
+	// Toggle automatic rotation of camera with spacebar
+	if(_Key == 32 && _IsKeyDown)
+	{
+		m_autoRotation = !m_autoRotation;
+		std::cout << "Toggle automatic rotation" << std::endl;
+	}
+
+	// Toggle drawing of ground
+	if(_Key == 'G' && _IsKeyDown)
+	{
+		m_showGround = !m_showGround;
+		std::cout << "Toggle drawing of ground" << std::endl;
+	}
+
+	// Toggle occlusion culling
+	if(_Key == 'O' && _IsKeyDown)
+	{
+		m_useOcclusionCulling = !m_useOcclusionCulling;
+		std::cout << "Toggle occlusion culling" << std::endl;
+	}
+
+	// Toggle point lights
+	if(_Key == 'L' && _IsKeyDown)
+	{
+		m_usePointLights = !m_usePointLights;
+		std::cout << "Toggle point lights" << std::endl;
+	}
+
+	// Print the usage of the frame memory
+	if(_Key == 'M' && _IsKeyDown)
+	{
+		const SFrameMemoryStatistics& rArena = m_FrameArena.GetStatistics();
+		const SFrameMemoryStatistics& rRing  = m_UploadRing.GetStatistics();
+
+		std::cout << "Frame arena: " << rArena.m_NumberOfUsedBytes << " / " << rArena.m_Capacity << " bytes, high-water mark " << rArena.m_HighWaterMark << ", " << rArena.m_NumberOfOverflowFrames << " frames with overflow" << std::endl;
+		std::cout << "Upload ring: " << rRing.m_NumberOfUsedBytes << " / " << rRing.m_Capacity << " bytes, high-water mark " << rRing.m_HighWaterMark << ", " << rRing.m_NumberOfOverflowFrames << " frames with overflow" << std::endl;
+	}
+
+	// Print the residency of the streamed textures
+	if(_Key == 'T' && _IsKeyDown)
+	{
+		m_TextureStreamer.PrintReport();
+	}
+
+	// Print the memory of the GPU resources
+	if(_Key == 'R' && _IsKeyDown)
+	{
+		PrintResourceReport();
+	}
+
+	// Toggle the quality governor, a replay keeps it turned off to do the same work in every run
+	if(_Key == 'Q' && _IsKeyDown)
+	{
+		m_useQualityGovernor = !m_useQualityGovernor && !m_isReplaying;
+		std::cout << (m_isReplaying ? "Quality governor stays off during a replay" : "Toggle quality governor") << std::endl;
+
+		m_QualityGovernor.PrintReport();
+	}
+
+	// Set the quality level by hand, this turns off the quality governor
+	if(_Key >= '0' && _Key < '0' + static_cast<unsigned int>(m_QualityGovernor.GetNumberOfLevels()) && _IsKeyDown)
+	{
+		m_useQualityGovernor = false;
+
+		m_QualityGovernor.SetLevel(_Key - '0');
+	}
+}
@@ -0,0 +1,243 @@
+
+#pragma once
+
+#include "yoshix.h"
+#include "billboard_polygon.h"
+#include "clustered_lighting.h"
+#include "frame_memory.h"
+#include "frustum.h"
+#include "input_recording.h"
+#include "occlusion.h"
+#include "quality_governor.h"
+#include "terrain.h"
+#include "texture_streaming.h"
+
+#include <chrono>
+#include <string>
+#include <vector>
+
+// A draw recorded during the frame and submitted after the upload of the object buffer
+struct SDrawCall
+{
+	gfx::BHandle m_pMesh;
+	int          m_IndexOfObject;
+};
+
+// A billboard instance of the scene
+struct SBillboard
+{
+	enum EType
+	{
+		Wall,
+		Tree,
+	};
+
+	float m_Position[3];
+	EType m_Type;
+};
+
+// -----------------------------------------------------------------------------
+// What the last frame did and the CPU time of its stages in milliseconds. The
+// stages follow each other, together they make up the CPU time of the frame.
+// -----------------------------------------------------------------------------
+struct SFrameStatistics
+{
+	double m_UpdateTime;                // Camera, view matrix and light animation.
+	double m_TerrainTime;               // Selecting the terrain chunks.
+	double m_LightingTime;              // Binning the point lights into the clusters.
+	double m_OccluderTime;              // Selecting and rasterizing the occluding walls.
+	double m_CullingTime;               // Testing the billboards against distance, frustum and occluders.
+	double m_SubmitTime;                // Filling the object buffer, the uploads and the draws.
+	double m_StreamingTime;             // Texture streaming and creating the billboards again.
+	int    m_NumberOfBillboards;
+	int    m_NumberOfOccluders;
+	int    m_NumberOfVisibleBillboards; // Billboards which passed the culling.
+	int    m_NumberOfDrawnBillboards;   // Visible billboards within the limits of the quality level and the object buffer.
+};
+
+// -----------------------------------------------------------------------------
+// The billboard application. It is started with 'RunApplication' by the viewer
+// and by the benchmark, which runs it without a window. The stress benchmark
+// drives the frames itself to move the camera between them.
+// -----------------------------------------------------------------------------
+
+class CApplication : public gfx::IApplication
+{
+public:
+
+	CApplication();
+	virtual ~CApplication();
+
+public:
+
+	// Records the input of the run into the file, which is written at shutdown.
+	void StartRecording(const char* _pFileName, int _Width, int _Height);
+
+	// -----------------------------------------------------------------------------
+	// Replays the input of a recording instead of the user input and stops the
+	// application after the last recorded frame. Returns the window size of the
+	// recording. The frame timings are written to the timing file if one is given.
+	// -----------------------------------------------------------------------------
+	bool StartReplay(const char* _pFileName, const char* _pTimingFileName, int& _rWidth, int& _rHeight);
+
+	// -----------------------------------------------------------------------------
+	// Replaces the billboards of the scene. The walls are moved in front of the
+	// trees, so the opaque walls are drawn before the transparent trees.
+	// -----------------------------------------------------------------------------
+	void SetScene(const std::vector<SBillboard>& _rBillboards);
+
+	// Replaces the heightmap of the terrain, e.g. with a test heightmap. Has to be called before the startup.
+	void SetHeightmap(const char* _pFileName);
+
+	// Places the camera on its circle around the center, e.g. to follow a scripted path.
+	void SetCameraOrbit(float _Radius, float _Angle, float _Height);
+
+	// The number of threads culling the billboards and binning the lights. Zero uses one thread per core.
+	void SetNumberOfThreads(int _NumberOfThreads);
+
+	// Fixes the quality level and turns off the quality governor.
+	void SetQualityLevel(int _Level);
+
+	const SFrameStatistics& GetFrameStatistics() const;
+
+private:
+
+	float   m_FieldOfViewY;             // Vertical view angle of the camera
+	float   m_ViewMatrix[16];           // The view matrix to transform a mesh from world space into view space.
+	float   m_ProjectionMatrix[16];     // The projection matrix to transform a mesh from view space into clip space.
+
+	gfx::BHandle m_pVertexConstantBuffer;    // A pointer to a YoshiX constant buffer, which defines global data for a vertex shader.
+	gfx::BHandle m_pDrawConstantBuffer;          // The index of the object constants of the current draw.
+	gfx::BHandle m_pObjectConstantBuffer;        // The constants of all billboards of a frame, uploaded at once.
+	gfx::BHandle m_pPixelConstantBuffer;		// A pointer to a YoshiX constant buffer, which defines global data for a vertex shader.
+	gfx::BHandle m_pLightConstantBuffer;         // The point lights for the pixel shader.
+	gfx::BHandle m_pClusterConstantBuffer;       // The light grid for the pixel shader.
+	gfx::BHandle m_pLightIndexConstantBuffer;    // The light index lists of the clusters for the pixel shader.
+
+	gfx::BHandle m_pVertexShader;            // A pointer to a YoshiX vertex shader, which processes each single vertex of the mesh.
+	gfx::BHandle m_pPixelShader;             // A pointer to a YoshiX pixel shader, which computes the color of each pixel visible of the mesh on the screen.
+
+	gfx::BHandle m_pMaterialTree;                // A pointer to a YoshiX material, spawning the surface of the mesh.
+	gfx::BHandle m_pMeshTree;                    // A pointer to a YoshiX mesh, which represents a single triangle.
+
+	gfx::BHandle m_pMaterialWall;                // A pointer to a YoshiX material, spawning the surface of the mesh.
+	gfx::BHandle m_pMeshWall;                    // A pointer to a YoshiX mesh, which represents a single triangle.
+
+	gfx::BHandle m_pColorTextureTree;			// A pointer to a texture which contains a tree picture to display.
+	gfx::BHandle m_pNormalTextureTree;			// A pointer to a texture which contains the normal for the the previous picture.
+
+	gfx::BHandle m_pColorTextureWall;			// A pointer to a texture which contains a wall picture to display.
+	gfx::BHandle m_pNormalTextureWall;			// A pointer to a texture which contains the normal for the the previous picture.
+
+	// Texture streaming
+	CTextureStreamer  m_TextureStreamer;		// Loads the mip levels of the billboard textures the instances need on the screen.
+	int               m_IndexOfColorTextureTree;
+	int               m_IndexOfNormalTextureTree;
+	int               m_IndexOfColorTextureWall;
+	int               m_IndexOfNormalTextureWall;
+	SBillboardPolygon m_PolygonTree;			// The geometry of the billboard meshes, kept to create them again.
+	SBillboardPolygon m_PolygonWall;
+
+	// Ground
+	gfx::BHandle m_pGroundVertexConstantBuffer;
+	gfx::BHandle m_pGroundVertexShader;
+	gfx::BHandle m_pGroundPixelShader;
+	gfx::BHandle m_pGroundMaterial;
+	gfx::BHandle m_pGroundTexture;
+	CTerrain m_Terrain;					// The ground is a chunked heightfield drawn with the ground material.
+	std::string m_HeightmapFileName;	// A DDS or raw file, the terrain is flat if it can not be loaded.
+
+	// Scene
+	std::vector<SBillboard> m_Billboards;		// The walls first, then the trees.
+	int                     m_NumberOfWalls;
+	int                     m_NumberOfThreads;	// The number of threads culling the billboards, zero uses one thread per core.
+
+	// Culling
+	COcclusionCuller              m_OcclusionCuller;	// Rasterizes the walls on the CPU to skip billboards hidden behind them.
+	std::vector<std::vector<int>> m_CullingBlocks;		// The billboards found visible in each block of the culling, kept to reuse their memory.
+	std::vector<int>              m_Occluders;			// The walls rasterized into the occlusion buffer this frame.
+	std::vector<int>              m_VisibleBillboards;	// The billboards which passed the culling this frame, the drawn ones first in the order of the scene.
+
+	// Point lights
+	CClusteredLighting       m_ClusteredLighting;	// Sorts the point lights into clusters of the view for the billboard shader.
+	std::vector<SPointLight> m_PointLights;			// Lanterns and fires spread over the terrain.
+	float                    m_PointLightTime;		// Drives the flickering of the point lights.
+
+	int m_ScreenWidth;
+	int m_ScreenHeight;
+
+	// Frame memory
+	CFrameArena m_FrameArena;			// Short-lived CPU data of the current frame, reset at frame start.
+	CUploadRing m_UploadRing;			// The object constants of the current frame.
+
+	// Input recording and replay
+	CInputRecorder m_InputRecorder;
+	CInputPlayer   m_InputPlayer;
+	std::string    m_FrameTimingFileName;
+	bool           m_isReplaying;
+	int            m_IndexOfFrame;			// The number of frames completed, recorded events are stamped with it.
+
+	std::chrono::steady_clock::time_point m_FrameStartTime;
+	double                                m_FrameTime;	// Milliseconds from the start of the last frame to the start of this one.
+	double                                m_CPUTime;	// Milliseconds spent in update and frame of the last frame.
+	SFrameStatistics                      m_FrameStatistics;
+
+	// Quality
+	CQualityGovernor m_QualityGovernor;	// Lowers the quality while the frames take longer than the budget.
+
+	// Camera
+	float m_camPosX;
+	float m_camPosY;
+	float m_camPosZ;
+
+	float m_camAtX;
+	float m_camAtY;
+	float m_camAtZ;
+
+	// This can be turned on for a automatic rotation around the center point
+	bool m_autoRotation;
+
+	// Variables for calculating a point on a circle around the center point
+	float m_radius;
+	float m_interval;
+	float m_theta;
+	float m_alpha;
+
+	// Config variables
+	bool m_useTree;		// If this variable is set we use a tree texture instead of the wall
+	bool m_showGround;	// This variable gets used to decide if the ground should be rendered
+	bool m_useTightPolygons;	// If this variable is set the billboards are drawn as polygons around the visible texels instead of full quads
+	bool m_useOcclusionCulling;	// If this variable is set billboards hidden behind the walls are not drawn
+	bool m_usePointLights;		// If this variable is set the billboards are lit by the point lights as well
+	bool m_useQualityGovernor;	// If this variable is set the quality follows the frame time, otherwise the level stays as it is
+
+private:
+
+	virtual bool InternOnCreateConstantBuffers();
+	virtual bool InternOnReleaseConstantBuffers();
+	virtual bool InternOnCreateShader();
+	virtual bool InternOnReleaseShader();
+	virtual bool InternOnCreateMaterials();
+	virtual bool InternOnReleaseMaterials();
+	virtual bool InternOnCreateMeshes();
+	virtual bool InternOnReleaseMeshes();
+	virtual bool InternOnCreateTextures();
+	virtual bool InternOnReleaseTextures();
+	virtual bool InternOnResize(int _Width, int _Height);
+	virtual bool InternOnShutdown();
+	virtual bool InternOnKeyEvent(unsigned int _Key, bool _IsKeyDown, bool _IsAltDown);
+	virtual bool InternOnMouseEvent(int _X, int _Y, int _Button, bool _IsButtonDown, bool _IsDoubleClick, int _WheelDelta);
+	virtual bool InternOnUpdate();
+	virtual bool InternOnFrame();
+	virtual void UploadFrameConstants();
+	virtual void AddDrawCall(gfx::BHandle _pMesh, const float* _pPosition, SDrawCall* _pDrawCalls, int& _rNumberOfDrawCalls);
+	virtual bool Draw(gfx::BHandle _pMesh, int _IndexOfObject);
+	virtual void CreateBillboardMaterial(gfx::BHandle _pColorTexture, gfx::BHandle _pNormalTexture, gfx::BHandle* _ppMaterial);
+	virtual void CreateBillboardMeshes();
+	virtual void RecreateBillboards();
+	virtual void RequestBillboardTextures(int _IndexOfColorTexture, int _IndexOfNormalTexture, const float* _pPosition);
+	virtual void CullBillboards(int _IndexOfFirst, int _NumberOfBillboards, float _MaxDistance, const SFrustum& _rFrustum, bool _UseOcclusionCulling, std::vector<int>& _rVisibleBillboards);
+	virtual void AddOccluders(const SFrustum& _rFrustum);
+	virtual void ReplayInput();
+	virtual void HandleKeyEvent(unsigned int _Key, bool _IsKeyDown, bool _IsAltDown);
+};
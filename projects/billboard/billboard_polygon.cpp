@@ -0,0 +1,316 @@
+
+#include "billboard_polygon.h"
+#include "dds_file.h"
+#include "mesh_import.h"
+
+#include <math.h>
+#include <algorithm>
+#include <iostream>
+
+namespace
+{
+	struct SPoint
+	{
+		double m_X;
+		double m_Y;
+	};
+
+	// Z component of the cross product of (A - O) and (B - O). Positive if O, A, B
+	// turn counter-clockwise.
+	double GetCross(const SPoint& _rO, const SPoint& _rA, const SPoint& _rB)
+	{
+		return (_rA.m_X - _rO.m_X) * (_rB.m_Y - _rO.m_Y) - (_rA.m_Y - _rO.m_Y) * (_rB.m_X - _rO.m_X);
+	}
+
+	double GetArea(const std::vector<SPoint>& _rPolygon)
+	{
+		double Area = 0.0;
+
+		for(size_t IndexOfPoint = 0; IndexOfPoint < _rPolygon.size(); ++ IndexOfPoint)
+		{
+			const SPoint& rA = _rPolygon[IndexOfPoint];
+			const SPoint& rB = _rPolygon[(IndexOfPoint + 1) % _rPolygon.size()];
+
+			Area += rA.m_X * rB.m_Y - rB.m_X * rA.m_Y;
+		}
+
+		return fabs(Area) * 0.5;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Andrew's monotone chain. Returns the hull counter-clockwise without collinear
+	// points.
+	// -----------------------------------------------------------------------------
+	void GetConvexHull(std::vector<SPoint>& _rPoints, std::vector<SPoint>& _rHull)
+	{
+		std::sort(_rPoints.begin(), _rPoints.end(), [](const SPoint& _rA, const SPoint& _rB)
+		{
+			return _rA.m_X < _rB.m_X || (_rA.m_X == _rB.m_X && _rA.m_Y < _rB.m_Y);
+		});
+
+		_rHull.assign(_rPoints.size() * 2, SPoint());
+
+		size_t NumberOfPoints = 0;
+
+		for(size_t IndexOfPoint = 0; IndexOfPoint < _rPoints.size(); ++ IndexOfPoint)
+		{
+			while(NumberOfPoints >= 2 && GetCross(_rHull[NumberOfPoints - 2], _rHull[NumberOfPoints - 1], _rPoints[IndexOfPoint]) <= 0.0)
+			{
+				-- NumberOfPoints;
+			}
+
+			_rHull[NumberOfPoints ++] = _rPoints[IndexOfPoint];
+		}
+
+		for(size_t IndexOfPoint = _rPoints.size() - 1, LowerSize = NumberOfPoints + 1; IndexOfPoint > 0; -- IndexOfPoint)
+		{
+			while(NumberOfPoints >= LowerSize && GetCross(_rHull[NumberOfPoints - 2], _rHull[NumberOfPoints - 1], _rPoints[IndexOfPoint - 1]) <= 0.0)
+			{
+				-- NumberOfPoints;
+			}
+
+			_rHull[NumberOfPoints ++] = _rPoints[IndexOfPoint - 1];
+		}
+
+		_rHull.resize(NumberOfPoints > 1 ? NumberOfPoints - 1 : NumberOfPoints);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Reduces a convex polygon to the vertex budget. Removing an edge means
+	// extending its two neighbor edges until they meet, which keeps everything
+	// inside covered. In each step the edge adding the smallest area is removed.
+	// Intersections outside of the quad are not allowed, since the texture would
+	// wrap around there.
+	// -----------------------------------------------------------------------------
+	void ReducePolygon(std::vector<SPoint>& _rPolygon, int _MaxNumberOfVertices)
+	{
+		const double Epsilon = 1.0e-9;
+
+		while(static_cast<int>(_rPolygon.size()) > _MaxNumberOfVertices)
+		{
+			size_t NumberOfPoints = _rPolygon.size();
+			size_t BestEdge       = NumberOfPoints;
+			double BestArea       = 0.0;
+			SPoint BestPoint      = { 0.0, 0.0 };
+
+			for(size_t IndexOfEdge = 0; IndexOfEdge < NumberOfPoints; ++ IndexOfEdge)
+			{
+				const SPoint& rPrevious = _rPolygon[(IndexOfEdge + NumberOfPoints - 1) % NumberOfPoints];
+				const SPoint& rA        = _rPolygon[IndexOfEdge];
+				const SPoint& rB        = _rPolygon[(IndexOfEdge + 1) % NumberOfPoints];
+				const SPoint& rNext     = _rPolygon[(IndexOfEdge + 2) % NumberOfPoints];
+
+				// Solve A + t * (A - Previous) = B + s * (B - Next) for t, s >= 0.
+				double DirectionAX = rA.m_X - rPrevious.m_X;
+				double DirectionAY = rA.m_Y - rPrevious.m_Y;
+				double DirectionBX = rB.m_X - rNext.m_X;
+				double DirectionBY = rB.m_Y - rNext.m_Y;
+
+				double Denominator = DirectionAX * DirectionBY - DirectionAY * DirectionBX;
+
+				if(fabs(Denominator) < Epsilon)
+				{
+					continue;
+				}
+
+				double T = ((rB.m_X - rA.m_X) * DirectionBY - (rB.m_Y - rA.m_Y) * DirectionBX) / Denominator;
+				double S = ((rB.m_X - rA.m_X) * DirectionAY - (rB.m_Y - rA.m_Y) * DirectionAX) / Denominator;
+
+				if(T < 0.0 || S < 0.0)
+				{
+					continue;
+				}
+
+				SPoint Intersection = { rA.m_X + T * DirectionAX, rA.m_Y + T * DirectionAY };
+
+				if(fabs(Intersection.m_X) > 1.0 + Epsilon || fabs(Intersection.m_Y) > 1.0 + Epsilon)
+				{
+					continue;
+				}
+
+				double Area = fabs(GetCross(rA, Intersection, rB)) * 0.5;
+
+				if(BestEdge == NumberOfPoints || Area < BestArea)
+				{
+					BestEdge  = IndexOfEdge;
+					BestArea  = Area;
+					BestPoint = Intersection;
+				}
+			}
+
+			if(BestEdge == NumberOfPoints)
+			{
+				break;
+			}
+
+			// Replace the two end points of the removed edge by the intersection.
+			_rPolygon[BestEdge] = BestPoint;
+			_rPolygon.erase(_rPolygon.begin() + (BestEdge + 1) % NumberOfPoints);
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// Writes the interleaved vertices and the fan indices of a counter-clockwise
+	// polygon in quad object space.
+	// -----------------------------------------------------------------------------
+	void FillPolygonMesh(const std::vector<SPoint>& _rPoints, SBillboardPolygon& _rPolygon)
+	{
+		_rPolygon.m_Vertices.clear();
+		_rPolygon.m_Indices .clear();
+
+		for(const SPoint& rPoint : _rPoints)
+		{
+			float X = static_cast<float>(std::min(std::max(rPoint.m_X, -1.0), 1.0));
+			float Y = static_cast<float>(std::min(std::max(rPoint.m_Y, -1.0), 1.0));
+
+			float Vertex[g_NumberOfFloatsPerImportedVertex] =
+			{
+				X, Y, 0.0f,                                 // Position
+				0.0f, 0.0f, 0.0f,                           // Tangent, generated below
+				0.0f, 0.0f, 0.0f,                           // Binormal, generated below
+				0.0f, 0.0f, -1.0f,                          // Normal
+				(X + 1.0f) * 0.5f, (1.0f - Y) * 0.5f,       // TexCoord
+			};
+
+			_rPolygon.m_Vertices.insert(_rPolygon.m_Vertices.end(), Vertex, Vertex + g_NumberOfFloatsPerImportedVertex);
+		}
+
+		for(int IndexOfVertex = 2; IndexOfVertex < static_cast<int>(_rPoints.size()); ++ IndexOfVertex)
+		{
+			_rPolygon.m_Indices.push_back(0);
+			_rPolygon.m_Indices.push_back(IndexOfVertex - 1);
+			_rPolygon.m_Indices.push_back(IndexOfVertex);
+		}
+
+		GenerateTangentFrames(_rPolygon.m_Vertices.data(), _rPolygon.GetNumberOfVertices(), _rPolygon.m_Indices.data(), _rPolygon.GetNumberOfIndices(), SImportSettings());
+	}
+
+	void GetQuad(std::vector<SPoint>& _rPolygon)
+	{
+		SPoint Quad[4] = { { -1.0, -1.0 }, { 1.0, -1.0 }, { 1.0, 1.0 }, { -1.0, 1.0 } };
+
+		_rPolygon.assign(Quad, Quad + 4);
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+SBillboardPolygonSettings::SBillboardPolygonSettings()
+	: m_MaxNumberOfVertices(8)
+	, m_AlphaThreshold     (0.0f)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+int SBillboardPolygon::GetNumberOfVertices() const
+{
+	return static_cast<int>(m_Vertices.size() / g_NumberOfFloatsPerImportedVertex);
+}
+
+// -----------------------------------------------------------------------------
+
+int SBillboardPolygon::GetNumberOfIndices() const
+{
+	return static_cast<int>(m_Indices.size());
+}
+
+// -----------------------------------------------------------------------------
+
+void BuildBillboardPolygon(const unsigned char* _pPixels, int _Width, int _Height, const SBillboardPolygonSettings& _rSettings, SBillboardPolygon& _rPolygon)
+{
+	std::vector<SPoint> Points;
+	std::vector<SPoint> Polygon;
+
+	int Threshold = static_cast<int>(_rSettings.m_AlphaThreshold * 255.0f);
+
+	_rPolygon.m_TextureWidth          = _Width;
+	_rPolygon.m_TextureHeight         = _Height;
+	_rPolygon.m_NumberOfVisibleTexels = 0;
+
+	// -----------------------------------------------------------------------------
+	// Only the left- and rightmost visible texel of each row can lie on the hull.
+	// Take the outer corners of these texels in quad object space.
+	// -----------------------------------------------------------------------------
+	for(int Y = 0; Y < _Height; ++ Y)
+	{
+		int MinX = _Width;
+		int MaxX = -1;
+
+		for(int X = 0; X < _Width; ++ X)
+		{
+			if(_pPixels[(static_cast<size_t>(Y) * _Width + X) * 4 + 3] > Threshold)
+			{
+				MinX = std::min(MinX, X);
+				MaxX = X;
+
+				++ _rPolygon.m_NumberOfVisibleTexels;
+			}
+		}
+
+		if(MaxX < 0)
+		{
+			continue;
+		}
+
+		double Top    = 1.0 - 2.0 * Y / _Height;
+		double Bottom = 1.0 - 2.0 * (Y + 1) / _Height;
+		double Left   = -1.0 + 2.0 * MinX / _Width;
+		double Right  = -1.0 + 2.0 * (MaxX + 1) / _Width;
+
+		SPoint Corners[4] = { { Left, Top }, { Left, Bottom }, { Right, Top }, { Right, Bottom } };
+
+		Points.insert(Points.end(), Corners, Corners + 4);
+	}
+
+	if(Points.empty())
+	{
+		GetQuad(Polygon);
+	}
+	else
+	{
+		GetConvexHull(Points, Polygon);
+
+		ReducePolygon(Polygon, std::max(_rSettings.m_MaxNumberOfVertices, 3));
+
+		// The quad has fewer vertices, so only use the polygon if it saves pixels.
+		if(GetArea(Polygon) > 4.0 * 0.99)
+		{
+			GetQuad(Polygon);
+		}
+	}
+
+	_rPolygon.m_AreaRatio = static_cast<float>(GetArea(Polygon) / 4.0);
+
+	FillPolygonMesh(Polygon, _rPolygon);
+}
+
+// -----------------------------------------------------------------------------
+
+bool BuildBillboardPolygon(const char* _pTexturePath, const SBillboardPolygonSettings& _rSettings, SBillboardPolygon& _rPolygon)
+{
+	SDDSInfo                   Info;
+	std::vector<unsigned char> Pixels;
+
+	if(!ReadDDSInfo(_pTexturePath, Info) || !ReadDDSLevel(_pTexturePath, Info, 0, Pixels))
+	{
+		unsigned char OpaquePixel[4] = { 255, 255, 255, 255 };
+
+		BuildBillboardPolygon(OpaquePixel, 1, 1, _rSettings, _rPolygon);
+
+		return false;
+	}
+
+	BuildBillboardPolygon(Pixels.data(), Info.m_Width, Info.m_Height, _rSettings, _rPolygon);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void PrintBillboardPolygonReport(const char* _pName, const SBillboardPolygon& _rPolygon)
+{
+	float TexelRatio = static_cast<float>(_rPolygon.m_NumberOfVisibleTexels) / static_cast<float>(std::max(_rPolygon.m_TextureWidth * _rPolygon.m_TextureHeight, 1));
+
+	std::cout << _pName << ": " << _rPolygon.GetNumberOfVertices() << " vertices, covers " << _rPolygon.m_AreaRatio * 100.0f << "% of the quad (" << (1.0f - _rPolygon.m_AreaRatio) * 100.0f << "% fewer pixels), " << TexelRatio * 100.0f << "% of the texels are visible" << std::endl;
+}
@@ -0,0 +1,55 @@
+
+#pragma once
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Builds a tight convex polygon around the visible texels of a billboard
+// texture. Drawing this polygon instead of the full quad skips all the fully
+// transparent texels, which would otherwise run the whole normal mapping pixel
+// shader and blending just to be discarded.
+//
+// The polygon is built in the object space of the billboard quad, i.e. it
+// covers [-1, 1] x [-1, 1] at z = 0 with texture coordinate (0, 0) at the top
+// left corner, and its vertices use the same 14 float layout as the quad.
+// -----------------------------------------------------------------------------
+
+struct SBillboardPolygonSettings
+{
+	SBillboardPolygonSettings();
+
+	int   m_MaxNumberOfVertices;    // The vertex budget of the polygon, 6 to 8 gives the best ratio between saved pixels and vertex cost.
+	float m_AlphaThreshold;         // Texels with an alpha above this value (0..1) are visible and have to be covered.
+};
+
+struct SBillboardPolygon
+{
+	std::vector<float> m_Vertices;  // The interleaved vertices, 14 floats per vertex like the billboard quad.
+	std::vector<int>   m_Indices;   // Fan triangulation of the polygon, three indices per triangle.
+
+	int   m_TextureWidth;           // The size of the analyzed texture in pixels.
+	int   m_TextureHeight;
+	int   m_NumberOfVisibleTexels;  // The number of texels above the alpha threshold.
+	float m_AreaRatio;              // Area of the polygon relative to the full quad (1 means no savings).
+
+	int GetNumberOfVertices() const;
+	int GetNumberOfIndices() const;
+};
+
+// -----------------------------------------------------------------------------
+// Builds the polygon from RGBA pixels (four bytes per pixel, top row first).
+// If no texel is visible or the texture is completely covered, the result is
+// the full quad.
+// -----------------------------------------------------------------------------
+void BuildBillboardPolygon(const unsigned char* _pPixels, int _Width, int _Height, const SBillboardPolygonSettings& _rSettings, SBillboardPolygon& _rPolygon);
+
+// -----------------------------------------------------------------------------
+// Loads the top level of a DDS texture and builds its polygon. Returns false if
+// the file could not be read; the polygon then holds the full quad.
+// -----------------------------------------------------------------------------
+bool BuildBillboardPolygon(const char* _pTexturePath, const SBillboardPolygonSettings& _rSettings, SBillboardPolygon& _rPolygon);
+
+// -----------------------------------------------------------------------------
+// Prints vertex count and the saved pixel area of a polygon.
+// -----------------------------------------------------------------------------
+void PrintBillboardPolygonReport(const char* _pName, const SBillboardPolygon& _rPolygon);
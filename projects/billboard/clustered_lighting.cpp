@@ -0,0 +1,407 @@
+
+#include "clustered_lighting.h"
+#include "parallel.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <initializer_list>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define CLUSTERED_LIGHTING_USE_SSE2
+#endif
+
+namespace
+{
+	// Below this number of lights binning on one thread is faster than starting more.
+	const int g_MinNumberOfLightsPerThread = 64;
+
+	// Padding lights are placed this far away, so they never touch a cluster.
+	const float g_FarAway = 1.0e18f;
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+SClusteredLightingSettings::SClusteredLightingSettings()
+	: m_NumberOfThreads    (0)
+	, m_MaxLightsPerCluster(64)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CClusteredLighting::CClusteredLighting()
+	: m_ClusterMinX      (g_NumberOfClusters)
+	, m_ClusterMaxX      (g_NumberOfClusters)
+	, m_ClusterMinY      (g_NumberOfClusters)
+	, m_ClusterMaxY      (g_NumberOfClusters)
+	, m_Slices           (g_NumberOfClustersZ)
+	, m_ClusterCounts    (g_NumberOfClusters, 0)
+	, m_pLightBuffer     (new SLightBuffer())
+	, m_pClusterBuffer   (new SClusterBuffer())
+	, m_pLightIndexBuffer(new SLightIndexBuffer())
+{
+	memset(m_ProjectionMatrix, 0, sizeof(m_ProjectionMatrix));
+	memset(&m_Statistics,      0, sizeof(m_Statistics));
+}
+
+// -----------------------------------------------------------------------------
+
+void CClusteredLighting::Create(const SClusteredLightingSettings& _rSettings)
+{
+	m_Settings = _rSettings;
+
+	m_Settings.m_MaxLightsPerCluster = std::min(std::max(m_Settings.m_MaxLightsPerCluster, 1), 0xFFFF);
+}
+
+// -----------------------------------------------------------------------------
+
+void CClusteredLighting::Update(const float* _pViewMatrix, const float* _pProjectionMatrix, int _Width, int _Height, const SPointLight* _pLights, int _NumberOfLights)
+{
+	std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+	int NumberOfLights = std::min(std::max(_NumberOfLights, 0), g_MaxNumberOfPointLights);
+
+	if(memcmp(m_ProjectionMatrix, _pProjectionMatrix, sizeof(m_ProjectionMatrix)) != 0)
+	{
+		BuildClusterBounds(_pProjectionMatrix);
+	}
+
+	const float* pP = _pProjectionMatrix;
+
+	float Near = -pP[14] / pP[10];
+	float Far  =  pP[14] / (1.0f - pP[10]);
+
+	// -----------------------------------------------------------------------------
+	// The shader finds its cluster from the pixel position and the view depth:
+	// tile = pixel * scale, slice = log(depth) * scale + bias.
+	// -----------------------------------------------------------------------------
+	SClusterBuffer& rClusterBuffer = *m_pClusterBuffer;
+
+	rClusterBuffer.m_ClusterScale[0] = static_cast<float>(g_NumberOfClustersX) / std::max(_Width,  1);
+	rClusterBuffer.m_ClusterScale[1] = static_cast<float>(g_NumberOfClustersY) / std::max(_Height, 1);
+	rClusterBuffer.m_ClusterScale[2] = g_NumberOfClustersZ / logf(Far / Near);
+	rClusterBuffer.m_ClusterScale[3] = -logf(Near) * rClusterBuffer.m_ClusterScale[2];
+
+	rClusterBuffer.m_NumberOfClusters[0] = g_NumberOfClustersX;
+	rClusterBuffer.m_NumberOfClusters[1] = g_NumberOfClustersY;
+	rClusterBuffer.m_NumberOfClusters[2] = g_NumberOfClustersZ;
+	rClusterBuffer.m_NumberOfClusters[3] = 0;
+
+	// -----------------------------------------------------------------------------
+	// Fill the light buffer and transform the lights inside of the depth range
+	// into view space.
+	// -----------------------------------------------------------------------------
+	SLightBuffer& rLightBuffer = *m_pLightBuffer;
+
+	m_LightX     .clear();
+	m_LightY     .clear();
+	m_LightZ     .clear();
+	m_LightRadius.clear();
+
+	std::vector<int> VisibleLights;
+
+	VisibleLights.reserve(NumberOfLights);
+
+	for(int IndexOfLight = 0; IndexOfLight < NumberOfLights; ++ IndexOfLight)
+	{
+		const SPointLight& rLight = _pLights[IndexOfLight];
+		const float*       pV     = _pViewMatrix;
+
+		rLightBuffer.m_PositionRadius[IndexOfLight][0] = rLight.m_Position[0];
+		rLightBuffer.m_PositionRadius[IndexOfLight][1] = rLight.m_Position[1];
+		rLightBuffer.m_PositionRadius[IndexOfLight][2] = rLight.m_Position[2];
+		rLightBuffer.m_PositionRadius[IndexOfLight][3] = rLight.m_Radius;
+
+		rLightBuffer.m_Color[IndexOfLight][0] = rLight.m_Color[0] * rLight.m_Intensity;
+		rLightBuffer.m_Color[IndexOfLight][1] = rLight.m_Color[1] * rLight.m_Intensity;
+		rLightBuffer.m_Color[IndexOfLight][2] = rLight.m_Color[2] * rLight.m_Intensity;
+		rLightBuffer.m_Color[IndexOfLight][3] = 0.0f;        // Point lights must not change the alpha of the billboards.
+
+		float X = rLight.m_Position[0] * pV[0] + rLight.m_Position[1] * pV[4] + rLight.m_Position[2] * pV[ 8] + pV[12];
+		float Y = rLight.m_Position[0] * pV[1] + rLight.m_Position[1] * pV[5] + rLight.m_Position[2] * pV[ 9] + pV[13];
+		float Z = rLight.m_Position[0] * pV[2] + rLight.m_Position[1] * pV[6] + rLight.m_Position[2] * pV[10] + pV[14];
+
+		if(rLight.m_Radius <= 0.0f || Z + rLight.m_Radius < Near || Z - rLight.m_Radius > Far)
+		{
+			continue;
+		}
+
+		m_LightX     .push_back(X);
+		m_LightY     .push_back(Y);
+		m_LightZ     .push_back(Z);
+		m_LightRadius.push_back(rLight.m_Radius);
+
+		VisibleLights.push_back(IndexOfLight);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Every slice is binned on its own, so the slices are spread over the threads.
+	// Each slice first collects the lights overlapping its depth range and then
+	// tests them against its clusters.
+	// -----------------------------------------------------------------------------
+	int NumberOfVisibleLights = static_cast<int>(VisibleLights.size());
+	int NumberOfThreads       = NumberOfVisibleLights >= g_MinNumberOfLightsPerThread ? m_Settings.m_NumberOfThreads : 1;
+
+	ParallelFor(g_NumberOfClustersZ, NumberOfThreads, [&](int _Begin, int _End)
+	{
+		for(int IndexOfSlice = _Begin; IndexOfSlice < _End; ++ IndexOfSlice)
+		{
+			SSlice& rSlice = m_Slices[IndexOfSlice];
+
+			rSlice.m_LightX     .clear();
+			rSlice.m_LightY     .clear();
+			rSlice.m_LightZ     .clear();
+			rSlice.m_LightRadius.clear();
+			rSlice.m_Lights     .clear();
+
+			for(int IndexOfVisible = 0; IndexOfVisible < NumberOfVisibleLights; ++ IndexOfVisible)
+			{
+				if(m_LightZ[IndexOfVisible] + m_LightRadius[IndexOfVisible] < rSlice.m_MinZ || m_LightZ[IndexOfVisible] - m_LightRadius[IndexOfVisible] > rSlice.m_MaxZ)
+				{
+					continue;
+				}
+
+				rSlice.m_LightX     .push_back(m_LightX[IndexOfVisible]);
+				rSlice.m_LightY     .push_back(m_LightY[IndexOfVisible]);
+				rSlice.m_LightZ     .push_back(m_LightZ[IndexOfVisible]);
+				rSlice.m_LightRadius.push_back(m_LightRadius[IndexOfVisible]);
+				rSlice.m_Lights     .push_back(VisibleLights[IndexOfVisible]);
+			}
+
+			BinSlice(IndexOfSlice);
+		}
+	}, 1);
+
+	// -----------------------------------------------------------------------------
+	// Concatenate the lists of all clusters into the index buffer.
+	// -----------------------------------------------------------------------------
+	SLightIndexBuffer& rLightIndexBuffer = *m_pLightIndexBuffer;
+
+	int Offset             = 0;
+	int MaxLightsInCluster = 0;
+	int NumberOfDropped    = 0;
+
+	for(int IndexOfSlice = 0; IndexOfSlice < g_NumberOfClustersZ; ++ IndexOfSlice)
+	{
+		const SSlice& rSlice = m_Slices[IndexOfSlice];
+
+		const int* pSliceIndices = rSlice.m_Indices.data();
+
+		for(int IndexOfTile = 0; IndexOfTile < g_NumberOfClustersX * g_NumberOfClustersY; ++ IndexOfTile)
+		{
+			int IndexOfCluster  = IndexOfSlice * g_NumberOfClustersX * g_NumberOfClustersY + IndexOfTile;
+			int Count           = m_ClusterCounts[IndexOfCluster];
+			int NumberOfFitting = std::min(Count, g_MaxNumberOfLightIndices - Offset);
+
+			for(int IndexOfEntry = 0; IndexOfEntry < NumberOfFitting; ++ IndexOfEntry)
+			{
+				rLightIndexBuffer.m_Indices[Offset + IndexOfEntry] = static_cast<unsigned short>(pSliceIndices[IndexOfEntry]);
+			}
+
+			rClusterBuffer.m_Cells[IndexOfCluster] = static_cast<unsigned int>(Offset) | (static_cast<unsigned int>(NumberOfFitting) << 16);
+
+			pSliceIndices += Count;
+
+			Offset             += NumberOfFitting;
+			MaxLightsInCluster  = std::max(MaxLightsInCluster, Count);
+			NumberOfDropped    += Count - NumberOfFitting;
+		}
+
+		NumberOfDropped += rSlice.m_NumberOfDropped;
+	}
+
+	m_Statistics.m_NumberOfLights         = NumberOfLights;
+	m_Statistics.m_NumberOfVisibleLights  = NumberOfVisibleLights;
+	m_Statistics.m_NumberOfLightIndices   = Offset;
+	m_Statistics.m_MaxLightsInCluster     = MaxLightsInCluster;
+	m_Statistics.m_NumberOfDroppedIndices = NumberOfDropped;
+	m_Statistics.m_BinningTime            = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - StartTime).count();
+}
+
+// -----------------------------------------------------------------------------
+
+SLightBuffer* CClusteredLighting::GetLightBuffer()
+{
+	return m_pLightBuffer.get();
+}
+
+// -----------------------------------------------------------------------------
+
+SClusterBuffer* CClusteredLighting::GetClusterBuffer()
+{
+	return m_pClusterBuffer.get();
+}
+
+// -----------------------------------------------------------------------------
+
+SLightIndexBuffer* CClusteredLighting::GetLightIndexBuffer()
+{
+	return m_pLightIndexBuffer.get();
+}
+
+// -----------------------------------------------------------------------------
+
+const SClusteredLightingStatistics& CClusteredLighting::GetStatistics() const
+{
+	return m_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+// Computes the view space bounding box of every cluster. The slices divide the
+// depth range exponentially, so the clusters are roughly cubes. Tile row zero
+// is at the top of the screen like the pixel rows.
+// -----------------------------------------------------------------------------
+void CClusteredLighting::BuildClusterBounds(const float* _pProjectionMatrix)
+{
+	memcpy(m_ProjectionMatrix, _pProjectionMatrix, sizeof(m_ProjectionMatrix));
+
+	const float* pP = _pProjectionMatrix;
+
+	float Near = -pP[14] / pP[10];
+	float Far  =  pP[14] / (1.0f - pP[10]);
+
+	for(int IndexOfSlice = 0; IndexOfSlice < g_NumberOfClustersZ; ++ IndexOfSlice)
+	{
+		SSlice& rSlice = m_Slices[IndexOfSlice];
+
+		rSlice.m_MinZ = Near * powf(Far / Near, static_cast<float>(IndexOfSlice    ) / g_NumberOfClustersZ);
+		rSlice.m_MaxZ = Near * powf(Far / Near, static_cast<float>(IndexOfSlice + 1) / g_NumberOfClustersZ);
+
+		for(int Y = 0; Y < g_NumberOfClustersY; ++ Y)
+		{
+			float TopNDC    = 1.0f - 2.0f * static_cast<float>(Y    ) / g_NumberOfClustersY;
+			float BottomNDC = 1.0f - 2.0f * static_cast<float>(Y + 1) / g_NumberOfClustersY;
+
+			for(int X = 0; X < g_NumberOfClustersX; ++ X)
+			{
+				float LeftNDC  = -1.0f + 2.0f * static_cast<float>(X    ) / g_NumberOfClustersX;
+				float RightNDC = -1.0f + 2.0f * static_cast<float>(X + 1) / g_NumberOfClustersX;
+
+				int IndexOfCluster = (IndexOfSlice * g_NumberOfClustersY + Y) * g_NumberOfClustersX + X;
+
+				// -----------------------------------------------------------------------------
+				// With x_ndc = (x * P[0] + z * P[8]) / z a tile edge lies at
+				// x = (x_ndc - P[8]) * z / P[0], the same holds for y. The box has to
+				// contain the edges at the front and at the back of the slice.
+				// -----------------------------------------------------------------------------
+				float MinX =  1.0e30f;
+				float MaxX = -1.0e30f;
+				float MinY =  1.0e30f;
+				float MaxY = -1.0e30f;
+
+				for(float Z : { rSlice.m_MinZ, rSlice.m_MaxZ })
+				{
+					float X0 = (LeftNDC   - pP[8]) * Z / pP[0];
+					float X1 = (RightNDC  - pP[8]) * Z / pP[0];
+					float Y0 = (BottomNDC - pP[9]) * Z / pP[5];
+					float Y1 = (TopNDC    - pP[9]) * Z / pP[5];
+
+					MinX = std::min(MinX, std::min(X0, X1));
+					MaxX = std::max(MaxX, std::max(X0, X1));
+					MinY = std::min(MinY, std::min(Y0, Y1));
+					MaxY = std::max(MaxY, std::max(Y0, Y1));
+				}
+
+				m_ClusterMinX[IndexOfCluster] = MinX;
+				m_ClusterMaxX[IndexOfCluster] = MaxX;
+				m_ClusterMinY[IndexOfCluster] = MinY;
+				m_ClusterMaxY[IndexOfCluster] = MaxY;
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Tests the lights collected for a slice against each of its clusters. A light
+// touches a cluster if the distance between the sphere center and the box is
+// smaller than the radius. With SSE2 four lights are tested at once.
+// -----------------------------------------------------------------------------
+void CClusteredLighting::BinSlice(int _IndexOfSlice)
+{
+	SSlice& rSlice = m_Slices[_IndexOfSlice];
+
+	rSlice.m_Indices.clear();
+	rSlice.m_NumberOfDropped = 0;
+
+	// Pad the lights to a multiple of four.
+	while((rSlice.m_Lights.size() & 3) != 0)
+	{
+		rSlice.m_LightX     .push_back(0.0f);
+		rSlice.m_LightY     .push_back(0.0f);
+		rSlice.m_LightZ     .push_back(g_FarAway);
+		rSlice.m_LightRadius.push_back(0.0f);
+		rSlice.m_Lights     .push_back(-1);
+	}
+
+	int NumberOfLights = static_cast<int>(rSlice.m_Lights.size());
+
+	const float* pLightX      = rSlice.m_LightX.data();
+	const float* pLightY      = rSlice.m_LightY.data();
+	const float* pLightZ      = rSlice.m_LightZ.data();
+	const float* pLightRadius = rSlice.m_LightRadius.data();
+
+	for(int IndexOfTile = 0; IndexOfTile < g_NumberOfClustersX * g_NumberOfClustersY; ++ IndexOfTile)
+	{
+		int IndexOfCluster = _IndexOfSlice * g_NumberOfClustersX * g_NumberOfClustersY + IndexOfTile;
+		int Count          = 0;
+
+		for(int IndexOfLight = 0; IndexOfLight < NumberOfLights; IndexOfLight += 4)
+		{
+			int Mask = 0;
+
+#if defined(CLUSTERED_LIGHTING_USE_SSE2)
+			__m128 Zero = _mm_setzero_ps();
+
+			__m128 X = _mm_loadu_ps(pLightX + IndexOfLight);
+			__m128 Y = _mm_loadu_ps(pLightY + IndexOfLight);
+			__m128 Z = _mm_loadu_ps(pLightZ + IndexOfLight);
+			__m128 R = _mm_loadu_ps(pLightRadius + IndexOfLight);
+
+			__m128 DistanceX = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(m_ClusterMinX[IndexOfCluster]), X), _mm_sub_ps(X, _mm_set1_ps(m_ClusterMaxX[IndexOfCluster]))), Zero);
+			__m128 DistanceY = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(m_ClusterMinY[IndexOfCluster]), Y), _mm_sub_ps(Y, _mm_set1_ps(m_ClusterMaxY[IndexOfCluster]))), Zero);
+			__m128 DistanceZ = _mm_max_ps(_mm_max_ps(_mm_sub_ps(_mm_set1_ps(rSlice.m_MinZ), Z), _mm_sub_ps(Z, _mm_set1_ps(rSlice.m_MaxZ))), Zero);
+
+			__m128 SquaredDistance = _mm_add_ps(_mm_add_ps(_mm_mul_ps(DistanceX, DistanceX), _mm_mul_ps(DistanceY, DistanceY)), _mm_mul_ps(DistanceZ, DistanceZ));
+
+			Mask = _mm_movemask_ps(_mm_cmple_ps(SquaredDistance, _mm_mul_ps(R, R)));
+#else
+			for(int Lane = 0; Lane < 4; ++ Lane)
+			{
+				int   Index     = IndexOfLight + Lane;
+				float DistanceX = std::max(std::max(m_ClusterMinX[IndexOfCluster] - pLightX[Index], pLightX[Index] - m_ClusterMaxX[IndexOfCluster]), 0.0f);
+				float DistanceY = std::max(std::max(m_ClusterMinY[IndexOfCluster] - pLightY[Index], pLightY[Index] - m_ClusterMaxY[IndexOfCluster]), 0.0f);
+				float DistanceZ = std::max(std::max(rSlice.m_MinZ - pLightZ[Index], pLightZ[Index] - rSlice.m_MaxZ), 0.0f);
+
+				if(DistanceX * DistanceX + DistanceY * DistanceY + DistanceZ * DistanceZ <= pLightRadius[Index] * pLightRadius[Index])
+				{
+					Mask |= 1 << Lane;
+				}
+			}
+#endif
+
+			for(int Lane = 0; Mask != 0; ++ Lane, Mask >>= 1)
+			{
+				if((Mask & 1) == 0)
+				{
+					continue;
+				}
+
+				if(Count < m_Settings.m_MaxLightsPerCluster)
+				{
+					rSlice.m_Indices.push_back(rSlice.m_Lights[IndexOfLight + Lane]);
+
+					++ Count;
+				}
+				else
+				{
+					++ rSlice.m_NumberOfDropped;
+				}
+			}
+		}
+
+		m_ClusterCounts[IndexOfCluster] = Count;
+	}
+}
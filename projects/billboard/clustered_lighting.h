@@ -0,0 +1,147 @@
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Clustered lighting for many point lights. The view frustum is split into a
+// grid of clusters: tiles on the screen and slices along the view depth, where
+// the slices get thicker with the distance. Each frame the lights are sorted
+// into the clusters they touch and the pixel shader only loops over the lights
+// of the cluster its pixel lies in.
+//
+// The result is written into three constant buffers which match the 'b1' to
+// 'b3' pixel constant buffers of 'billboard.hlsl':
+//
+//     SLightBuffer       the position, radius and color of every light
+//     SClusterBuffer     the grid parameters and per cluster the offset and the
+//                        number of its entries in the light index list
+//     SLightIndexBuffer  the light indices of all clusters one after the other,
+//                        16 bits each
+// -----------------------------------------------------------------------------
+
+const int g_NumberOfClustersX       = 16;
+const int g_NumberOfClustersY       = 8;
+const int g_NumberOfClustersZ       = 16;
+const int g_NumberOfClusters        = g_NumberOfClustersX * g_NumberOfClustersY * g_NumberOfClustersZ;
+const int g_MaxNumberOfPointLights  = 1024;
+const int g_MaxNumberOfLightIndices = 32768;
+
+struct SPointLight
+{
+	float m_Position[3];                // The world space position.
+	float m_Radius;                     // The distance at which the light has faded out completely.
+	float m_Color[3];                   // The color multiplied with the intensity.
+	float m_Intensity;
+};
+
+// Light buffer for the billboard shader
+struct SLightBuffer
+{
+	float m_PositionRadius[g_MaxNumberOfPointLights][4];
+	float m_Color[g_MaxNumberOfPointLights][4];
+};
+
+// Cluster buffer for the billboard shader
+struct SClusterBuffer
+{
+	float        m_ClusterScale[4];                     // Pixel to tile scale in x and y, log(depth) to slice scale and bias.
+	unsigned int m_NumberOfClusters[4];                 // The number of clusters along x, y and z.
+	unsigned int m_Cells[g_NumberOfClusters];           // The offset into the index list in the low and the number of lights in the high 16 bits.
+};
+
+// Light index buffer for the billboard shader
+struct SLightIndexBuffer
+{
+	unsigned short m_Indices[g_MaxNumberOfLightIndices];
+};
+
+struct SClusteredLightingSettings
+{
+	SClusteredLightingSettings();
+
+	int m_NumberOfThreads;              // The number of threads binning the lights. Zero uses one thread per core.
+	int m_MaxLightsPerCluster;          // Lights exceeding this number in a cluster are dropped to bound the shader cost.
+};
+
+struct SClusteredLightingStatistics
+{
+	int    m_NumberOfLights;            // Lights passed to the last update.
+	int    m_NumberOfVisibleLights;     // Lights inside of the depth range of the view.
+	int    m_NumberOfLightIndices;      // Entries written into the light index list.
+	int    m_MaxLightsInCluster;        // The largest number of lights in a single cluster.
+	int    m_NumberOfDroppedIndices;    // Entries which did not fit into a cluster or the index list.
+	double m_BinningTime;               // The time of the last update in milliseconds.
+};
+
+class CClusteredLighting
+{
+public:
+
+	CClusteredLighting();
+
+public:
+
+	void Create(const SClusteredLightingSettings& _rSettings);
+
+	// -----------------------------------------------------------------------------
+	// Sorts the lights into the clusters of the view. The matrices are the ones
+	// passed to the shaders, the size is the size of the render target in pixels.
+	// Only the first 'g_MaxNumberOfPointLights' lights are used.
+	// -----------------------------------------------------------------------------
+	void Update(const float* _pViewMatrix, const float* _pProjectionMatrix, int _Width, int _Height, const SPointLight* _pLights, int _NumberOfLights);
+
+	SLightBuffer*      GetLightBuffer();
+	SClusterBuffer*    GetClusterBuffer();
+	SLightIndexBuffer* GetLightIndexBuffer();
+
+	const SClusteredLightingStatistics& GetStatistics() const;
+
+private:
+
+	struct SSlice
+	{
+		float              m_MinZ;
+		float              m_MaxZ;
+		std::vector<float> m_LightX;    // The view space lights touching the slice, padded to a multiple of four.
+		std::vector<float> m_LightY;
+		std::vector<float> m_LightZ;
+		std::vector<float> m_LightRadius;
+		std::vector<int>   m_Lights;    // The index of each of these lights in the light buffer.
+		std::vector<int>   m_Indices;   // The light indices of the clusters of the slice one after the other.
+		int                m_NumberOfDropped;
+	};
+
+private:
+
+	void BuildClusterBounds(const float* _pProjectionMatrix);
+	void BinSlice(int _IndexOfSlice);
+
+private:
+
+	SClusteredLightingSettings m_Settings;
+
+	float m_ProjectionMatrix[16];       // The projection the cluster bounds were built for.
+
+	// The view space bounds of each cluster.
+	std::vector<float> m_ClusterMinX;
+	std::vector<float> m_ClusterMaxX;
+	std::vector<float> m_ClusterMinY;
+	std::vector<float> m_ClusterMaxY;
+
+	// The view space lights.
+	std::vector<float> m_LightX;
+	std::vector<float> m_LightY;
+	std::vector<float> m_LightZ;
+	std::vector<float> m_LightRadius;
+
+	std::vector<SSlice> m_Slices;
+	std::vector<int>    m_ClusterCounts;        // The number of lights of each cluster, written by the slices.
+
+	std::unique_ptr<SLightBuffer>      m_pLightBuffer;
+	std::unique_ptr<SClusterBuffer>    m_pClusterBuffer;
+	std::unique_ptr<SLightIndexBuffer> m_pLightIndexBuffer;
+
+	SClusteredLightingStatistics m_Statistics;
+};
@@ -0,0 +1,678 @@
+
+#include "dds_file.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	const uint32_t g_DDSMagic          = 0x20534444;     // 'DDS '
+	const uint32_t g_DDSHeaderSize     = 124;
+	const uint32_t g_DDPFAlphaPixels   = 0x1;
+	const uint32_t g_DDPFFourCC        = 0x4;
+	const uint32_t g_DDSDMipMapCount   = 0x20000;
+	const uint32_t g_DDSDRequired      = 0x1007;         // DDSD_CAPS | DDSD_HEIGHT | DDSD_WIDTH | DDSD_PIXELFORMAT
+	const uint32_t g_DDSDPitch         = 0x8;
+	const uint32_t g_DDSDLinearSize    = 0x80000;
+	const uint32_t g_DDPFRGB           = 0x40;
+	const uint32_t g_DDSCapsTexture    = 0x1000;
+	const uint32_t g_DDSCapsComplex    = 0x8;
+	const uint32_t g_DDSCapsMipMap     = 0x400000;
+	const uint32_t g_DDPFSize          = 32;
+
+	const uint32_t g_FourCCDXT1        = 0x31545844;     // 'DXT1'
+	const uint32_t g_FourCCDXT3        = 0x33545844;     // 'DXT3'
+	const uint32_t g_FourCCDXT5        = 0x35545844;     // 'DXT5'
+
+	// -----------------------------------------------------------------------------
+	// Extracts a channel described by a bit mask and scales it to 8 bits.
+	// -----------------------------------------------------------------------------
+	unsigned char GetMaskedChannel(uint32_t _Pixel, uint32_t _Mask)
+	{
+		if(_Mask == 0)
+		{
+			return 0;
+		}
+
+		int Shift = 0;
+
+		while(((_Mask >> Shift) & 1) == 0)
+		{
+			++ Shift;
+		}
+
+		uint32_t Maximum = _Mask >> Shift;
+		uint32_t Value   = (_Pixel & _Mask) >> Shift;
+
+		return static_cast<unsigned char>(Value * 255 / Maximum);
+	}
+
+	void DecodeColor565(uint16_t _Color, unsigned char* _pRGBA)
+	{
+		_pRGBA[0] = static_cast<unsigned char>(((_Color >> 11) & 0x1F) * 255 / 31);
+		_pRGBA[1] = static_cast<unsigned char>(((_Color >>  5) & 0x3F) * 255 / 63);
+		_pRGBA[2] = static_cast<unsigned char>(((_Color >>  0) & 0x1F) * 255 / 31);
+		_pRGBA[3] = 255;
+	}
+
+	// -----------------------------------------------------------------------------
+	// The four colors a DXT block interpolates from its two end points.
+	// -----------------------------------------------------------------------------
+	void GetColorPalette(uint16_t _Color0, uint16_t _Color1, bool _IsDXT1, unsigned char _pPalette[4][4])
+	{
+		DecodeColor565(_Color0, _pPalette[0]);
+		DecodeColor565(_Color1, _pPalette[1]);
+
+		for(int Channel = 0; Channel < 3; ++ Channel)
+		{
+			if(!_IsDXT1 || _Color0 > _Color1)
+			{
+				_pPalette[2][Channel] = static_cast<unsigned char>((2 * _pPalette[0][Channel] + _pPalette[1][Channel]) / 3);
+				_pPalette[3][Channel] = static_cast<unsigned char>((_pPalette[0][Channel] + 2 * _pPalette[1][Channel]) / 3);
+			}
+			else
+			{
+				_pPalette[2][Channel] = static_cast<unsigned char>((_pPalette[0][Channel] + _pPalette[1][Channel]) / 2);
+				_pPalette[3][Channel] = 0;
+			}
+		}
+
+		_pPalette[2][3] = 255;
+		_pPalette[3][3] = (_IsDXT1 && _Color0 <= _Color1) ? 0 : 255;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Decodes the 8 byte color part of a DXT block into 16 RGBA pixels.
+	// -----------------------------------------------------------------------------
+	void DecodeColorBlock(const unsigned char* _pBlock, bool _IsDXT1, unsigned char _pPixels[16][4])
+	{
+		unsigned char Palette[4][4];
+		uint16_t      Color0;
+		uint16_t      Color1;
+		uint32_t      Selectors;
+
+		memcpy(&Color0,    _pBlock + 0, 2);
+		memcpy(&Color1,    _pBlock + 2, 2);
+		memcpy(&Selectors, _pBlock + 4, 4);
+
+		GetColorPalette(Color0, Color1, _IsDXT1, Palette);
+
+		for(int IndexOfPixel = 0; IndexOfPixel < 16; ++ IndexOfPixel)
+		{
+			memcpy(_pPixels[IndexOfPixel], Palette[(Selectors >> (IndexOfPixel * 2)) & 3], 4);
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// The eight alpha values a DXT5 block interpolates from its two end points.
+	// -----------------------------------------------------------------------------
+	void GetAlphaPalette(unsigned char _Alpha0, unsigned char _Alpha1, unsigned char _pPalette[8])
+	{
+		_pPalette[0] = _Alpha0;
+		_pPalette[1] = _Alpha1;
+
+		for(int IndexOfEntry = 2; IndexOfEntry < 8; ++ IndexOfEntry)
+		{
+			if(_Alpha0 > _Alpha1)
+			{
+				_pPalette[IndexOfEntry] = static_cast<unsigned char>(((8 - IndexOfEntry) * _Alpha0 + (IndexOfEntry - 1) * _Alpha1) / 7);
+			}
+			else if(IndexOfEntry < 6)
+			{
+				_pPalette[IndexOfEntry] = static_cast<unsigned char>(((6 - IndexOfEntry) * _Alpha0 + (IndexOfEntry - 1) * _Alpha1) / 5);
+			}
+			else
+			{
+				_pPalette[IndexOfEntry] = IndexOfEntry == 6 ? 0 : 255;
+			}
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// Decodes the 8 byte interpolated alpha part of a DXT5 block.
+	// -----------------------------------------------------------------------------
+	void DecodeAlphaBlockDXT5(const unsigned char* _pBlock, unsigned char _pPixels[16][4])
+	{
+		unsigned char Palette[8];
+		uint64_t      Selectors = 0;
+
+		GetAlphaPalette(_pBlock[0], _pBlock[1], Palette);
+
+		memcpy(&Selectors, _pBlock + 2, 6);
+
+		for(int IndexOfPixel = 0; IndexOfPixel < 16; ++ IndexOfPixel)
+		{
+			_pPixels[IndexOfPixel][3] = Palette[(Selectors >> (IndexOfPixel * 3)) & 7];
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// Scales an 8 bit channel to the bits of the mask, the reverse of
+	// 'GetMaskedChannel'.
+	// -----------------------------------------------------------------------------
+	uint32_t SetMaskedChannel(unsigned char _Value, uint32_t _Mask)
+	{
+		if(_Mask == 0)
+		{
+			return 0;
+		}
+
+		int Shift = 0;
+
+		while(((_Mask >> Shift) & 1) == 0)
+		{
+			++ Shift;
+		}
+
+		uint32_t Maximum = _Mask >> Shift;
+
+		return ((_Value * Maximum + 127) / 255) << Shift;
+	}
+
+	uint16_t EncodeColor565(const unsigned char* _pRGBA)
+	{
+		return static_cast<uint16_t>(((_pRGBA[0] * 31 + 127) / 255) << 11 | ((_pRGBA[1] * 63 + 127) / 255) << 5 | ((_pRGBA[2] * 31 + 127) / 255));
+	}
+
+	// -----------------------------------------------------------------------------
+	// Encodes 16 RGBA pixels into the 8 byte color part of a DXT block. The end
+	// points are the corners of the bounding box of the colors, each pixel takes
+	// the nearest entry of the palette the decoder derives from them. DXT1 blocks
+	// with transparent pixels use the three color mode, whose fourth entry is
+	// transparent black.
+	// -----------------------------------------------------------------------------
+	void EncodeColorBlock(const unsigned char _pPixels[16][4], bool _IsDXT1, unsigned char* _pBlock)
+	{
+		unsigned char Minimum[4] = { 255, 255, 255, 255 };
+		unsigned char Maximum[4] = {   0,   0,   0, 255 };
+		bool          HasHoles   = false;
+
+		for(int IndexOfPixel = 0; IndexOfPixel < 16; ++ IndexOfPixel)
+		{
+			if(_IsDXT1 && _pPixels[IndexOfPixel][3] < 128)
+			{
+				HasHoles = true;
+
+				continue;
+			}
+
+			for(int Channel = 0; Channel < 3; ++ Channel)
+			{
+				Minimum[Channel] = std::min(Minimum[Channel], _pPixels[IndexOfPixel][Channel]);
+				Maximum[Channel] = std::max(Maximum[Channel], _pPixels[IndexOfPixel][Channel]);
+			}
+		}
+
+		uint16_t Color0 = EncodeColor565(Maximum);
+		uint16_t Color1 = EncodeColor565(Minimum);
+
+		// The four color mode needs the larger end point first, the three color mode the smaller one.
+		if(HasHoles ? Color0 > Color1 : Color0 < Color1)
+		{
+			std::swap(Color0, Color1);
+		}
+
+		unsigned char Palette[4][4];
+
+		GetColorPalette(Color0, Color1, _IsDXT1, Palette);
+
+		int      NumberOfColors = !_IsDXT1 || Color0 > Color1 ? 4 : 3;
+		uint32_t Selectors      = 0;
+
+		for(int IndexOfPixel = 0; IndexOfPixel < 16; ++ IndexOfPixel)
+		{
+			uint32_t Selector     = 3;
+			int      BestDistance = 0x7FFFFFFF;
+
+			for(int IndexOfColor = 0; IndexOfColor < NumberOfColors && !(HasHoles && _pPixels[IndexOfPixel][3] < 128); ++ IndexOfColor)
+			{
+				int Distance = 0;
+
+				for(int Channel = 0; Channel < 3; ++ Channel)
+				{
+					int Delta = _pPixels[IndexOfPixel][Channel] - Palette[IndexOfColor][Channel];
+
+					Distance += Delta * Delta;
+				}
+
+				if(Distance < BestDistance)
+				{
+					BestDistance = Distance;
+					Selector     = static_cast<uint32_t>(IndexOfColor);
+				}
+			}
+
+			Selectors |= Selector << (IndexOfPixel * 2);
+		}
+
+		memcpy(_pBlock + 0, &Color0,    2);
+		memcpy(_pBlock + 2, &Color1,    2);
+		memcpy(_pBlock + 4, &Selectors, 4);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Encodes the alpha of 16 pixels into the 8 byte interpolated alpha part of a
+	// DXT5 block, with the smallest and the largest alpha as end points.
+	// -----------------------------------------------------------------------------
+	void EncodeAlphaBlockDXT5(const unsigned char _pPixels[16][4], unsigned char* _pBlock)
+	{
+		unsigned char Minimum = 255;
+		unsigned char Maximum = 0;
+
+		for(int IndexOfPixel = 0; IndexOfPixel < 16; ++ IndexOfPixel)
+		{
+			Minimum = std::min(Minimum, _pPixels[IndexOfPixel][3]);
+			Maximum = std::max(Maximum, _pPixels[IndexOfPixel][3]);
+		}
+
+		unsigned char Palette[8];
+		uint64_t      Selectors = 0;
+
+		GetAlphaPalette(Maximum, Minimum, Palette);
+
+		for(int IndexOfPixel = 0; IndexOfPixel < 16; ++ IndexOfPixel)
+		{
+			uint64_t Selector     = 0;
+			int      BestDistance = 256;
+
+			for(int IndexOfEntry = 0; IndexOfEntry < 8; ++ IndexOfEntry)
+			{
+				int Distance = abs(_pPixels[IndexOfPixel][3] - Palette[IndexOfEntry]);
+
+				if(Distance < BestDistance)
+				{
+					BestDistance = Distance;
+					Selector     = static_cast<uint64_t>(IndexOfEntry);
+				}
+			}
+
+			Selectors |= Selector << (IndexOfPixel * 3);
+		}
+
+		_pBlock[0] = Maximum;
+		_pBlock[1] = Minimum;
+
+		memcpy(_pBlock + 2, &Selectors, 6);
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+bool ReadDDSInfo(const char* _pPath, SDDSInfo& _rInfo)
+{
+	std::ifstream Stream(_pPath, std::ios::binary);
+	uint32_t      Header[32];
+
+	if(!Stream.read(reinterpret_cast<char*>(Header), sizeof(Header)) || Header[0] != g_DDSMagic || Header[1] != g_DDSHeaderSize)
+	{
+		std::cout << "Could not read DDS file " << _pPath << std::endl;
+
+		return false;
+	}
+
+	// -----------------------------------------------------------------------------
+	// The header follows the magic number. The pixel format starts at the 19th
+	// word of the header, see DDS_HEADER and DDS_PIXELFORMAT.
+	// -----------------------------------------------------------------------------
+	uint32_t Flags          = Header[2];
+	uint32_t PixelFlags     = Header[20];
+	uint32_t NumberOfLevels = (Flags & g_DDSDMipMapCount) != 0 && Header[7] > 0 ? Header[7] : 1;
+
+	_rInfo.m_Height       = static_cast<int>(Header[3]);
+	_rInfo.m_Width        = static_cast<int>(Header[4]);
+	_rInfo.m_FourCC       = (PixelFlags & g_DDPFFourCC) != 0 ? Header[21] : 0;
+	_rInfo.m_BitsPerPixel = _rInfo.m_FourCC != 0 ? 0 : static_cast<int>(Header[22]);
+	_rInfo.m_Masks[0]     = Header[23];
+	_rInfo.m_Masks[1]     = Header[24];
+	_rInfo.m_Masks[2]     = Header[25];
+	_rInfo.m_Masks[3]     = (PixelFlags & g_DDPFAlphaPixels) != 0 ? Header[26] : 0;
+	_rInfo.m_HasAlpha     = _rInfo.m_Masks[3] != 0 || _rInfo.m_FourCC == g_FourCCDXT3 || _rInfo.m_FourCC == g_FourCCDXT5 || _rInfo.m_FourCC == g_FourCCDXT1;
+
+	if(_rInfo.m_FourCC != 0 && _rInfo.m_FourCC != g_FourCCDXT1 && _rInfo.m_FourCC != g_FourCCDXT3 && _rInfo.m_FourCC != g_FourCCDXT5)
+	{
+		std::cout << "Unsupported DDS format in " << _pPath << std::endl;
+
+		return false;
+	}
+
+	if(_rInfo.m_FourCC == 0 && (_rInfo.m_BitsPerPixel < 8 || _rInfo.m_BitsPerPixel > 32 || _rInfo.m_BitsPerPixel % 8 != 0))
+	{
+		std::cout << "Unsupported DDS pixel size in " << _pPath << std::endl;
+
+		return false;
+	}
+
+	_rInfo.m_Levels.clear();
+
+	size_t Offset = 4 + g_DDSHeaderSize;
+	int    Width  = _rInfo.m_Width;
+	int    Height = _rInfo.m_Height;
+
+	for(uint32_t IndexOfLevel = 0; IndexOfLevel < NumberOfLevels; ++ IndexOfLevel)
+	{
+		SDDSLevel Level;
+
+		Level.m_Width  = Width;
+		Level.m_Height = Height;
+		Level.m_Offset = Offset;
+		Level.m_Size   = GetDDSLevelSize(_rInfo, Width, Height);
+
+		_rInfo.m_Levels.push_back(Level);
+
+		Offset += Level.m_Size;
+		Width   = std::max(Width  / 2, 1);
+		Height  = std::max(Height / 2, 1);
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+size_t GetDDSLevelSize(const SDDSInfo& _rInfo, int _Width, int _Height)
+{
+	if(_rInfo.m_FourCC != 0)
+	{
+		size_t BlockSize = _rInfo.m_FourCC == g_FourCCDXT1 ? 8 : 16;
+
+		return static_cast<size_t>((_Width + 3) / 4) * static_cast<size_t>((_Height + 3) / 4) * BlockSize;
+	}
+
+	return static_cast<size_t>(_Width) * static_cast<size_t>(_Height) * (_rInfo.m_BitsPerPixel / 8);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t GetDDSFileSize(const SDDSInfo& _rInfo, int _Width, int _Height, int _NumberOfLevels)
+{
+	size_t Size = 4 + g_DDSHeaderSize;
+
+	for(int IndexOfLevel = 0; IndexOfLevel < _NumberOfLevels; ++ IndexOfLevel)
+	{
+		Size += GetDDSLevelSize(_rInfo, std::max(_Width >> IndexOfLevel, 1), std::max(_Height >> IndexOfLevel, 1));
+	}
+
+	return Size;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ReadDDSLevelData(const char* _pPath, const SDDSInfo& _rInfo, int _IndexOfLevel, std::vector<unsigned char>& _rData)
+{
+	if(_IndexOfLevel < 0 || _IndexOfLevel >= static_cast<int>(_rInfo.m_Levels.size()))
+	{
+		return false;
+	}
+
+	const SDDSLevel& rLevel = _rInfo.m_Levels[_IndexOfLevel];
+
+	std::ifstream Stream(_pPath, std::ios::binary);
+
+	_rData.resize(rLevel.m_Size);
+
+	Stream.seekg(static_cast<std::streamoff>(rLevel.m_Offset));
+
+	if(!Stream.read(reinterpret_cast<char*>(_rData.data()), static_cast<std::streamsize>(_rData.size())))
+	{
+		std::cout << "DDS file " << _pPath << " is truncated" << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ReadDDSLevel(const char* _pPath, const SDDSInfo& _rInfo, int _IndexOfLevel, std::vector<unsigned char>& _rPixels)
+{
+	std::vector<unsigned char> Data;
+
+	if(!ReadDDSLevelData(_pPath, _rInfo, _IndexOfLevel, Data))
+	{
+		return false;
+	}
+
+	const SDDSLevel& rLevel = _rInfo.m_Levels[_IndexOfLevel];
+
+	_rPixels.resize(static_cast<size_t>(rLevel.m_Width) * rLevel.m_Height * 4);
+
+	if(_rInfo.m_FourCC == 0)
+	{
+		int BytesPerPixel = _rInfo.m_BitsPerPixel / 8;
+
+		for(size_t IndexOfPixel = 0; IndexOfPixel < static_cast<size_t>(rLevel.m_Width) * rLevel.m_Height; ++ IndexOfPixel)
+		{
+			uint32_t Pixel = 0;
+
+			memcpy(&Pixel, &Data[IndexOfPixel * BytesPerPixel], BytesPerPixel);
+
+			_rPixels[IndexOfPixel * 4 + 0] = GetMaskedChannel(Pixel, _rInfo.m_Masks[0]);
+			_rPixels[IndexOfPixel * 4 + 1] = GetMaskedChannel(Pixel, _rInfo.m_Masks[1]);
+			_rPixels[IndexOfPixel * 4 + 2] = GetMaskedChannel(Pixel, _rInfo.m_Masks[2]);
+			_rPixels[IndexOfPixel * 4 + 3] = _rInfo.m_Masks[3] != 0 ? GetMaskedChannel(Pixel, _rInfo.m_Masks[3]) : 255;
+		}
+
+		return true;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Block compressed formats store 4x4 pixel blocks row by row.
+	// -----------------------------------------------------------------------------
+	size_t BlockSize        = _rInfo.m_FourCC == g_FourCCDXT1 ? 8 : 16;
+	int    NumberOfBlocksX  = (rLevel.m_Width  + 3) / 4;
+	int    NumberOfBlocksY  = (rLevel.m_Height + 3) / 4;
+
+	for(int BlockY = 0; BlockY < NumberOfBlocksY; ++ BlockY)
+	{
+		for(int BlockX = 0; BlockX < NumberOfBlocksX; ++ BlockX)
+		{
+			const unsigned char* pBlock = &Data[(static_cast<size_t>(BlockY) * NumberOfBlocksX + BlockX) * BlockSize];
+			unsigned char        Pixels[16][4];
+
+			DecodeColorBlock(pBlock + BlockSize - 8, _rInfo.m_FourCC == g_FourCCDXT1, Pixels);
+
+			if(_rInfo.m_FourCC == g_FourCCDXT3)
+			{
+				for(int IndexOfPixel = 0; IndexOfPixel < 16; ++ IndexOfPixel)
+				{
+					Pixels[IndexOfPixel][3] = static_cast<unsigned char>(((pBlock[IndexOfPixel / 2] >> ((IndexOfPixel % 2) * 4)) & 0xF) * 17);
+				}
+			}
+			else if(_rInfo.m_FourCC == g_FourCCDXT5)
+			{
+				DecodeAlphaBlockDXT5(pBlock, Pixels);
+			}
+
+			for(int IndexOfPixel = 0; IndexOfPixel < 16; ++ IndexOfPixel)
+			{
+				int X = BlockX * 4 + IndexOfPixel % 4;
+				int Y = BlockY * 4 + IndexOfPixel / 4;
+
+				if(X < rLevel.m_Width && Y < rLevel.m_Height)
+				{
+					memcpy(&_rPixels[(static_cast<size_t>(Y) * rLevel.m_Width + X) * 4], Pixels[IndexOfPixel], 4);
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool WriteDDS(const char* _pPath, int _Width, int _Height, const std::vector<std::vector<unsigned char>>& _rLevels)
+{
+	SDDSInfo Format;
+
+	Format.m_Width        = _Width;
+	Format.m_Height       = _Height;
+	Format.m_BitsPerPixel = 32;
+	Format.m_FourCC       = 0;
+	Format.m_Masks[0]     = 0x00FF0000;
+	Format.m_Masks[1]     = 0x0000FF00;
+	Format.m_Masks[2]     = 0x000000FF;
+	Format.m_Masks[3]     = 0xFF000000;
+	Format.m_HasAlpha     = true;
+
+	std::vector<std::vector<unsigned char>> Levels(_rLevels.size());
+
+	int Width  = _Width;
+	int Height = _Height;
+
+	for(size_t IndexOfLevel = 0; IndexOfLevel < _rLevels.size(); ++ IndexOfLevel)
+	{
+		if(_rLevels[IndexOfLevel].size() != static_cast<size_t>(Width) * Height * 4)
+		{
+			std::cout << "Level of " << Width << " x " << Height << " has the wrong size for " << _pPath << std::endl;
+
+			return false;
+		}
+
+		EncodeDDSLevel(Format, Width, Height, _rLevels[IndexOfLevel], Levels[IndexOfLevel]);
+
+		Width  = std::max(Width  / 2, 1);
+		Height = std::max(Height / 2, 1);
+	}
+
+	return WriteDDSLevels(_pPath, Format, _Width, _Height, Levels);
+}
+
+// -----------------------------------------------------------------------------
+
+void EncodeDDSLevel(const SDDSInfo& _rInfo, int _Width, int _Height, const std::vector<unsigned char>& _rPixels, std::vector<unsigned char>& _rData)
+{
+	_rData.resize(GetDDSLevelSize(_rInfo, _Width, _Height));
+
+	if(_rInfo.m_FourCC == 0)
+	{
+		int BytesPerPixel = _rInfo.m_BitsPerPixel / 8;
+
+		for(size_t IndexOfPixel = 0; IndexOfPixel < static_cast<size_t>(_Width) * _Height; ++ IndexOfPixel)
+		{
+			const unsigned char* pPixel = &_rPixels[IndexOfPixel * 4];
+
+			uint32_t Pixel = SetMaskedChannel(pPixel[0], _rInfo.m_Masks[0])
+			               | SetMaskedChannel(pPixel[1], _rInfo.m_Masks[1])
+			               | SetMaskedChannel(pPixel[2], _rInfo.m_Masks[2])
+			               | SetMaskedChannel(pPixel[3], _rInfo.m_Masks[3]);
+
+			memcpy(&_rData[IndexOfPixel * BytesPerPixel], &Pixel, BytesPerPixel);
+		}
+
+		return;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Blocks reaching over the border of small levels repeat the last row and
+	// column.
+	// -----------------------------------------------------------------------------
+	size_t BlockSize       = _rInfo.m_FourCC == g_FourCCDXT1 ? 8 : 16;
+	int    NumberOfBlocksX = (_Width  + 3) / 4;
+	int    NumberOfBlocksY = (_Height + 3) / 4;
+
+	for(int BlockY = 0; BlockY < NumberOfBlocksY; ++ BlockY)
+	{
+		for(int BlockX = 0; BlockX < NumberOfBlocksX; ++ BlockX)
+		{
+			unsigned char* pBlock = &_rData[(static_cast<size_t>(BlockY) * NumberOfBlocksX + BlockX) * BlockSize];
+			unsigned char  Pixels[16][4];
+
+			for(int IndexOfPixel = 0; IndexOfPixel < 16; ++ IndexOfPixel)
+			{
+				int X = std::min(BlockX * 4 + IndexOfPixel % 4, _Width  - 1);
+				int Y = std::min(BlockY * 4 + IndexOfPixel / 4, _Height - 1);
+
+				memcpy(Pixels[IndexOfPixel], &_rPixels[(static_cast<size_t>(Y) * _Width + X) * 4], 4);
+			}
+
+			if(_rInfo.m_FourCC == g_FourCCDXT3)
+			{
+				memset(pBlock, 0, 8);
+
+				for(int IndexOfPixel = 0; IndexOfPixel < 16; ++ IndexOfPixel)
+				{
+					pBlock[IndexOfPixel / 2] |= static_cast<unsigned char>(((Pixels[IndexOfPixel][3] + 8) / 17) << ((IndexOfPixel % 2) * 4));
+				}
+			}
+			else if(_rInfo.m_FourCC == g_FourCCDXT5)
+			{
+				EncodeAlphaBlockDXT5(Pixels, pBlock);
+			}
+
+			EncodeColorBlock(Pixels, _rInfo.m_FourCC == g_FourCCDXT1, pBlock + BlockSize - 8);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+bool WriteDDSLevels(const char* _pPath, const SDDSInfo& _rFormat, int _Width, int _Height, const std::vector<std::vector<unsigned char>>& _rLevels)
+{
+	if(_rLevels.empty())
+	{
+		return false;
+	}
+
+	uint32_t Header[32];
+
+	memset(Header, 0, sizeof(Header));
+
+	// -----------------------------------------------------------------------------
+	// See DDS_HEADER and DDS_PIXELFORMAT, the words are counted from the magic.
+	// Block compressed formats give the size of the top level instead of a pitch.
+	// -----------------------------------------------------------------------------
+	bool IsCompressed = _rFormat.m_FourCC != 0;
+
+	Header[ 0] = g_DDSMagic;
+	Header[ 1] = g_DDSHeaderSize;
+	Header[ 2] = g_DDSDRequired | (IsCompressed ? g_DDSDLinearSize : g_DDSDPitch) | (_rLevels.size() > 1 ? g_DDSDMipMapCount : 0);
+	Header[ 3] = static_cast<uint32_t>(_Height);
+	Header[ 4] = static_cast<uint32_t>(_Width);
+	Header[ 5] = static_cast<uint32_t>(IsCompressed ? GetDDSLevelSize(_rFormat, _Width, _Height) : static_cast<size_t>(_Width) * (_rFormat.m_BitsPerPixel / 8));
+	Header[ 7] = static_cast<uint32_t>(_rLevels.size());
+	Header[19] = g_DDPFSize;
+	Header[20] = IsCompressed ? g_DDPFFourCC : g_DDPFRGB | (_rFormat.m_Masks[3] != 0 ? g_DDPFAlphaPixels : 0);
+	Header[21] = _rFormat.m_FourCC;
+	Header[22] = IsCompressed ? 0 : static_cast<uint32_t>(_rFormat.m_BitsPerPixel);
+	Header[23] = IsCompressed ? 0 : _rFormat.m_Masks[0];
+	Header[24] = IsCompressed ? 0 : _rFormat.m_Masks[1];
+	Header[25] = IsCompressed ? 0 : _rFormat.m_Masks[2];
+	Header[26] = IsCompressed ? 0 : _rFormat.m_Masks[3];
+	Header[27] = g_DDSCapsTexture | (_rLevels.size() > 1 ? g_DDSCapsComplex | g_DDSCapsMipMap : 0);
+
+	std::ofstream Stream(_pPath, std::ios::binary);
+
+	Stream.write(reinterpret_cast<const char*>(Header), sizeof(Header));
+
+	int Width  = _Width;
+	int Height = _Height;
+
+	for(const std::vector<unsigned char>& rLevel : _rLevels)
+	{
+		if(rLevel.size() != GetDDSLevelSize(_rFormat, Width, Height))
+		{
+			std::cout << "Level of " << Width << " x " << Height << " has the wrong size for " << _pPath << std::endl;
+
+			return false;
+		}
+
+		Stream.write(reinterpret_cast<const char*>(rLevel.data()), static_cast<std::streamsize>(rLevel.size()));
+
+		Width  = std::max(Width  / 2, 1);
+		Height = std::max(Height / 2, 1);
+	}
+
+	if(!Stream)
+	{
+		std::cout << "Could not write DDS file " << _pPath << std::endl;
+
+		return false;
+	}
+
+	return true;
+}
@@ -0,0 +1,73 @@
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Reads DirectDraw Surface files on the CPU. YoshiX loads textures for the GPU
+// itself, this is used where we need to look at the texels, e.g. to analyze
+// the alpha channel of a billboard texture.
+//
+// Supported are uncompressed formats described by bit masks (8 to 32 bits per
+// pixel) and the block compressed formats DXT1, DXT3 and DXT5. Levels can also
+// be read, encoded and written in the format of a file, so a mip chain derived
+// from a file keeps its compression.
+// -----------------------------------------------------------------------------
+
+struct SDDSLevel
+{
+	int    m_Width;                 // The width of the mip level in pixels.
+	int    m_Height;                // The height of the mip level in pixels.
+	size_t m_Offset;                // The offset of the level data from the start of the file.
+	size_t m_Size;                  // The size of the level data in bytes.
+};
+
+struct SDDSInfo
+{
+	int          m_Width;           // The width of the top level in pixels.
+	int          m_Height;          // The height of the top level in pixels.
+	int          m_BitsPerPixel;    // The bits per pixel of uncompressed formats, 0 for block compressed formats.
+	unsigned int m_FourCC;          // The four character code of block compressed formats, 0 for uncompressed formats.
+	unsigned int m_Masks[4];        // The red, green, blue, and alpha bit masks of uncompressed formats.
+	bool         m_HasAlpha;        // True if the format stores an alpha channel.
+
+	std::vector<SDDSLevel> m_Levels;    // All mip levels stored in the file, largest first.
+};
+
+bool ReadDDSInfo(const char* _pPath, SDDSInfo& _rInfo);
+
+// Returns the size in bytes of a level with the given size in the format of the file.
+size_t GetDDSLevelSize(const SDDSInfo& _rInfo, int _Width, int _Height);
+
+// Returns the size of a file 'WriteDDSLevels' writes for a mip chain in the format of the file.
+size_t GetDDSFileSize(const SDDSInfo& _rInfo, int _Width, int _Height, int _NumberOfLevels);
+
+// Reads one mip level as it is stored in the file, e.g. still block compressed.
+bool ReadDDSLevelData(const char* _pPath, const SDDSInfo& _rInfo, int _IndexOfLevel, std::vector<unsigned char>& _rData);
+
+// -----------------------------------------------------------------------------
+// Decodes one mip level into 8 bit RGBA, four bytes per pixel, rows from top to
+// bottom. Formats without alpha get an alpha of 255.
+// -----------------------------------------------------------------------------
+bool ReadDDSLevel(const char* _pPath, const SDDSInfo& _rInfo, int _IndexOfLevel, std::vector<unsigned char>& _rPixels);
+
+// -----------------------------------------------------------------------------
+// Writes a mip chain of 8 bit RGBA levels, four bytes per pixel, as A8R8G8B8.
+// Each level has half the size of the previous one, the first level has the
+// given size.
+// -----------------------------------------------------------------------------
+bool WriteDDS(const char* _pPath, int _Width, int _Height, const std::vector<std::vector<unsigned char>>& _rLevels);
+
+// -----------------------------------------------------------------------------
+// Encodes a level of 8 bit RGBA pixels into the format of the file, the reverse
+// of 'ReadDDSLevel'. Block compressed formats pick the end points of each block
+// from the bounding box of its colors.
+// -----------------------------------------------------------------------------
+void EncodeDDSLevel(const SDDSInfo& _rInfo, int _Width, int _Height, const std::vector<unsigned char>& _rPixels, std::vector<unsigned char>& _rData);
+
+// -----------------------------------------------------------------------------
+// Writes a mip chain of levels which are already in the format of the given
+// file, e.g. read with 'ReadDDSLevelData' or encoded with 'EncodeDDSLevel'.
+// -----------------------------------------------------------------------------
+bool WriteDDSLevels(const char* _pPath, const SDDSInfo& _rFormat, int _Width, int _Height, const std::vector<std::vector<unsigned char>>& _rLevels);
@@ -0,0 +1,193 @@
+
+#include "frame_memory.h"
+
+#include <stdint.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+// -----------------------------------------------------------------------------
+
+CFrameArena::CFrameArena()
+	: m_Offset(0)
+{
+	memset(&m_Statistics, 0, sizeof(m_Statistics));
+}
+
+// -----------------------------------------------------------------------------
+
+void CFrameArena::Create(size_t _Capacity)
+{
+	m_Memory.assign(_Capacity, 0);
+
+	m_Offset = 0;
+
+	memset(&m_Statistics, 0, sizeof(m_Statistics));
+
+	m_Statistics.m_Capacity = _Capacity;
+}
+
+// -----------------------------------------------------------------------------
+
+void CFrameArena::Reset()
+{
+	if(m_Statistics.m_NumberOfOverflows > 0)
+	{
+		std::cout << "Frame arena overflow: " << m_Statistics.m_NumberOfOverflows << " allocations did not fit into " << m_Statistics.m_Capacity << " bytes" << std::endl;
+
+		++ m_Statistics.m_NumberOfOverflowFrames;
+	}
+
+	m_Offset = 0;
+
+	m_Statistics.m_NumberOfUsedBytes   = 0;
+	m_Statistics.m_NumberOfAllocations = 0;
+	m_Statistics.m_NumberOfOverflows   = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+void* CFrameArena::Allocate(size_t _NumberOfBytes, size_t _Alignment)
+{
+	++ m_Statistics.m_NumberOfAllocations;
+
+	// Align the address and not only the offset, the vector itself is not aligned.
+	uintptr_t Base    = reinterpret_cast<uintptr_t>(m_Memory.data());
+	uintptr_t Aligned = (Base + m_Offset + _Alignment - 1) & ~static_cast<uintptr_t>(_Alignment - 1);
+	size_t    Offset  = static_cast<size_t>(Aligned - Base);
+
+	if(Offset + _NumberOfBytes > m_Memory.size())
+	{
+		++ m_Statistics.m_NumberOfOverflows;
+
+		return nullptr;
+	}
+
+	m_Offset = Offset + _NumberOfBytes;
+
+	m_Statistics.m_NumberOfUsedBytes = m_Offset;
+	m_Statistics.m_HighWaterMark     = std::max(m_Statistics.m_HighWaterMark, m_Offset);
+
+	return m_Memory.data() + Offset;
+}
+
+// -----------------------------------------------------------------------------
+
+const SFrameMemoryStatistics& CFrameArena::GetStatistics() const
+{
+	return m_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+const int CUploadRing::s_RegisterSize;
+
+// -----------------------------------------------------------------------------
+
+CUploadRing::CUploadRing()
+	: m_NumberOfBytesPerFrame(0)
+	, m_Offset               (0)
+	, m_IsInFrame            (false)
+{
+	memset(&m_Statistics, 0, sizeof(m_Statistics));
+}
+
+// -----------------------------------------------------------------------------
+
+void CUploadRing::Create(int _NumberOfBytesPerFrame)
+{
+	m_NumberOfBytesPerFrame = (std::max(_NumberOfBytesPerFrame, s_RegisterSize) + s_RegisterSize - 1) / s_RegisterSize * s_RegisterSize;
+	m_Offset                = 0;
+	m_IsInFrame             = false;
+
+	m_Memory.assign(static_cast<size_t>(m_NumberOfBytesPerFrame), 0);
+
+	memset(&m_Statistics, 0, sizeof(m_Statistics));
+
+	m_Statistics.m_Capacity = m_NumberOfBytesPerFrame;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CUploadRing::BeginFrame()
+{
+	if(m_IsInFrame)
+	{
+		std::cout << "Upload ring: the previous frame was not ended" << std::endl;
+
+		return false;
+	}
+
+	if(m_Statistics.m_NumberOfOverflows > 0)
+	{
+		std::cout << "Upload ring overflow: " << m_Statistics.m_NumberOfOverflows << " objects did not fit into " << m_NumberOfBytesPerFrame << " bytes" << std::endl;
+
+		++ m_Statistics.m_NumberOfOverflowFrames;
+	}
+
+	m_Offset    = 0;
+	m_IsInFrame = true;
+
+	m_Statistics.m_NumberOfUsedBytes   = 0;
+	m_Statistics.m_NumberOfAllocations = 0;
+	m_Statistics.m_NumberOfOverflows   = 0;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+int CUploadRing::Allocate(int _NumberOfBytes, void** _ppData)
+{
+	++ m_Statistics.m_NumberOfAllocations;
+
+	int NumberOfBytes = (std::max(_NumberOfBytes, 1) + s_RegisterSize - 1) / s_RegisterSize * s_RegisterSize;
+
+	if(!m_IsInFrame || m_Offset + NumberOfBytes > m_NumberOfBytesPerFrame)
+	{
+		++ m_Statistics.m_NumberOfOverflows;
+
+		*_ppData = nullptr;
+
+		return -1;
+	}
+
+	*_ppData = &m_Memory[m_Offset];
+
+	int IndexOfRegister = m_Offset / s_RegisterSize;
+
+	m_Offset += NumberOfBytes;
+
+	m_Statistics.m_NumberOfUsedBytes = m_Offset;
+	m_Statistics.m_HighWaterMark     = std::max(m_Statistics.m_HighWaterMark, static_cast<size_t>(m_Offset));
+
+	return IndexOfRegister;
+}
+
+// -----------------------------------------------------------------------------
+
+void* CUploadRing::GetFrameData()
+{
+	return m_Memory.data();
+}
+
+// -----------------------------------------------------------------------------
+
+int CUploadRing::GetNumberOfBytesPerFrame() const
+{
+	return m_NumberOfBytesPerFrame;
+}
+
+// -----------------------------------------------------------------------------
+
+void CUploadRing::EndFrame()
+{
+	m_IsInFrame = false;
+}
+
+// -----------------------------------------------------------------------------
+
+const SFrameMemoryStatistics& CUploadRing::GetStatistics() const
+{
+	return m_Statistics;
+}
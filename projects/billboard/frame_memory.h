@@ -0,0 +1,113 @@
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Memory for data which only lives during one frame.
+//
+// CFrameArena is a linear allocator for short-lived CPU data such as visible
+// lists and draw lists. Allocating only moves an offset and everything is freed
+// at once when the arena is reset at the start of the next frame.
+//
+// CUploadRing collects the per object constants of a frame in one block, so
+// they can be uploaded with a single call into one large constant buffer. Each
+// object gets an offset in 16 byte registers, which its draw passes to the
+// shader. YoshiX copies the data when 'UploadConstantBuffer' is called, so the
+// block is free again right after the upload and every frame reuses it.
+//
+// Both report their high-water mark and count allocations which did not fit.
+// -----------------------------------------------------------------------------
+
+struct SFrameMemoryStatistics
+{
+	size_t m_Capacity;                  // The number of bytes available per frame.
+	size_t m_NumberOfUsedBytes;         // The bytes allocated in the current frame, including padding.
+	size_t m_HighWaterMark;             // The largest number of bytes used by a frame so far.
+	int    m_NumberOfAllocations;       // Allocations in the current frame.
+	int    m_NumberOfOverflows;         // Allocations in the current frame which did not fit.
+	int    m_NumberOfOverflowFrames;    // Frames so far with at least one overflow.
+};
+
+class CFrameArena
+{
+public:
+
+	CFrameArena();
+
+public:
+
+	void Create(size_t _Capacity);
+
+	// Frees all allocations of the previous frame.
+	void Reset();
+
+	// -----------------------------------------------------------------------------
+	// Returns uninitialized memory which is valid until the next reset, or a null
+	// pointer if the arena is full.
+	// -----------------------------------------------------------------------------
+	void* Allocate(size_t _NumberOfBytes, size_t _Alignment = 16);
+
+	template<typename TElement>
+	TElement* AllocateArray(int _NumberOfElements)
+	{
+		return static_cast<TElement*>(Allocate(sizeof(TElement) * _NumberOfElements, alignof(TElement) > 16 ? alignof(TElement) : 16));
+	}
+
+	const SFrameMemoryStatistics& GetStatistics() const;
+
+private:
+
+	std::vector<unsigned char> m_Memory;
+	size_t                     m_Offset;
+	SFrameMemoryStatistics     m_Statistics;
+};
+
+// -----------------------------------------------------------------------------
+
+class CUploadRing
+{
+public:
+
+	// The size of a shader constant register, offsets are counted in registers.
+	static const int s_RegisterSize = 16;
+
+public:
+
+	CUploadRing();
+
+public:
+
+	// -----------------------------------------------------------------------------
+	// The size of a frame is rounded up to whole registers. It has to match the
+	// size of the constant buffer the frames are uploaded into.
+	// -----------------------------------------------------------------------------
+	void Create(int _NumberOfBytesPerFrame);
+
+	// Starts filling the block again. Returns false if the last frame was not ended.
+	bool BeginFrame();
+
+	// -----------------------------------------------------------------------------
+	// Reserves space for the constants of one object at a register boundary and
+	// returns the register offset in the frame, or -1 if the frame is full.
+	// -----------------------------------------------------------------------------
+	int Allocate(int _NumberOfBytes, void** _ppData);
+
+	// The data to upload for the current frame, 'GetNumberOfBytesPerFrame' bytes.
+	void* GetFrameData();
+	int GetNumberOfBytesPerFrame() const;
+
+	// Marks the data of the current frame as uploaded.
+	void EndFrame();
+
+	const SFrameMemoryStatistics& GetStatistics() const;
+
+private:
+
+	std::vector<unsigned char> m_Memory;
+	int                        m_NumberOfBytesPerFrame;
+	int                        m_Offset;                    // The next free byte of the current frame.
+	bool                       m_IsInFrame;
+	SFrameMemoryStatistics     m_Statistics;
+};
@@ -0,0 +1,84 @@
+
+#include "frustum.h"
+
+#include <math.h>
+
+// -----------------------------------------------------------------------------
+
+void GetFrustum(const float* _pViewProjectionMatrix, SFrustum& _rFrustum)
+{
+	const float* pM = _pViewProjectionMatrix;
+
+	// -----------------------------------------------------------------------------
+	// With row vectors the clip space coordinates are the dot products of the
+	// position with the matrix columns. A point is inside if -w <= x <= w,
+	// -w <= y <= w and 0 <= z <= w.
+	// -----------------------------------------------------------------------------
+	for(int Axis = 0; Axis < 4; ++ Axis)
+	{
+		float X = pM[Axis * 4 + 0];
+		float Y = pM[Axis * 4 + 1];
+		float Z = pM[Axis * 4 + 2];
+		float W = pM[Axis * 4 + 3];
+
+		_rFrustum.m_Planes[0][Axis] = W + X;        // Left
+		_rFrustum.m_Planes[1][Axis] = W - X;        // Right
+		_rFrustum.m_Planes[2][Axis] = W + Y;        // Bottom
+		_rFrustum.m_Planes[3][Axis] = W - Y;        // Top
+		_rFrustum.m_Planes[4][Axis] = Z;            // Near
+		_rFrustum.m_Planes[5][Axis] = W - Z;        // Far
+	}
+
+	for(int IndexOfPlane = 0; IndexOfPlane < 6; ++ IndexOfPlane)
+	{
+		float* pPlane = _rFrustum.m_Planes[IndexOfPlane];
+		float  Length = sqrtf(pPlane[0] * pPlane[0] + pPlane[1] * pPlane[1] + pPlane[2] * pPlane[2]);
+
+		if(Length > 0.0f)
+		{
+			pPlane[0] /= Length;
+			pPlane[1] /= Length;
+			pPlane[2] /= Length;
+			pPlane[3] /= Length;
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+bool IsBoxVisible(const SFrustum& _rFrustum, const float* _pMin, const float* _pMax)
+{
+	for(int IndexOfPlane = 0; IndexOfPlane < 6; ++ IndexOfPlane)
+	{
+		const float* pPlane = _rFrustum.m_Planes[IndexOfPlane];
+
+		// Test the corner of the box which lies farthest along the plane normal.
+		float X = pPlane[0] >= 0.0f ? _pMax[0] : _pMin[0];
+		float Y = pPlane[1] >= 0.0f ? _pMax[1] : _pMin[1];
+		float Z = pPlane[2] >= 0.0f ? _pMax[2] : _pMin[2];
+
+		if(pPlane[0] * X + pPlane[1] * Y + pPlane[2] * Z + pPlane[3] < 0.0f)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool IsSphereVisible(const SFrustum& _rFrustum, const float* _pCenter, float _Radius)
+{
+	for(int IndexOfPlane = 0; IndexOfPlane < 6; ++ IndexOfPlane)
+	{
+		const float* pPlane = _rFrustum.m_Planes[IndexOfPlane];
+
+		if(pPlane[0] * _pCenter[0] + pPlane[1] * _pCenter[1] + pPlane[2] * _pCenter[2] + pPlane[3] < -_Radius)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
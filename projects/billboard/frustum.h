@@ -0,0 +1,22 @@
+
+#pragma once
+
+// -----------------------------------------------------------------------------
+// The six planes of a camera frustum in world space. The planes are extracted
+// from a view projection matrix in the YoshiX convention, where a position is
+// transformed as a row vector 'mul(float4(Position, 1), ViewProjection)' and
+// the clip space depth runs from 0 to 1. Each plane is stored as (a, b, c, d)
+// with the normal pointing into the frustum.
+// -----------------------------------------------------------------------------
+struct SFrustum
+{
+	float m_Planes[6][4];
+};
+
+void GetFrustum(const float* _pViewProjectionMatrix, SFrustum& _rFrustum);
+
+// Returns false if the axis aligned box lies completely outside of a plane.
+bool IsBoxVisible(const SFrustum& _rFrustum, const float* _pMin, const float* _pMax);
+
+// Returns false if the sphere lies completely outside of a plane.
+bool IsSphereVisible(const SFrustum& _rFrustum, const float* _pCenter, float _Radius);
@@ -0,0 +1,349 @@
+
+#include "input_recording.h"
+
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	const char     g_InputFileMagic[4] = { 'Y', 'X', 'I', 'R' };
+	const uint32_t g_InputFileVersion  = 1;
+
+	static_assert(sizeof(SInputFileHeader) == 24, "The header is written to the file as it is");
+	static_assert(sizeof(SInputEvent)      == 20, "The events are written to the file as they are");
+
+	// -----------------------------------------------------------------------------
+
+	int64_t GetMicroseconds()
+	{
+		return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+
+	// -----------------------------------------------------------------------------
+
+	int16_t ClampToInt16(int _Value)
+	{
+		return static_cast<int16_t>(std::min(std::max(_Value, -32768), 32767));
+	}
+
+	// -----------------------------------------------------------------------------
+
+	double GetPercentile(const std::vector<double>& _rSortedValues, double _Percentile)
+	{
+		if(_rSortedValues.empty())
+		{
+			return 0.0;
+		}
+
+		size_t Index = static_cast<size_t>(_Percentile * (_rSortedValues.size() - 1) + 0.5);
+
+		return _rSortedValues[Index];
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+CInputRecorder::CInputRecorder()
+	: m_Width      (0)
+	, m_Height     (0)
+	, m_StartTime  (0)
+	, m_IsRecording(false)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CInputRecorder::Start(const char* _pFileName, int _Width, int _Height)
+{
+	m_FileName    = _pFileName;
+	m_Width       = _Width;
+	m_Height      = _Height;
+	m_StartTime   = GetMicroseconds();
+	m_IsRecording = true;
+
+	m_Events.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CInputRecorder::Stop(int _NumberOfFrames)
+{
+	if(!m_IsRecording)
+	{
+		return false;
+	}
+
+	m_IsRecording = false;
+
+	SInputFileHeader Header;
+
+	memcpy(Header.m_Magic, g_InputFileMagic, sizeof(Header.m_Magic));
+
+	Header.m_Version        = g_InputFileVersion;
+	Header.m_Width          = static_cast<uint32_t>(m_Width);
+	Header.m_Height         = static_cast<uint32_t>(m_Height);
+	Header.m_NumberOfFrames = static_cast<uint32_t>(_NumberOfFrames);
+	Header.m_NumberOfEvents = static_cast<uint32_t>(m_Events.size());
+
+	std::ofstream Stream(m_FileName.c_str(), std::ios::binary);
+
+	Stream.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+
+	if(!m_Events.empty())
+	{
+		Stream.write(reinterpret_cast<const char*>(m_Events.data()), sizeof(SInputEvent) * m_Events.size());
+	}
+
+	if(!Stream)
+	{
+		std::cout << "Could not write input recording " << m_FileName << std::endl;
+
+		return false;
+	}
+
+	std::cout << "Recorded " << m_Events.size() << " input events in " << _NumberOfFrames << " frames to " << m_FileName << std::endl;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CInputRecorder::IsRecording() const
+{
+	return m_IsRecording;
+}
+
+// -----------------------------------------------------------------------------
+
+void CInputRecorder::RecordKeyEvent(int _IndexOfFrame, unsigned int _Key, bool _IsKeyDown, bool _IsAltDown)
+{
+	SInputEvent Event;
+
+	Event.m_KeyOrButton = static_cast<uint16_t>(_Key);
+	Event.m_Type        = SInputEvent::Key;
+	Event.m_Flags       = (_IsKeyDown ? SInputEvent::IsDown : 0) | (_IsAltDown ? SInputEvent::IsAltDown : 0);
+	Event.m_X           = 0;
+	Event.m_Y           = 0;
+	Event.m_WheelDelta  = 0;
+
+	AddEvent(Event, _IndexOfFrame);
+}
+
+// -----------------------------------------------------------------------------
+
+void CInputRecorder::RecordMouseEvent(int _IndexOfFrame, int _X, int _Y, int _Button, bool _IsButtonDown, bool _IsDoubleClick, int _WheelDelta)
+{
+	SInputEvent Event;
+
+	Event.m_KeyOrButton = static_cast<uint16_t>(_Button);
+	Event.m_Type        = SInputEvent::Mouse;
+	Event.m_Flags       = (_IsButtonDown ? SInputEvent::IsDown : 0) | (_IsDoubleClick ? SInputEvent::IsDoubleClick : 0);
+	Event.m_X           = ClampToInt16(_X);
+	Event.m_Y           = ClampToInt16(_Y);
+	Event.m_WheelDelta  = ClampToInt16(_WheelDelta);
+
+	AddEvent(Event, _IndexOfFrame);
+}
+
+// -----------------------------------------------------------------------------
+
+void CInputRecorder::AddEvent(SInputEvent& _rEvent, int _IndexOfFrame)
+{
+	if(!m_IsRecording)
+	{
+		return;
+	}
+
+	_rEvent.m_IndexOfFrame = static_cast<uint32_t>(_IndexOfFrame);
+	_rEvent.m_Time         = static_cast<uint32_t>(GetMicroseconds() - m_StartTime);
+	_rEvent.m_FILLER       = 0;
+
+	m_Events.push_back(_rEvent);
+}
+
+// -----------------------------------------------------------------------------
+
+CInputPlayer::CInputPlayer()
+	: m_IndexOfNextEvent(0)
+	, m_IsLoaded        (false)
+{
+	memset(&m_Header, 0, sizeof(m_Header));
+}
+
+// -----------------------------------------------------------------------------
+
+bool CInputPlayer::Load(const char* _pFileName)
+{
+	m_IsLoaded         = false;
+	m_IndexOfNextEvent = 0;
+
+	m_Events.clear();
+	m_FrameTimings.clear();
+
+	std::ifstream Stream(_pFileName, std::ios::binary);
+
+	if(!Stream.read(reinterpret_cast<char*>(&m_Header), sizeof(m_Header)) || memcmp(m_Header.m_Magic, g_InputFileMagic, sizeof(g_InputFileMagic)) != 0)
+	{
+		std::cout << "Could not read input recording " << _pFileName << std::endl;
+
+		return false;
+	}
+
+	if(m_Header.m_Version != g_InputFileVersion)
+	{
+		std::cout << "Input recording " << _pFileName << " has version " << m_Header.m_Version << ", expected " << g_InputFileVersion << std::endl;
+
+		return false;
+	}
+
+	m_Events.resize(m_Header.m_NumberOfEvents);
+
+	if(!m_Events.empty() && !Stream.read(reinterpret_cast<char*>(m_Events.data()), sizeof(SInputEvent) * m_Events.size()))
+	{
+		std::cout << "Input recording " << _pFileName << " is truncated" << std::endl;
+
+		m_Events.clear();
+
+		return false;
+	}
+
+	// The events were recorded in order, but do not rely on a file written by someone else.
+	std::stable_sort(m_Events.begin(), m_Events.end(), [](const SInputEvent& _rLeft, const SInputEvent& _rRight) { return _rLeft.m_IndexOfFrame < _rRight.m_IndexOfFrame; });
+
+	m_FrameTimings.reserve(m_Header.m_NumberOfFrames);
+
+	m_IsLoaded = true;
+
+	std::cout << "Replaying " << m_Events.size() << " input events in " << m_Header.m_NumberOfFrames << " frames from " << _pFileName << std::endl;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CInputPlayer::IsLoaded() const
+{
+	return m_IsLoaded;
+}
+
+// -----------------------------------------------------------------------------
+
+int CInputPlayer::GetWidth() const
+{
+	return static_cast<int>(m_Header.m_Width);
+}
+
+// -----------------------------------------------------------------------------
+
+int CInputPlayer::GetHeight() const
+{
+	return static_cast<int>(m_Header.m_Height);
+}
+
+// -----------------------------------------------------------------------------
+
+int CInputPlayer::GetNumberOfFrames() const
+{
+	return static_cast<int>(m_Header.m_NumberOfFrames);
+}
+
+// -----------------------------------------------------------------------------
+
+const SInputEvent* CInputPlayer::GetEvents(int _IndexOfFrame, int& _rNumberOfEvents)
+{
+	size_t IndexOfFirstEvent = m_IndexOfNextEvent;
+
+	while(m_IndexOfNextEvent < m_Events.size() && m_Events[m_IndexOfNextEvent].m_IndexOfFrame <= static_cast<uint32_t>(_IndexOfFrame))
+	{
+		++ m_IndexOfNextEvent;
+	}
+
+	_rNumberOfEvents = static_cast<int>(m_IndexOfNextEvent - IndexOfFirstEvent);
+
+	return _rNumberOfEvents > 0 ? &m_Events[IndexOfFirstEvent] : nullptr;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CInputPlayer::IsFinished(int _IndexOfFrame) const
+{
+	return _IndexOfFrame >= static_cast<int>(m_Header.m_NumberOfFrames);
+}
+
+// -----------------------------------------------------------------------------
+
+void CInputPlayer::AddFrameTiming(double _FrameTime, double _CPUTime)
+{
+	SFrameTiming FrameTiming;
+
+	FrameTiming.m_FrameTime = _FrameTime;
+	FrameTiming.m_CPUTime   = _CPUTime;
+
+	m_FrameTimings.push_back(FrameTiming);
+}
+
+// -----------------------------------------------------------------------------
+
+bool CInputPlayer::WriteFrameTimings(const char* _pFileName) const
+{
+	std::vector<double> FrameTimes;
+	std::vector<double> CPUTimes;
+
+	FrameTimes.reserve(m_FrameTimings.size());
+	CPUTimes  .reserve(m_FrameTimings.size());
+
+	for(const SFrameTiming& rFrameTiming : m_FrameTimings)
+	{
+		FrameTimes.push_back(rFrameTiming.m_FrameTime);
+		CPUTimes  .push_back(rFrameTiming.m_CPUTime);
+	}
+
+	std::sort(FrameTimes.begin(), FrameTimes.end());
+	std::sort(CPUTimes  .begin(), CPUTimes  .end());
+
+	double FrameTimeSum = 0.0;
+	double CPUTimeSum   = 0.0;
+
+	for(size_t IndexOfFrame = 0; IndexOfFrame < FrameTimes.size(); ++ IndexOfFrame)
+	{
+		FrameTimeSum += FrameTimes[IndexOfFrame];
+		CPUTimeSum   += CPUTimes  [IndexOfFrame];
+	}
+
+	double NumberOfFrames = static_cast<double>(std::max<size_t>(m_FrameTimings.size(), 1));
+
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Replay of " << m_FrameTimings.size() << " frames" << std::endl;
+	std::cout << "    frame ms: average " << FrameTimeSum / NumberOfFrames << ", median " << GetPercentile(FrameTimes, 0.5) << ", 95% " << GetPercentile(FrameTimes, 0.95) << ", 99% " << GetPercentile(FrameTimes, 0.99) << ", max " << GetPercentile(FrameTimes, 1.0) << std::endl;
+	std::cout << "    cpu ms:   average " << CPUTimeSum   / NumberOfFrames << ", median " << GetPercentile(CPUTimes,   0.5) << ", 95% " << GetPercentile(CPUTimes,   0.95) << ", 99% " << GetPercentile(CPUTimes,   0.99) << ", max " << GetPercentile(CPUTimes,   1.0) << std::endl;
+	std::cout << std::defaultfloat;
+
+	if(_pFileName == nullptr)
+	{
+		return true;
+	}
+
+	std::ofstream Stream(_pFileName);
+
+	Stream << "frame,frame_ms,cpu_ms\n" << std::fixed << std::setprecision(4);
+
+	for(size_t IndexOfFrame = 0; IndexOfFrame < m_FrameTimings.size(); ++ IndexOfFrame)
+	{
+		Stream << IndexOfFrame << ',' << m_FrameTimings[IndexOfFrame].m_FrameTime << ',' << m_FrameTimings[IndexOfFrame].m_CPUTime << '\n';
+	}
+
+	if(!Stream)
+	{
+		std::cout << "Could not write frame timings " << _pFileName << std::endl;
+
+		return false;
+	}
+
+	std::cout << "Wrote frame timings to " << _pFileName << std::endl;
+
+	return true;
+}
@@ -0,0 +1,146 @@
+
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Capture and replay of the user input, so performance runs can follow exactly
+// the same camera path.
+//
+// CInputRecorder collects the key and mouse events of a run together with the
+// index of the frame they arrived in and writes them into a binary file when
+// the run ends. CInputPlayer reads such a file and hands out the events of each
+// frame again. The application steps its camera per frame and not per second,
+// so feeding the events back at the same frame indices reproduces the path
+// independent of the frame rate.
+//
+// File layout, little endian:
+//
+//     SInputFileHeader   magic, version, window size, frame and event count
+//     SInputEvent[]      the events sorted by frame
+//
+// The player also collects the time of each replayed frame and writes them as
+// CSV, so two builds can be compared on the same input.
+// -----------------------------------------------------------------------------
+
+struct SInputFileHeader
+{
+	char     m_Magic[4];                // "YXIR"
+	uint32_t m_Version;
+	uint32_t m_Width;                   // The window size during the recording.
+	uint32_t m_Height;
+	uint32_t m_NumberOfFrames;          // The number of frames the recording ran.
+	uint32_t m_NumberOfEvents;
+};
+
+struct SInputEvent
+{
+	enum EType
+	{
+		Key,
+		Mouse,
+	};
+
+	enum EFlags
+	{
+		IsDown        = 1,              // The key or the mouse button was pressed and not released.
+		IsAltDown     = 2,
+		IsDoubleClick = 4,
+	};
+
+	uint32_t m_IndexOfFrame;            // The frame the event has to be handled before.
+	uint32_t m_Time;                    // Microseconds since the start of the recording, only for information.
+	uint16_t m_KeyOrButton;
+	uint8_t  m_Type;
+	uint8_t  m_Flags;
+	int16_t  m_X;                       // The mouse position in pixels.
+	int16_t  m_Y;
+	int16_t  m_WheelDelta;
+	int16_t  m_FILLER;
+};
+
+struct SFrameTiming
+{
+	double m_FrameTime;                 // Milliseconds from the start of this frame to the start of the next one.
+	double m_CPUTime;                   // Milliseconds spent in update and frame of the application.
+};
+
+class CInputRecorder
+{
+public:
+
+	CInputRecorder();
+
+public:
+
+	// Starts a new recording, the file is written by 'Stop'.
+	void Start(const char* _pFileName, int _Width, int _Height);
+
+	// Writes the recording. Returns false if the file could not be written.
+	bool Stop(int _NumberOfFrames);
+
+	bool IsRecording() const;
+
+	void RecordKeyEvent(int _IndexOfFrame, unsigned int _Key, bool _IsKeyDown, bool _IsAltDown);
+	void RecordMouseEvent(int _IndexOfFrame, int _X, int _Y, int _Button, bool _IsButtonDown, bool _IsDoubleClick, int _WheelDelta);
+
+private:
+
+	void AddEvent(SInputEvent& _rEvent, int _IndexOfFrame);
+
+private:
+
+	std::string              m_FileName;
+	std::vector<SInputEvent> m_Events;
+	int                      m_Width;
+	int                      m_Height;
+	int64_t                  m_StartTime;   // Microseconds of the steady clock at the start.
+	bool                     m_IsRecording;
+};
+
+// -----------------------------------------------------------------------------
+
+class CInputPlayer
+{
+public:
+
+	CInputPlayer();
+
+public:
+
+	// Reads a recording. Returns false if the file is missing or broken.
+	bool Load(const char* _pFileName);
+
+	bool IsLoaded() const;
+
+	int GetWidth() const;
+	int GetHeight() const;
+	int GetNumberOfFrames() const;
+
+	// -----------------------------------------------------------------------------
+	// Returns the events of the given frame. Frames have to be requested in order,
+	// each one once.
+	// -----------------------------------------------------------------------------
+	const SInputEvent* GetEvents(int _IndexOfFrame, int& _rNumberOfEvents);
+
+	bool IsFinished(int _IndexOfFrame) const;
+
+	void AddFrameTiming(double _FrameTime, double _CPUTime);
+
+	// -----------------------------------------------------------------------------
+	// Writes the timing of every replayed frame as CSV and prints the average and
+	// the percentiles. Without a file name only the summary is printed. Returns
+	// false if the file could not be written.
+	// -----------------------------------------------------------------------------
+	bool WriteFrameTimings(const char* _pFileName) const;
+
+private:
+
+	SInputFileHeader          m_Header;
+	std::vector<SInputEvent>  m_Events;
+	size_t                    m_IndexOfNextEvent;
+	std::vector<SFrameTiming> m_FrameTimings;
+	bool                      m_IsLoaded;
+};
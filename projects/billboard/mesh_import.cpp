@@ -0,0 +1,1922 @@
+
+#include "mesh_import.h"
+#include "parallel.h"
+
+#include <float.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+using namespace gfx;
+
+namespace
+{
+	// Offsets of the single attributes inside of an interleaved vertex.
+	const int g_PositionOffset = 0;
+	const int g_TangentOffset  = 3;
+	const int g_BinormalOffset = 6;
+	const int g_NormalOffset   = 9;
+	const int g_TexCoordOffset = 12;
+
+	// The number of index triples read from a glTF buffer at once.
+	const int g_NumberOfTrianglesPerChunk = 16384;
+
+	// -----------------------------------------------------------------------------
+	// One corner of a triangle as it is read from the source file.
+	// -----------------------------------------------------------------------------
+	struct SCorner
+	{
+		float m_Position[3];
+		float m_Normal[3];
+		float m_TexCoord[2];
+	};
+
+	// -----------------------------------------------------------------------------
+	// Two corners are welded into the same vertex if position, normal and texture
+	// coordinate are bitwise equal and their triangles map the texture with the
+	// same handedness. Corners on both sides of a mirrored texture seam stay
+	// apart, so their tangent frames can not cancel each other. Negative zero is
+	// folded into positive zero before, so both hash to the same key.
+	// -----------------------------------------------------------------------------
+	struct SWeldKey
+	{
+		uint32_t m_Bits[9];
+
+		bool operator == (const SWeldKey& _rOther) const
+		{
+			return memcmp(m_Bits, _rOther.m_Bits, sizeof(m_Bits)) == 0;
+		}
+	};
+
+	struct SWeldKeyHash
+	{
+		size_t operator () (const SWeldKey& _rKey) const
+		{
+			// FNV-1a over the nine 32 bit words.
+			uint64_t Hash = 14695981039346656037ull;
+
+			for(int IndexOfWord = 0; IndexOfWord < 9; ++ IndexOfWord)
+			{
+				Hash ^= _rKey.m_Bits[IndexOfWord];
+				Hash *= 1099511628211ull;
+			}
+
+			return static_cast<size_t>(Hash ^ (Hash >> 32));
+		}
+	};
+
+	uint32_t GetWeldBits(float _Value)
+	{
+		uint32_t Bits;
+
+		_Value = _Value == 0.0f ? 0.0f : _Value;
+
+		memcpy(&Bits, &_Value, sizeof(Bits));
+
+		return Bits;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Collects the streamed triangles and welds equal corners into one vertex.
+	// -----------------------------------------------------------------------------
+	class CMeshWelder
+	{
+	public:
+
+		CMeshWelder(const SImportSettings& _rSettings, SImportedMesh& _rMesh);
+
+	public:
+
+		void AddTriangle(const SCorner* _pCorners);
+
+	private:
+
+		int AddCorner(const SCorner& _rCorner, bool _IsMirrored);
+
+	private:
+
+		const SImportSettings& m_rSettings;
+		SImportedMesh&         m_rMesh;
+
+		std::unordered_map<SWeldKey, int, SWeldKeyHash> m_VertexMap;
+	};
+
+	// -----------------------------------------------------------------------------
+
+	CMeshWelder::CMeshWelder(const SImportSettings& _rSettings, SImportedMesh& _rMesh)
+		: m_rSettings(_rSettings)
+		, m_rMesh    (_rMesh)
+	{
+		m_rMesh.m_Vertices.clear();
+		m_rMesh.m_Indices .clear();
+
+		memset(&m_rMesh.m_Statistics, 0, sizeof(m_rMesh.m_Statistics));
+	}
+
+	// -----------------------------------------------------------------------------
+
+	void CMeshWelder::AddTriangle(const SCorner* _pCorners)
+	{
+		// The texture coordinates wind clockwise on a mirrored triangle.
+		float DeltaU1 = _pCorners[1].m_TexCoord[0] - _pCorners[0].m_TexCoord[0];
+		float DeltaV1 = _pCorners[1].m_TexCoord[1] - _pCorners[0].m_TexCoord[1];
+		float DeltaU2 = _pCorners[2].m_TexCoord[0] - _pCorners[0].m_TexCoord[0];
+		float DeltaV2 = _pCorners[2].m_TexCoord[1] - _pCorners[0].m_TexCoord[1];
+
+		bool IsMirrored = DeltaU1 * DeltaV2 - DeltaU2 * DeltaV1 < 0.0f;
+
+		for(int IndexOfCorner = 0; IndexOfCorner < 3; ++ IndexOfCorner)
+		{
+			m_rMesh.m_Indices.push_back(AddCorner(_pCorners[IndexOfCorner], IsMirrored));
+		}
+
+		++ m_rMesh.m_Statistics.m_NumberOfSourceTriangles;
+	}
+
+	// -----------------------------------------------------------------------------
+
+	int CMeshWelder::AddCorner(const SCorner& _rCorner, bool _IsMirrored)
+	{
+		SWeldKey Key;
+		float    TexCoordV;
+
+		TexCoordV = m_rSettings.m_FlipTexCoordV ? 1.0f - _rCorner.m_TexCoord[1] : _rCorner.m_TexCoord[1];
+
+		Key.m_Bits[0] = GetWeldBits(_rCorner.m_Position[0] * m_rSettings.m_Scale);
+		Key.m_Bits[1] = GetWeldBits(_rCorner.m_Position[1] * m_rSettings.m_Scale);
+		Key.m_Bits[2] = GetWeldBits(_rCorner.m_Position[2] * m_rSettings.m_Scale);
+		Key.m_Bits[3] = GetWeldBits(m_rSettings.m_GenerateNormals ? 0.0f : _rCorner.m_Normal[0]);
+		Key.m_Bits[4] = GetWeldBits(m_rSettings.m_GenerateNormals ? 0.0f : _rCorner.m_Normal[1]);
+		Key.m_Bits[5] = GetWeldBits(m_rSettings.m_GenerateNormals ? 0.0f : _rCorner.m_Normal[2]);
+		Key.m_Bits[6] = GetWeldBits(_rCorner.m_TexCoord[0]);
+		Key.m_Bits[7] = GetWeldBits(TexCoordV);
+		Key.m_Bits[8] = _IsMirrored ? 1 : 0;
+
+		++ m_rMesh.m_Statistics.m_NumberOfInputCorners;
+
+		std::pair<std::unordered_map<SWeldKey, int, SWeldKeyHash>::iterator, bool> Result = m_VertexMap.insert(std::make_pair(Key, static_cast<int>(m_VertexMap.size())));
+
+		if(Result.second)
+		{
+			float Vertex[g_NumberOfFloatsPerImportedVertex] = { 0.0f };
+
+			memcpy(&Vertex[g_PositionOffset], &Key.m_Bits[0], 3 * sizeof(float));
+			memcpy(&Vertex[g_NormalOffset],   &Key.m_Bits[3], 3 * sizeof(float));
+			memcpy(&Vertex[g_TexCoordOffset], &Key.m_Bits[6], 2 * sizeof(float));
+
+			m_rMesh.m_Vertices.insert(m_rMesh.m_Vertices.end(), Vertex, Vertex + g_NumberOfFloatsPerImportedVertex);
+		}
+
+		return Result.first->second;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Small vector helpers working on the interleaved floats.
+	// -----------------------------------------------------------------------------
+	void Subtract(const float* _pLeft, const float* _pRight, float* _pResult)
+	{
+		_pResult[0] = _pLeft[0] - _pRight[0];
+		_pResult[1] = _pLeft[1] - _pRight[1];
+		_pResult[2] = _pLeft[2] - _pRight[2];
+	}
+
+	void AddScaled(const float* _pVector, float _Scale, float* _pResult)
+	{
+		_pResult[0] += _pVector[0] * _Scale;
+		_pResult[1] += _pVector[1] * _Scale;
+		_pResult[2] += _pVector[2] * _Scale;
+	}
+
+	float GetLength(const float* _pVector)
+	{
+		return sqrtf(GetDotProduct3D(_pVector, _pVector));
+	}
+
+	// Normalizes the vector and returns false if it has no usable length.
+	bool Normalize(float* _pVector)
+	{
+		float Length = GetLength(_pVector);
+
+		if(Length < 1.0e-20f)
+		{
+			return false;
+		}
+
+		_pVector[0] /= Length;
+		_pVector[1] /= Length;
+		_pVector[2] /= Length;
+
+		return true;
+	}
+
+	// Removes the part of the vector pointing along the unit normal.
+	void Orthogonalize(const float* _pNormal, float* _pVector)
+	{
+		AddScaled(_pNormal, -GetDotProduct3D(_pNormal, _pVector), _pVector);
+	}
+
+	// Angle at the corner '_pCorner' between the edges to the two other corners.
+	float GetCornerAngle(const float* _pCorner, const float* _pNext, const float* _pPrevious)
+	{
+		float Edge1[3];
+		float Edge2[3];
+
+		Subtract(_pNext, _pCorner, Edge1);
+		Subtract(_pPrevious, _pCorner, Edge2);
+
+		if(!Normalize(Edge1) || !Normalize(Edge2))
+		{
+			return 0.0f;
+		}
+
+		float Cosine = GetDotProduct3D(Edge1, Edge2);
+
+		Cosine = Cosine < -1.0f ? -1.0f : (Cosine > 1.0f ? 1.0f : Cosine);
+
+		return acosf(Cosine);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Lists for every vertex the triangles using it (compressed row storage), so
+	// the per vertex passes can gather without write conflicts between threads.
+	// -----------------------------------------------------------------------------
+	struct SVertexTriangles
+	{
+		std::vector<int> m_Offsets;         // 'm_Offsets[v]' to 'm_Offsets[v + 1]' is the range of vertex v in 'm_Corners'.
+		std::vector<int> m_Corners;         // Corner indices (3 * triangle + corner) of all triangles using a vertex.
+	};
+
+	void BuildVertexTriangles(int _NumberOfVertices, const int* _pIndices, int _NumberOfIndices, SVertexTriangles& _rVertexTriangles)
+	{
+		std::vector<int> Cursor;
+
+		_rVertexTriangles.m_Offsets.assign(_NumberOfVertices + 1, 0);
+		_rVertexTriangles.m_Corners.resize(_NumberOfIndices);
+
+		for(int IndexOfCorner = 0; IndexOfCorner < _NumberOfIndices; ++ IndexOfCorner)
+		{
+			++ _rVertexTriangles.m_Offsets[_pIndices[IndexOfCorner] + 1];
+		}
+
+		for(int IndexOfVertex = 0; IndexOfVertex < _NumberOfVertices; ++ IndexOfVertex)
+		{
+			_rVertexTriangles.m_Offsets[IndexOfVertex + 1] += _rVertexTriangles.m_Offsets[IndexOfVertex];
+		}
+
+		Cursor.assign(_rVertexTriangles.m_Offsets.begin(), _rVertexTriangles.m_Offsets.end() - 1);
+
+		for(int IndexOfCorner = 0; IndexOfCorner < _NumberOfIndices; ++ IndexOfCorner)
+		{
+			_rVertexTriangles.m_Corners[Cursor[_pIndices[IndexOfCorner]] ++] = IndexOfCorner;
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// Generates angle weighted smooth normals for all vertices.
+	// -----------------------------------------------------------------------------
+	void GenerateNormals(float* _pVertices, int _NumberOfVertices, const int* _pIndices, int _NumberOfIndices, const SVertexTriangles& _rVertexTriangles, int _NumberOfThreads)
+	{
+		int NumberOfTriangles = _NumberOfIndices / 3;
+
+		std::vector<float> FaceNormals(NumberOfTriangles * 3);
+
+		ParallelFor(NumberOfTriangles, _NumberOfThreads, [&](int _Begin, int _End)
+		{
+			for(int IndexOfTriangle = _Begin; IndexOfTriangle < _End; ++ IndexOfTriangle)
+			{
+				const float* pP0 = &_pVertices[_pIndices[IndexOfTriangle * 3 + 0] * g_NumberOfFloatsPerImportedVertex];
+				const float* pP1 = &_pVertices[_pIndices[IndexOfTriangle * 3 + 1] * g_NumberOfFloatsPerImportedVertex];
+				const float* pP2 = &_pVertices[_pIndices[IndexOfTriangle * 3 + 2] * g_NumberOfFloatsPerImportedVertex];
+
+				float Edge1[3];
+				float Edge2[3];
+
+				Subtract(pP1, pP0, Edge1);
+				Subtract(pP2, pP0, Edge2);
+
+				// Counter-clockwise triangles seen from the front in the left handed
+				// YoshiX coordinate system.
+				GetCrossProduct(Edge2, Edge1, &FaceNormals[IndexOfTriangle * 3]);
+
+				Normalize(&FaceNormals[IndexOfTriangle * 3]);
+			}
+		});
+
+		ParallelFor(_NumberOfVertices, _NumberOfThreads, [&](int _Begin, int _End)
+		{
+			for(int IndexOfVertex = _Begin; IndexOfVertex < _End; ++ IndexOfVertex)
+			{
+				float* pNormal = &_pVertices[IndexOfVertex * g_NumberOfFloatsPerImportedVertex + g_NormalOffset];
+
+				pNormal[0] = pNormal[1] = pNormal[2] = 0.0f;
+
+				for(int IndexOfEntry = _rVertexTriangles.m_Offsets[IndexOfVertex]; IndexOfEntry < _rVertexTriangles.m_Offsets[IndexOfVertex + 1]; ++ IndexOfEntry)
+				{
+					int IndexOfCorner   = _rVertexTriangles.m_Corners[IndexOfEntry];
+					int IndexOfTriangle = IndexOfCorner / 3;
+					int Corner          = IndexOfCorner % 3;
+
+					const float* pCorner   = &_pVertices[_pIndices[IndexOfTriangle * 3 + Corner] * g_NumberOfFloatsPerImportedVertex];
+					const float* pNext     = &_pVertices[_pIndices[IndexOfTriangle * 3 + (Corner + 1) % 3] * g_NumberOfFloatsPerImportedVertex];
+					const float* pPrevious = &_pVertices[_pIndices[IndexOfTriangle * 3 + (Corner + 2) % 3] * g_NumberOfFloatsPerImportedVertex];
+
+					AddScaled(&FaceNormals[IndexOfTriangle * 3], GetCornerAngle(pCorner, pNext, pPrevious), pNormal);
+				}
+
+				if(!Normalize(pNormal))
+				{
+					pNormal[0] = 0.0f; pNormal[1] = 0.0f; pNormal[2] = -1.0f;
+				}
+			}
+		});
+	}
+
+	// -----------------------------------------------------------------------------
+	// The tangent frames follow MikkTSpace (mikktspace.c by Morten S. Mikkelsen),
+	// which most bakers use for their normal maps. The steps and the floating point
+	// operations are the ones of the reference implementation, only the parts which
+	// do not depend on each other run on several threads:
+	//
+	//  - Corners with equal position, normal and texture coordinate are shared.
+	//  - Triangles with two equal positions are degenerate and copy the frames of
+	//    good corners of the same shared vertex at the end.
+	//  - Triangles are connected over edges they share in opposite directions.
+	//  - The corners around a vertex form a group if they are connected and map the
+	//    texture with the same orientation. Triangles without texture area join
+	//    the first group reaching them.
+	//  - The tangent of a corner is the angle weighted sum of the unit tangents of
+	//    its group, all projected into the tangent plane of the normal.
+	//
+	// The results are per corner. Corners of a vertex may end up in different
+	// groups, then the vertex has to be split to keep all frames.
+	// -----------------------------------------------------------------------------
+	const int g_MikkGroupWithAny     = 4;
+	const int g_MikkOrientPreserving = 8;
+
+	struct SMikkTriangle
+	{
+		int   m_Neighbors[3];           // The triangle sharing the edge starting at each corner, -1 if none.
+		int   m_Groups[3];              // The group of each corner, -1 if not assigned.
+		float m_TangentS[3];            // The unit direction of increasing u, flipped on orientation reversing triangles.
+		float m_TangentT[3];            // The unit direction of increasing v, flipped the same way.
+		int   m_Flags;
+	};
+
+	struct SMikkEdge
+	{
+		int m_Index0;                   // The smaller shared vertex index.
+		int m_Index1;                   // The larger shared vertex index.
+		int m_Triangle;
+
+		bool operator < (const SMikkEdge& _rOther) const
+		{
+			if(m_Index0 != _rOther.m_Index0) return m_Index0 < _rOther.m_Index0;
+			if(m_Index1 != _rOther.m_Index1) return m_Index1 < _rOther.m_Index1;
+
+			return m_Triangle < _rOther.m_Triangle;
+		}
+	};
+
+	struct SMikkGroup
+	{
+		int  m_Vertex;                  // The shared vertex index all corners of the group use.
+		bool m_IsOrientPreserving;
+		int  m_FirstTriangle;           // The range of the group in the triangle buffer of all groups.
+		int  m_NumberOfTriangles;
+	};
+
+	struct SCornerFrame
+	{
+		float m_Tangent[3];
+		float m_Sign;                   // The bitangent is 'm_Sign * cross(normal, tangent)'.
+	};
+
+	// MikkTSpace treats every component up to the smallest normalized float as zero.
+	bool IsNotZero(const float* _pVector)
+	{
+		return fabsf(_pVector[0]) > FLT_MIN || fabsf(_pVector[1]) > FLT_MIN || fabsf(_pVector[2]) > FLT_MIN;
+	}
+
+	// Projects the vector into the tangent plane and makes it unit length unless it vanished.
+	void ProjectIntoTangentPlane(const float* _pNormal, const float* _pVector, float* _pResult)
+	{
+		_pResult[0] = _pVector[0]; _pResult[1] = _pVector[1]; _pResult[2] = _pVector[2];
+
+		Orthogonalize(_pNormal, _pResult);
+
+		if(IsNotZero(_pResult))
+		{
+			float Scale = 1.0f / GetLength(_pResult);
+
+			_pResult[0] *= Scale; _pResult[1] *= Scale; _pResult[2] *= Scale;
+		}
+	}
+
+	// Returns the corner of the triangle using the shared vertex, -1 if none does.
+	int FindCorner(const int* _pTriangle, int _Vertex)
+	{
+		return _pTriangle[0] == _Vertex ? 0 : (_pTriangle[1] == _Vertex ? 1 : (_pTriangle[2] == _Vertex ? 2 : -1));
+	}
+
+	// -----------------------------------------------------------------------------
+	// Adds the triangle to the group of its corner at the group vertex and follows
+	// both edges at that corner. The reference does this recursively, the explicit
+	// stack visits the triangles in the same order.
+	// -----------------------------------------------------------------------------
+	void GrowMikkGroup(const int* _pCorners, std::vector<SMikkTriangle>& _rTriangles, int _IndexOfGroup, SMikkGroup& _rGroup, std::vector<int>& _rGroupTriangles, std::vector<int>& _rStack)
+	{
+		while(!_rStack.empty())
+		{
+			int           IndexOfTriangle = _rStack.back();
+			SMikkTriangle& rTriangle      = _rTriangles[IndexOfTriangle];
+
+			_rStack.pop_back();
+
+			int Corner = FindCorner(&_pCorners[IndexOfTriangle * 3], _rGroup.m_Vertex);
+
+			if(rTriangle.m_Groups[Corner] != -1)
+			{
+				continue;
+			}
+
+			// The first group reaching a triangle without texture area decides its orientation.
+			if((rTriangle.m_Flags & g_MikkGroupWithAny) != 0 && rTriangle.m_Groups[0] == -1 && rTriangle.m_Groups[1] == -1 && rTriangle.m_Groups[2] == -1)
+			{
+				rTriangle.m_Flags &= ~g_MikkOrientPreserving;
+				rTriangle.m_Flags |= _rGroup.m_IsOrientPreserving ? g_MikkOrientPreserving : 0;
+			}
+
+			if(((rTriangle.m_Flags & g_MikkOrientPreserving) != 0) != _rGroup.m_IsOrientPreserving)
+			{
+				continue;
+			}
+
+			_rGroupTriangles[_rGroup.m_FirstTriangle + _rGroup.m_NumberOfTriangles ++] = IndexOfTriangle;
+
+			rTriangle.m_Groups[Corner] = _IndexOfGroup;
+
+			if(rTriangle.m_Neighbors[(Corner + 2) % 3] >= 0) _rStack.push_back(rTriangle.m_Neighbors[(Corner + 2) % 3]);
+			if(rTriangle.m_Neighbors[Corner]           >= 0) _rStack.push_back(rTriangle.m_Neighbors[Corner]);
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// Sums the tangents of a set of triangles around the shared vertex, weighted by
+	// the angle of the corner at the vertex in the tangent plane.
+	// -----------------------------------------------------------------------------
+	void EvaluateMikkTangent(const float* _pVertices, const int* _pCorners, const std::vector<SMikkTriangle>& _rTriangles, const std::vector<int>& _rMembers, int _Vertex, float* _pTangent)
+	{
+		const float* pNormal = &_pVertices[_Vertex * g_NumberOfFloatsPerImportedVertex + g_NormalOffset];
+
+		_pTangent[0] = _pTangent[1] = _pTangent[2] = 0.0f;
+
+		for(int IndexOfTriangle : _rMembers)
+		{
+			const SMikkTriangle& rTriangle = _rTriangles[IndexOfTriangle];
+			const int*           pCorners  = &_pCorners[IndexOfTriangle * 3];
+
+			if((rTriangle.m_Flags & g_MikkGroupWithAny) != 0)
+			{
+				continue;
+			}
+
+			int Corner = FindCorner(pCorners, _Vertex);
+
+			const float* pPrevious = &_pVertices[pCorners[(Corner + 2) % 3] * g_NumberOfFloatsPerImportedVertex + g_PositionOffset];
+			const float* pCorner   = &_pVertices[pCorners[Corner]           * g_NumberOfFloatsPerImportedVertex + g_PositionOffset];
+			const float* pNext     = &_pVertices[pCorners[(Corner + 1) % 3] * g_NumberOfFloatsPerImportedVertex + g_PositionOffset];
+
+			float Tangent[3];
+			float Edge1  [3];
+			float Edge2  [3];
+
+			ProjectIntoTangentPlane(pNormal, rTriangle.m_TangentS, Tangent);
+
+			Subtract(pPrevious, pCorner, Edge1);
+			Subtract(pNext,     pCorner, Edge2);
+
+			ProjectIntoTangentPlane(pNormal, Edge1, Edge1);
+			ProjectIntoTangentPlane(pNormal, Edge2, Edge2);
+
+			float Cosine = GetDotProduct3D(Edge1, Edge2);
+
+			Cosine = Cosine > 1.0f ? 1.0f : (Cosine < -1.0f ? -1.0f : Cosine);
+
+			AddScaled(Tangent, static_cast<float>(acos(Cosine)), _pTangent);
+		}
+
+		if(IsNotZero(_pTangent))
+		{
+			float Scale = 1.0f / GetLength(_pTangent);
+
+			_pTangent[0] *= Scale; _pTangent[1] *= Scale; _pTangent[2] *= Scale;
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// Generates the MikkTSpace tangent and bitangent sign of every triangle corner.
+	// The normals are normalized in place before. Returns the number of triangles
+	// which have no texture area or are degenerate and do not add to any frame.
+	// -----------------------------------------------------------------------------
+	int GenerateCornerFrames(float* _pVertices, int _NumberOfVertices, const int* _pIndices, int _NumberOfIndices, int _NumberOfThreads, std::vector<SCornerFrame>& _rFrames)
+	{
+		int NumberOfTriangles = _NumberOfIndices / 3;
+
+		// Corners which are not evaluated keep the default of the reference.
+		SCornerFrame DefaultFrame = { { 1.0f, 0.0f, 0.0f }, -1.0f };
+
+		_rFrames.assign(NumberOfTriangles * 3, DefaultFrame);
+
+		ParallelFor(_NumberOfVertices, _NumberOfThreads, [&](int _Begin, int _End)
+		{
+			for(int IndexOfVertex = _Begin; IndexOfVertex < _End; ++ IndexOfVertex)
+			{
+				float* pNormal = &_pVertices[IndexOfVertex * g_NumberOfFloatsPerImportedVertex + g_NormalOffset];
+
+				if(!Normalize(pNormal))
+				{
+					pNormal[0] = 0.0f; pNormal[1] = 0.0f; pNormal[2] = -1.0f;
+				}
+			}
+		});
+
+		// -----------------------------------------------------------------------------
+		// Share the vertices which only differ in the handedness the welder keeps
+		// apart, and sort the degenerate triangles out. 'Triangles' holds the source
+		// triangle of each good triangle, in the order of the source.
+		// -----------------------------------------------------------------------------
+		std::unordered_map<SWeldKey, int, SWeldKeyHash> SharedVertexMap;
+		std::vector<int>                                SharedVertices(_NumberOfVertices);
+
+		for(int IndexOfVertex = 0; IndexOfVertex < _NumberOfVertices; ++ IndexOfVertex)
+		{
+			const float* pVertex = &_pVertices[IndexOfVertex * g_NumberOfFloatsPerImportedVertex];
+
+			SWeldKey Key;
+
+			for(int IndexOfComponent = 0; IndexOfComponent < 3; ++ IndexOfComponent)
+			{
+				Key.m_Bits[0 + IndexOfComponent] = GetWeldBits(pVertex[g_PositionOffset + IndexOfComponent]);
+				Key.m_Bits[3 + IndexOfComponent] = GetWeldBits(pVertex[g_NormalOffset   + IndexOfComponent]);
+			}
+
+			Key.m_Bits[6] = GetWeldBits(pVertex[g_TexCoordOffset + 0]);
+			Key.m_Bits[7] = GetWeldBits(pVertex[g_TexCoordOffset + 1]);
+			Key.m_Bits[8] = 0;
+
+			SharedVertices[IndexOfVertex] = SharedVertexMap.insert(std::make_pair(Key, IndexOfVertex)).first->second;
+		}
+
+		std::vector<int> Triangles;
+		std::vector<int> DegenerateTriangles;
+		std::vector<int> Corners;
+
+		for(int IndexOfTriangle = 0; IndexOfTriangle < NumberOfTriangles; ++ IndexOfTriangle)
+		{
+			const float* pP0 = &_pVertices[_pIndices[IndexOfTriangle * 3 + 0] * g_NumberOfFloatsPerImportedVertex + g_PositionOffset];
+			const float* pP1 = &_pVertices[_pIndices[IndexOfTriangle * 3 + 1] * g_NumberOfFloatsPerImportedVertex + g_PositionOffset];
+			const float* pP2 = &_pVertices[_pIndices[IndexOfTriangle * 3 + 2] * g_NumberOfFloatsPerImportedVertex + g_PositionOffset];
+
+			bool IsDegenerate = (pP0[0] == pP1[0] && pP0[1] == pP1[1] && pP0[2] == pP1[2])
+			                 || (pP0[0] == pP2[0] && pP0[1] == pP2[1] && pP0[2] == pP2[2])
+			                 || (pP1[0] == pP2[0] && pP1[1] == pP2[1] && pP1[2] == pP2[2]);
+
+			if(IsDegenerate)
+			{
+				DegenerateTriangles.push_back(IndexOfTriangle);
+
+				continue;
+			}
+
+			Triangles.push_back(IndexOfTriangle);
+
+			for(int Corner = 0; Corner < 3; ++ Corner)
+			{
+				Corners.push_back(SharedVertices[_pIndices[IndexOfTriangle * 3 + Corner]]);
+			}
+		}
+
+		int NumberOfGoodTriangles = static_cast<int>(Triangles.size());
+
+		std::vector<SMikkTriangle> TriangleInfos(NumberOfGoodTriangles);
+
+		// -----------------------------------------------------------------------------
+		// The unit tangents of each triangle. They point along decreasing texture
+		// coordinates on triangles which reverse the orientation of the texture.
+		// -----------------------------------------------------------------------------
+		ParallelFor(NumberOfGoodTriangles, _NumberOfThreads, [&](int _Begin, int _End)
+		{
+			for(int IndexOfTriangle = _Begin; IndexOfTriangle < _End; ++ IndexOfTriangle)
+			{
+				SMikkTriangle& rTriangle = TriangleInfos[IndexOfTriangle];
+
+				const float* pV0 = &_pVertices[Corners[IndexOfTriangle * 3 + 0] * g_NumberOfFloatsPerImportedVertex];
+				const float* pV1 = &_pVertices[Corners[IndexOfTriangle * 3 + 1] * g_NumberOfFloatsPerImportedVertex];
+				const float* pV2 = &_pVertices[Corners[IndexOfTriangle * 3 + 2] * g_NumberOfFloatsPerImportedVertex];
+
+				float Edge1[3];
+				float Edge2[3];
+
+				Subtract(pV1 + g_PositionOffset, pV0 + g_PositionOffset, Edge1);
+				Subtract(pV2 + g_PositionOffset, pV0 + g_PositionOffset, Edge2);
+
+				float DeltaU1 = pV1[g_TexCoordOffset + 0] - pV0[g_TexCoordOffset + 0];
+				float DeltaV1 = pV1[g_TexCoordOffset + 1] - pV0[g_TexCoordOffset + 1];
+				float DeltaU2 = pV2[g_TexCoordOffset + 0] - pV0[g_TexCoordOffset + 0];
+				float DeltaV2 = pV2[g_TexCoordOffset + 1] - pV0[g_TexCoordOffset + 1];
+
+				float SignedArea = DeltaU1 * DeltaV2 - DeltaV1 * DeltaU2;
+				float TangentS[3];
+				float TangentT[3];
+
+				for(int Axis = 0; Axis < 3; ++ Axis)
+				{
+					TangentS[Axis] = DeltaV2 * Edge1[Axis] - DeltaV1 * Edge2[Axis];
+					TangentT[Axis] = -DeltaU2 * Edge1[Axis] + DeltaU1 * Edge2[Axis];
+
+					rTriangle.m_TangentS[Axis] = 0.0f;
+					rTriangle.m_TangentT[Axis] = 0.0f;
+				}
+
+				rTriangle.m_Neighbors[0] = rTriangle.m_Neighbors[1] = rTriangle.m_Neighbors[2] = -1;
+				rTriangle.m_Groups   [0] = rTriangle.m_Groups   [1] = rTriangle.m_Groups   [2] = -1;
+
+				rTriangle.m_Flags = g_MikkGroupWithAny | (SignedArea > 0.0f ? g_MikkOrientPreserving : 0);
+
+				if(fabsf(SignedArea) > FLT_MIN)
+				{
+					float LengthS = GetLength(TangentS);
+					float LengthT = GetLength(TangentT);
+					float Sign    = SignedArea > 0.0f ? 1.0f : -1.0f;
+
+					for(int Axis = 0; Axis < 3 && fabsf(LengthS) > FLT_MIN; ++ Axis)
+					{
+						rTriangle.m_TangentS[Axis] = TangentS[Axis] * (Sign / LengthS);
+					}
+
+					for(int Axis = 0; Axis < 3 && fabsf(LengthT) > FLT_MIN; ++ Axis)
+					{
+						rTriangle.m_TangentT[Axis] = TangentT[Axis] * (Sign / LengthT);
+					}
+
+					if(fabsf(LengthS / fabsf(SignedArea)) > FLT_MIN && fabsf(LengthT / fabsf(SignedArea)) > FLT_MIN)
+					{
+						rTriangle.m_Flags &= ~g_MikkGroupWithAny;
+					}
+				}
+			}
+		});
+
+		// -----------------------------------------------------------------------------
+		// Connect the triangles over their edges. An edge used by more than two
+		// triangles pairs the first ones in triangle order which run it in opposite
+		// directions.
+		// -----------------------------------------------------------------------------
+		std::vector<SMikkEdge> Edges(NumberOfGoodTriangles * 3);
+
+		for(int IndexOfTriangle = 0; IndexOfTriangle < NumberOfGoodTriangles; ++ IndexOfTriangle)
+		{
+			for(int Corner = 0; Corner < 3; ++ Corner)
+			{
+				int Vertex0 = Corners[IndexOfTriangle * 3 + Corner];
+				int Vertex1 = Corners[IndexOfTriangle * 3 + (Corner + 1) % 3];
+
+				SMikkEdge& rEdge = Edges[IndexOfTriangle * 3 + Corner];
+
+				rEdge.m_Index0   = std::min(Vertex0, Vertex1);
+				rEdge.m_Index1   = std::max(Vertex0, Vertex1);
+				rEdge.m_Triangle = IndexOfTriangle;
+			}
+		}
+
+		std::sort(Edges.begin(), Edges.end());
+
+		for(size_t IndexOfEdge = 0; IndexOfEdge < Edges.size(); ++ IndexOfEdge)
+		{
+			const SMikkEdge& rEdge    = Edges[IndexOfEdge];
+			const int*       pCorners = &Corners[rEdge.m_Triangle * 3];
+
+			int CornerA = FindCorner(pCorners, rEdge.m_Index0);
+			int EdgeA   = pCorners[(CornerA + 1) % 3] == rEdge.m_Index1 ? CornerA : (CornerA + 2) % 3;
+
+			if(TriangleInfos[rEdge.m_Triangle].m_Neighbors[EdgeA] != -1)
+			{
+				continue;
+			}
+
+			for(size_t IndexOfOther = IndexOfEdge + 1; IndexOfOther < Edges.size() && Edges[IndexOfOther].m_Index0 == rEdge.m_Index0 && Edges[IndexOfOther].m_Index1 == rEdge.m_Index1; ++ IndexOfOther)
+			{
+				int        Other          = Edges[IndexOfOther].m_Triangle;
+				const int* pOtherCorners  = &Corners[Other * 3];
+				int        CornerB        = FindCorner(pOtherCorners, rEdge.m_Index0);
+				int        EdgeB          = pOtherCorners[(CornerB + 1) % 3] == rEdge.m_Index1 ? CornerB : (CornerB + 2) % 3;
+
+				// Both triangles have to run the edge in opposite directions.
+				if(pOtherCorners[EdgeB] != pCorners[EdgeA] && TriangleInfos[Other].m_Neighbors[EdgeB] == -1)
+				{
+					TriangleInfos[rEdge.m_Triangle].m_Neighbors[EdgeA] = Other;
+					TriangleInfos[Other           ].m_Neighbors[EdgeB] = rEdge.m_Triangle;
+
+					break;
+				}
+			}
+		}
+
+		// -----------------------------------------------------------------------------
+		// Build the groups in triangle and corner order. A triangle is in at most
+		// three groups, one per corner.
+		// -----------------------------------------------------------------------------
+		std::vector<SMikkGroup> Groups;
+		std::vector<int>        GroupTriangles(NumberOfGoodTriangles * 3);
+		std::vector<int>        Stack;
+		int                     NumberOfGroupTriangles = 0;
+
+		for(int IndexOfTriangle = 0; IndexOfTriangle < NumberOfGoodTriangles; ++ IndexOfTriangle)
+		{
+			SMikkTriangle& rTriangle = TriangleInfos[IndexOfTriangle];
+
+			for(int Corner = 0; Corner < 3; ++ Corner)
+			{
+				if((rTriangle.m_Flags & g_MikkGroupWithAny) != 0 || rTriangle.m_Groups[Corner] != -1)
+				{
+					continue;
+				}
+
+				SMikkGroup Group;
+
+				Group.m_Vertex             = Corners[IndexOfTriangle * 3 + Corner];
+				Group.m_IsOrientPreserving = (rTriangle.m_Flags & g_MikkOrientPreserving) != 0;
+				Group.m_FirstTriangle      = NumberOfGroupTriangles;
+				Group.m_NumberOfTriangles  = 0;
+
+				Stack.assign(1, IndexOfTriangle);
+
+				GrowMikkGroup(Corners.data(), TriangleInfos, static_cast<int>(Groups.size()), Group, GroupTriangles, Stack);
+
+				NumberOfGroupTriangles += Group.m_NumberOfTriangles;
+
+				Groups.push_back(Group);
+			}
+		}
+
+		// -----------------------------------------------------------------------------
+		// Every corner of a group sums the triangles whose tangents are less than the
+		// angular threshold of 180 degrees apart from its own, which in practice are
+		// all of the group. Corners with the same set share the result.
+		// -----------------------------------------------------------------------------
+		const float Pi        = 3.14159265358979323846f;
+		const float Threshold = static_cast<float>(cos((180.0f * Pi) / 180.0f));
+
+		ParallelFor(static_cast<int>(Groups.size()), _NumberOfThreads, [&](int _Begin, int _End)
+		{
+			std::vector<std::vector<int>> SubGroups;
+			std::vector<SCornerFrame>     SubGroupFrames;
+			std::vector<int>              Members;
+
+			for(int IndexOfGroup = _Begin; IndexOfGroup < _End; ++ IndexOfGroup)
+			{
+				const SMikkGroup& rGroup = Groups[IndexOfGroup];
+
+				const float* pNormal = &_pVertices[rGroup.m_Vertex * g_NumberOfFloatsPerImportedVertex + g_NormalOffset];
+
+				SubGroups     .clear();
+				SubGroupFrames.clear();
+
+				for(int IndexOfMember = 0; IndexOfMember < rGroup.m_NumberOfTriangles; ++ IndexOfMember)
+				{
+					int                  IndexOfTriangle = GroupTriangles[rGroup.m_FirstTriangle + IndexOfMember];
+					const SMikkTriangle& rTriangle       = TriangleInfos[IndexOfTriangle];
+
+					float TangentS[3];
+					float TangentT[3];
+
+					ProjectIntoTangentPlane(pNormal, rTriangle.m_TangentS, TangentS);
+					ProjectIntoTangentPlane(pNormal, rTriangle.m_TangentT, TangentT);
+
+					Members.clear();
+
+					for(int IndexOfOther = 0; IndexOfOther < rGroup.m_NumberOfTriangles; ++ IndexOfOther)
+					{
+						int                  Other       = GroupTriangles[rGroup.m_FirstTriangle + IndexOfOther];
+						const SMikkTriangle& rOther      = TriangleInfos[Other];
+
+						float OtherS[3];
+						float OtherT[3];
+
+						ProjectIntoTangentPlane(pNormal, rOther.m_TangentS, OtherS);
+						ProjectIntoTangentPlane(pNormal, rOther.m_TangentT, OtherT);
+
+						bool IsAny = ((rTriangle.m_Flags | rOther.m_Flags) & g_MikkGroupWithAny) != 0;
+
+						if(IsAny || Other == IndexOfTriangle || (GetDotProduct3D(TangentS, OtherS) > Threshold && GetDotProduct3D(TangentT, OtherT) > Threshold))
+						{
+							Members.push_back(Other);
+						}
+					}
+
+					std::sort(Members.begin(), Members.end());
+
+					size_t IndexOfSubGroup = std::find(SubGroups.begin(), SubGroups.end(), Members) - SubGroups.begin();
+
+					if(IndexOfSubGroup == SubGroups.size())
+					{
+						SCornerFrame Frame;
+
+						EvaluateMikkTangent(_pVertices, Corners.data(), TriangleInfos, Members, rGroup.m_Vertex, Frame.m_Tangent);
+
+						Frame.m_Sign = rGroup.m_IsOrientPreserving ? 1.0f : -1.0f;
+
+						SubGroups     .push_back(Members);
+						SubGroupFrames.push_back(Frame);
+					}
+
+					int Corner = FindCorner(&Corners[IndexOfTriangle * 3], rGroup.m_Vertex);
+
+					_rFrames[Triangles[IndexOfTriangle] * 3 + Corner] = SubGroupFrames[IndexOfSubGroup];
+				}
+			}
+		});
+
+		// -----------------------------------------------------------------------------
+		// The corners of degenerate triangles copy the frame of the first good corner
+		// using the same shared vertex.
+		// -----------------------------------------------------------------------------
+		std::unordered_map<int, int> FirstGoodCorners;
+
+		for(int IndexOfCorner = NumberOfGoodTriangles * 3 - 1; IndexOfCorner >= 0; -- IndexOfCorner)
+		{
+			FirstGoodCorners[Corners[IndexOfCorner]] = Triangles[IndexOfCorner / 3] * 3 + IndexOfCorner % 3;
+		}
+
+		for(int IndexOfTriangle : DegenerateTriangles)
+		{
+			for(int Corner = 0; Corner < 3; ++ Corner)
+			{
+				std::unordered_map<int, int>::const_iterator Source = FirstGoodCorners.find(SharedVertices[_pIndices[IndexOfTriangle * 3 + Corner]]);
+
+				if(Source != FirstGoodCorners.end())
+				{
+					_rFrames[IndexOfTriangle * 3 + Corner] = _rFrames[Source->second];
+				}
+			}
+		}
+
+		int NumberOfUnusedTriangles = static_cast<int>(DegenerateTriangles.size());
+
+		for(const SMikkTriangle& rTriangle : TriangleInfos)
+		{
+			NumberOfUnusedTriangles += (rTriangle.m_Flags & g_MikkGroupWithAny) != 0 ? 1 : 0;
+		}
+
+		return NumberOfUnusedTriangles;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Writes the frame of a corner into the vertex, the binormal is reconstructed
+	// the way MikkTSpace defines it.
+	// -----------------------------------------------------------------------------
+	void SetTangentFrame(float* _pVertex, const SCornerFrame& _rFrame, bool _FlipBinormal)
+	{
+		float* pTangent  = _pVertex + g_TangentOffset;
+		float* pBinormal = _pVertex + g_BinormalOffset;
+
+		pTangent[0] = _rFrame.m_Tangent[0]; pTangent[1] = _rFrame.m_Tangent[1]; pTangent[2] = _rFrame.m_Tangent[2];
+
+		GetCrossProduct(_pVertex + g_NormalOffset, pTangent, pBinormal);
+
+		float Sign = _FlipBinormal ? -_rFrame.m_Sign : _rFrame.m_Sign;
+
+		pBinormal[0] *= Sign;
+		pBinormal[1] *= Sign;
+		pBinormal[2] *= Sign;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Minimal JSON document model, just enough to read the glTF header.
+	// -----------------------------------------------------------------------------
+	struct SJsonValue
+	{
+		enum EType
+		{
+			Null,
+			Bool,
+			Number,
+			String,
+			Array,
+			Object,
+		};
+
+		SJsonValue() : m_Type(Null), m_Number(0.0) {}
+
+		EType                                           m_Type;
+		double                                          m_Number;
+		std::string                                     m_String;
+		std::vector<SJsonValue>                         m_Array;
+		std::vector<std::pair<std::string, SJsonValue>> m_Object;
+
+		const SJsonValue* Find(const char* _pKey) const
+		{
+			for(const std::pair<std::string, SJsonValue>& rMember : m_Object)
+			{
+				if(rMember.first == _pKey)
+				{
+					return &rMember.second;
+				}
+			}
+
+			return nullptr;
+		}
+
+		int GetInt(const char* _pKey, int _Default) const
+		{
+			const SJsonValue* pValue = Find(_pKey);
+
+			return pValue != nullptr && pValue->m_Type == Number ? static_cast<int>(pValue->m_Number) : _Default;
+		}
+
+		bool GetBool(const char* _pKey, bool _Default) const
+		{
+			const SJsonValue* pValue = Find(_pKey);
+
+			return pValue != nullptr && pValue->m_Type == Bool ? pValue->m_Number != 0.0 : _Default;
+		}
+
+		const SJsonValue* GetElement(const char* _pArrayKey, int _Index) const
+		{
+			const SJsonValue* pArray = Find(_pArrayKey);
+
+			if(pArray == nullptr || pArray->m_Type != Array || _Index < 0 || _Index >= static_cast<int>(pArray->m_Array.size()))
+			{
+				return nullptr;
+			}
+
+			return &pArray->m_Array[_Index];
+		}
+	};
+
+	class CJsonParser
+	{
+	public:
+
+		CJsonParser(const char* _pBegin, const char* _pEnd) : m_pCurrent(_pBegin), m_pEnd(_pEnd) {}
+
+	public:
+
+		bool Parse(SJsonValue& _rValue)
+		{
+			return ParseValue(_rValue);
+		}
+
+	private:
+
+		void SkipWhitespace()
+		{
+			while(m_pCurrent < m_pEnd && (*m_pCurrent == ' ' || *m_pCurrent == '\t' || *m_pCurrent == '\n' || *m_pCurrent == '\r'))
+			{
+				++ m_pCurrent;
+			}
+		}
+
+		bool Expect(char _Character)
+		{
+			SkipWhitespace();
+
+			if(m_pCurrent >= m_pEnd || *m_pCurrent != _Character)
+			{
+				return false;
+			}
+
+			++ m_pCurrent;
+
+			return true;
+		}
+
+		bool ParseString(std::string& _rString)
+		{
+			if(!Expect('"'))
+			{
+				return false;
+			}
+
+			while(m_pCurrent < m_pEnd && *m_pCurrent != '"')
+			{
+				if(*m_pCurrent == '\\' && m_pCurrent + 1 < m_pEnd)
+				{
+					++ m_pCurrent;
+
+					// Escapes never occur in the keys and names we look at, so keep
+					// them simple and drop unicode escapes.
+					switch(*m_pCurrent)
+					{
+						case 'n': _rString += '\n'; break;
+						case 't': _rString += '\t'; break;
+						case 'u': m_pCurrent += m_pEnd - m_pCurrent > 4 ? 4 : 0; break;
+						default:  _rString += *m_pCurrent; break;
+					}
+				}
+				else
+				{
+					_rString += *m_pCurrent;
+				}
+
+				++ m_pCurrent;
+			}
+
+			return Expect('"');
+		}
+
+		bool ParseValue(SJsonValue& _rValue)
+		{
+			SkipWhitespace();
+
+			if(m_pCurrent >= m_pEnd)
+			{
+				return false;
+			}
+
+			switch(*m_pCurrent)
+			{
+				case '{':
+				{
+					_rValue.m_Type = SJsonValue::Object;
+
+					++ m_pCurrent;
+
+					if(Expect('}'))
+					{
+						return true;
+					}
+
+					do
+					{
+						_rValue.m_Object.push_back(std::make_pair(std::string(), SJsonValue()));
+
+						if(!ParseString(_rValue.m_Object.back().first) || !Expect(':') || !ParseValue(_rValue.m_Object.back().second))
+						{
+							return false;
+						}
+					}
+					while(Expect(','));
+
+					return Expect('}');
+				}
+
+				case '[':
+				{
+					_rValue.m_Type = SJsonValue::Array;
+
+					++ m_pCurrent;
+
+					if(Expect(']'))
+					{
+						return true;
+					}
+
+					do
+					{
+						_rValue.m_Array.push_back(SJsonValue());
+
+						if(!ParseValue(_rValue.m_Array.back()))
+						{
+							return false;
+						}
+					}
+					while(Expect(','));
+
+					return Expect(']');
+				}
+
+				case '"':
+				{
+					_rValue.m_Type = SJsonValue::String;
+
+					return ParseString(_rValue.m_String);
+				}
+
+				case 't':
+				case 'f':
+				case 'n':
+				{
+					const char* pWord = *m_pCurrent == 't' ? "true" : (*m_pCurrent == 'f' ? "false" : "null");
+					size_t      Length = strlen(pWord);
+
+					if(static_cast<size_t>(m_pEnd - m_pCurrent) < Length || strncmp(m_pCurrent, pWord, Length) != 0)
+					{
+						return false;
+					}
+
+					_rValue.m_Type   = *pWord == 'n' ? SJsonValue::Null : SJsonValue::Bool;
+					_rValue.m_Number = *pWord == 't' ? 1.0 : 0.0;
+
+					m_pCurrent += Length;
+
+					return true;
+				}
+
+				default:
+				{
+					char* pEnd;
+
+					_rValue.m_Type   = SJsonValue::Number;
+					_rValue.m_Number = strtod(m_pCurrent, &pEnd);
+
+					if(pEnd == m_pCurrent)
+					{
+						return false;
+					}
+
+					m_pCurrent = pEnd;
+
+					return true;
+				}
+			}
+		}
+
+	private:
+
+		const char* m_pCurrent;
+		const char* m_pEnd;
+	};
+
+	// -----------------------------------------------------------------------------
+	// Describes where the elements of a glTF accessor live in a binary file.
+	// -----------------------------------------------------------------------------
+	struct SAccessorView
+	{
+		int      m_Count;                   // The number of elements.
+		int      m_NumberOfComponents;      // 1 for scalars, 2 for VEC2, 3 for VEC3, ...
+		int      m_ComponentType;           // The glTF component type (5120, 5121, 5122, 5123, 5125 or 5126).
+		int      m_ComponentSize;           // The size of one component in bytes.
+		bool     m_IsNormalized;            // Integer components are mapped to [0, 1] or [-1, 1].
+		int      m_Stride;                  // The distance between two elements in bytes.
+		uint64_t m_FileOffset;              // The absolute file offset of the first element.
+	};
+
+	int GetComponentSize(int _ComponentType)
+	{
+		switch(_ComponentType)
+		{
+			case 5120: case 5121: return 1;
+			case 5122: case 5123: return 2;
+			case 5125: case 5126: return 4;
+			default:              return 0;
+		}
+	}
+
+	int GetNumberOfComponents(const std::string& _rType)
+	{
+		if(_rType == "SCALAR") return 1;
+		if(_rType == "VEC2")   return 2;
+		if(_rType == "VEC3")   return 3;
+		if(_rType == "VEC4")   return 4;
+
+		return 0;
+	}
+
+	bool GetAccessorView(const SJsonValue& _rDocument, int _IndexOfAccessor, uint64_t _BufferFileOffset, SAccessorView& _rView)
+	{
+		const SJsonValue* pAccessor = _rDocument.GetElement("accessors", _IndexOfAccessor);
+
+		if(pAccessor == nullptr)
+		{
+			return false;
+		}
+
+		const SJsonValue* pType       = pAccessor->Find("type");
+		const SJsonValue* pBufferView = _rDocument.GetElement("bufferViews", pAccessor->GetInt("bufferView", -1));
+
+		if(pType == nullptr || pBufferView == nullptr || pBufferView->GetInt("buffer", 0) != 0 || pAccessor->Find("sparse") != nullptr)
+		{
+			return false;
+		}
+
+		_rView.m_Count              = pAccessor->GetInt("count", 0);
+		_rView.m_NumberOfComponents = GetNumberOfComponents(pType->m_String);
+		_rView.m_ComponentType      = pAccessor->GetInt("componentType", 0);
+		_rView.m_ComponentSize      = GetComponentSize(_rView.m_ComponentType);
+		_rView.m_IsNormalized       = pAccessor->GetBool("normalized", false);
+		_rView.m_Stride             = pBufferView->GetInt("byteStride", _rView.m_NumberOfComponents * _rView.m_ComponentSize);
+		_rView.m_FileOffset         = _BufferFileOffset + static_cast<uint64_t>(pBufferView->GetInt("byteOffset", 0)) + static_cast<uint64_t>(pAccessor->GetInt("byteOffset", 0));
+
+		return _rView.m_NumberOfComponents > 0 && _rView.m_ComponentSize > 0;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Reads the elements [_Begin, _Begin + _Count) of an accessor from the stream
+	// and converts every component to float. Normalized integers follow the glTF
+	// rules, signed ones are clamped to -1 as their minimum is one step below.
+	// -----------------------------------------------------------------------------
+	bool ReadAccessor(std::ifstream& _rStream, const SAccessorView& _rView, int _Begin, int _Count, std::vector<float>& _rValues)
+	{
+		std::vector<unsigned char> Bytes;
+
+		if(_Count <= 0)
+		{
+			_rValues.clear();
+
+			return true;
+		}
+
+		Bytes.resize(static_cast<size_t>(_Count - 1) * _rView.m_Stride + _rView.m_NumberOfComponents * _rView.m_ComponentSize);
+
+		_rStream.clear();
+		_rStream.seekg(static_cast<std::streamoff>(_rView.m_FileOffset + static_cast<uint64_t>(_Begin) * _rView.m_Stride));
+		_rStream.read(reinterpret_cast<char*>(Bytes.data()), static_cast<std::streamsize>(Bytes.size()));
+
+		if(!_rStream)
+		{
+			return false;
+		}
+
+		_rValues.resize(static_cast<size_t>(_Count) * _rView.m_NumberOfComponents);
+
+		for(int IndexOfElement = 0; IndexOfElement < _Count; ++ IndexOfElement)
+		{
+			const unsigned char* pElement = &Bytes[static_cast<size_t>(IndexOfElement) * _rView.m_Stride];
+
+			for(int IndexOfComponent = 0; IndexOfComponent < _rView.m_NumberOfComponents; ++ IndexOfComponent)
+			{
+				const unsigned char* pComponent = pElement + IndexOfComponent * _rView.m_ComponentSize;
+				float                Value;
+
+				switch(_rView.m_ComponentType)
+				{
+					case 5120: { int8_t   Byte;  memcpy(&Byte,  pComponent, 1); Value = static_cast<float>(Byte);  break; }
+					case 5121: Value = static_cast<float>(*pComponent); break;
+					case 5122: { int16_t  Short; memcpy(&Short, pComponent, 2); Value = static_cast<float>(Short); break; }
+					case 5123: { uint16_t Short; memcpy(&Short, pComponent, 2); Value = static_cast<float>(Short); break; }
+					case 5125: { uint32_t Int;   memcpy(&Int,   pComponent, 4); Value = static_cast<float>(Int);   break; }
+					case 5126: memcpy(&Value, pComponent, 4); break;
+					default:   Value = 0.0f; break;
+				}
+
+				if(_rView.m_IsNormalized)
+				{
+					switch(_rView.m_ComponentType)
+					{
+						case 5120: Value = std::max(Value / 127.0f,   -1.0f); break;
+						case 5121: Value = Value / 255.0f; break;
+						case 5122: Value = std::max(Value / 32767.0f, -1.0f); break;
+						case 5123: Value = Value / 65535.0f; break;
+						default:   break;
+					}
+				}
+
+				_rValues[static_cast<size_t>(IndexOfElement) * _rView.m_NumberOfComponents + IndexOfComponent] = Value;
+			}
+		}
+
+		return true;
+	}
+
+	// Indices have to stay exact, so they are not passed through floats.
+	bool ReadIndices(std::ifstream& _rStream, const SAccessorView& _rView, int _Begin, int _Count, std::vector<uint32_t>& _rIndices)
+	{
+		std::vector<unsigned char> Bytes(static_cast<size_t>(_Count) * _rView.m_Stride);
+
+		_rStream.clear();
+		_rStream.seekg(static_cast<std::streamoff>(_rView.m_FileOffset + static_cast<uint64_t>(_Begin) * _rView.m_Stride));
+		_rStream.read(reinterpret_cast<char*>(Bytes.data()), static_cast<std::streamsize>(Bytes.size() - (_rView.m_Stride - _rView.m_ComponentSize)));
+
+		if(!_rStream)
+		{
+			return false;
+		}
+
+		_rIndices.resize(_Count);
+
+		for(int IndexOfElement = 0; IndexOfElement < _Count; ++ IndexOfElement)
+		{
+			const unsigned char* pElement = &Bytes[static_cast<size_t>(IndexOfElement) * _rView.m_Stride];
+
+			switch(_rView.m_ComponentSize)
+			{
+				case 1:  _rIndices[IndexOfElement] = *pElement; break;
+				case 2:  { uint16_t Short; memcpy(&Short, pElement, 2); _rIndices[IndexOfElement] = Short; break; }
+				default: memcpy(&_rIndices[IndexOfElement], pElement, 4); break;
+			}
+		}
+
+		return true;
+	}
+
+	std::string GetDirectory(const std::string& _rPath)
+	{
+		size_t Separator = _rPath.find_last_of("\\/");
+
+		return Separator == std::string::npos ? std::string() : _rPath.substr(0, Separator + 1);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Streams all triangle primitives of all meshes of a glTF document into the
+	// welder. Node transforms are not applied, the meshes stay in their own space.
+	// -----------------------------------------------------------------------------
+	bool ReadGLTFMeshes(const SJsonValue& _rDocument, std::ifstream& _rBinary, uint64_t _BufferFileOffset, CMeshWelder& _rWelder)
+	{
+		const SJsonValue* pMeshes = _rDocument.Find("meshes");
+
+		if(pMeshes == nullptr || pMeshes->m_Type != SJsonValue::Array)
+		{
+			std::cout << "glTF file does not contain any meshes" << std::endl;
+
+			return false;
+		}
+
+		for(const SJsonValue& rMesh : pMeshes->m_Array)
+		{
+			const SJsonValue* pPrimitives = rMesh.Find("primitives");
+
+			if(pPrimitives == nullptr)
+			{
+				continue;
+			}
+
+			for(const SJsonValue& rPrimitive : pPrimitives->m_Array)
+			{
+				const SJsonValue* pAttributes = rPrimitive.Find("attributes");
+
+				SAccessorView PositionView;
+				SAccessorView NormalView;
+				SAccessorView TexCoordView;
+				SAccessorView IndexView;
+
+				std::vector<float>    Positions;
+				std::vector<float>    Normals;
+				std::vector<float>    TexCoords;
+				std::vector<uint32_t> Indices;
+
+				// Only triangle lists are supported.
+				if(rPrimitive.GetInt("mode", 4) != 4 || pAttributes == nullptr)
+				{
+					continue;
+				}
+
+				if(!GetAccessorView(_rDocument, pAttributes->GetInt("POSITION", -1), _BufferFileOffset, PositionView) || PositionView.m_NumberOfComponents != 3)
+				{
+					std::cout << "glTF primitive without readable positions skipped" << std::endl;
+
+					continue;
+				}
+
+				bool HasNormals   = GetAccessorView(_rDocument, pAttributes->GetInt("NORMAL",     -1), _BufferFileOffset, NormalView);
+				bool HasTexCoords = GetAccessorView(_rDocument, pAttributes->GetInt("TEXCOORD_0", -1), _BufferFileOffset, TexCoordView);
+				bool HasIndices   = GetAccessorView(_rDocument, rPrimitive.GetInt("indices", -1), _BufferFileOffset, IndexView);
+
+				// The vertex attributes are addressed randomly by the indices, so they
+				// are kept per primitive. The index stream is read in chunks.
+				if(!ReadAccessor(_rBinary, PositionView, 0, PositionView.m_Count, Positions)
+				|| (HasNormals   && !ReadAccessor(_rBinary, NormalView,   0, NormalView.m_Count,   Normals))
+				|| (HasTexCoords && !ReadAccessor(_rBinary, TexCoordView, 0, TexCoordView.m_Count, TexCoords)))
+				{
+					std::cout << "glTF buffer is truncated" << std::endl;
+
+					return false;
+				}
+
+				int NumberOfCorners = HasIndices ? IndexView.m_Count : PositionView.m_Count;
+
+				for(int FirstCorner = 0; FirstCorner + 2 < NumberOfCorners; FirstCorner += g_NumberOfTrianglesPerChunk * 3)
+				{
+					int NumberOfChunkCorners = std::min(g_NumberOfTrianglesPerChunk * 3, NumberOfCorners - FirstCorner) / 3 * 3;
+
+					if(HasIndices)
+					{
+						if(!ReadIndices(_rBinary, IndexView, FirstCorner, NumberOfChunkCorners, Indices))
+						{
+							std::cout << "glTF index buffer is truncated" << std::endl;
+
+							return false;
+						}
+					}
+
+					for(int IndexOfCorner = 0; IndexOfCorner < NumberOfChunkCorners; IndexOfCorner += 3)
+					{
+						SCorner Corners[3];
+						bool    IsValid = true;
+
+						for(int Corner = 0; Corner < 3; ++ Corner)
+						{
+							uint32_t IndexOfVertex = HasIndices ? Indices[IndexOfCorner + Corner] : static_cast<uint32_t>(FirstCorner + IndexOfCorner + Corner);
+
+							if(IndexOfVertex >= static_cast<uint32_t>(PositionView.m_Count))
+							{
+								IsValid = false;
+
+								break;
+							}
+
+							memset(&Corners[Corner], 0, sizeof(SCorner));
+							memcpy(Corners[Corner].m_Position, &Positions[IndexOfVertex * 3], 3 * sizeof(float));
+
+							if(HasNormals && IndexOfVertex < static_cast<uint32_t>(NormalView.m_Count))
+							{
+								memcpy(Corners[Corner].m_Normal, &Normals[IndexOfVertex * 3], 3 * sizeof(float));
+							}
+
+							if(HasTexCoords && IndexOfVertex < static_cast<uint32_t>(TexCoordView.m_Count))
+							{
+								memcpy(Corners[Corner].m_TexCoord, &TexCoords[IndexOfVertex * 2], 2 * sizeof(float));
+							}
+						}
+
+						if(!IsValid)
+						{
+							continue;
+						}
+
+						// glTF is right handed, YoshiX is left handed. Mirroring z keeps the
+						// counter-clockwise winding as seen by the mirrored camera.
+						for(int Corner = 0; Corner < 3; ++ Corner)
+						{
+							Corners[Corner].m_Position[2] = -Corners[Corner].m_Position[2];
+							Corners[Corner].m_Normal  [2] = -Corners[Corner].m_Normal  [2];
+						}
+
+						_rWelder.AddTriangle(Corners);
+					}
+				}
+			}
+		}
+
+		return true;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Helpers to read the numbers of an OBJ line without creating strings.
+	// -----------------------------------------------------------------------------
+	const char* SkipSpaces(const char* _pText)
+	{
+		while(*_pText == ' ' || *_pText == '\t')
+		{
+			++ _pText;
+		}
+
+		return _pText;
+	}
+
+	int ReadFloats(const char* _pText, float* _pValues, int _MaxNumberOfValues)
+	{
+		int NumberOfValues = 0;
+
+		while(NumberOfValues < _MaxNumberOfValues)
+		{
+			char* pEnd;
+
+			float Value = strtof(_pText, &pEnd);
+
+			if(pEnd == _pText)
+			{
+				break;
+			}
+
+			_pValues[NumberOfValues ++] = Value;
+			_pText = pEnd;
+		}
+
+		return NumberOfValues;
+	}
+
+	// Resolves a one based or negative (relative) OBJ index to a zero based index.
+	int ResolveOBJIndex(long _Index, size_t _NumberOfElements)
+	{
+		if(_Index > 0)
+		{
+			return _Index <= static_cast<long>(_NumberOfElements) ? static_cast<int>(_Index - 1) : -1;
+		}
+
+		if(_Index < 0)
+		{
+			return -_Index <= static_cast<long>(_NumberOfElements) ? static_cast<int>(_NumberOfElements + _Index) : -1;
+		}
+
+		return -1;
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+SImportSettings::SImportSettings()
+	: m_NumberOfThreads(0)
+	, m_Scale          (1.0f)
+	, m_FlipTexCoordV  (false)
+	, m_FlipBinormal   (false)              // Matches the hand made tangent frames of the billboard quad.
+	, m_GenerateNormals(false)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+int SImportedMesh::GetNumberOfVertices() const
+{
+	return static_cast<int>(m_Vertices.size() / g_NumberOfFloatsPerImportedVertex);
+}
+
+// -----------------------------------------------------------------------------
+
+int SImportedMesh::GetNumberOfIndices() const
+{
+	return static_cast<int>(m_Indices.size());
+}
+
+// -----------------------------------------------------------------------------
+
+void SImportedMesh::GetMeshInfo(BHandle _pMaterial, SMeshInfo& _rMeshInfo)
+{
+	_rMeshInfo.m_pVertices        = m_Vertices.data();
+	_rMeshInfo.m_NumberOfVertices = GetNumberOfVertices();
+	_rMeshInfo.m_pIndices         = m_Indices.data();
+	_rMeshInfo.m_NumberOfIndices  = GetNumberOfIndices();
+	_rMeshInfo.m_pMaterial        = _pMaterial;
+}
+
+// -----------------------------------------------------------------------------
+
+void GenerateTangentFrames(float* _pVertices, int _NumberOfVertices, const int* _pIndices, int _NumberOfIndices, const SImportSettings& _rSettings, int* _pNumberOfDegenerateUVs)
+{
+	SVertexTriangles          VertexTriangles;
+	std::vector<SCornerFrame> Frames;
+
+	int NumberOfUnusedTriangles = GenerateCornerFrames(_pVertices, _NumberOfVertices, _pIndices, _NumberOfIndices, _rSettings.m_NumberOfThreads, Frames);
+
+	BuildVertexTriangles(_NumberOfVertices, _pIndices, _NumberOfIndices / 3 * 3, VertexTriangles);
+
+	// -----------------------------------------------------------------------------
+	// Each vertex takes the frame of its first corner. Vertices which are not used
+	// by any triangle get the default frame.
+	// -----------------------------------------------------------------------------
+	ParallelFor(_NumberOfVertices, _rSettings.m_NumberOfThreads, [&](int _Begin, int _End)
+	{
+		SCornerFrame DefaultFrame = { { 1.0f, 0.0f, 0.0f }, -1.0f };
+
+		for(int IndexOfVertex = _Begin; IndexOfVertex < _End; ++ IndexOfVertex)
+		{
+			int FirstEntry = VertexTriangles.m_Offsets[IndexOfVertex];
+
+			bool IsUsed = FirstEntry < VertexTriangles.m_Offsets[IndexOfVertex + 1];
+
+			SetTangentFrame(&_pVertices[IndexOfVertex * g_NumberOfFloatsPerImportedVertex], IsUsed ? Frames[VertexTriangles.m_Corners[FirstEntry]] : DefaultFrame, _rSettings.m_FlipBinormal);
+		}
+	});
+
+	if(_pNumberOfDegenerateUVs != nullptr)
+	{
+		*_pNumberOfDegenerateUVs = NumberOfUnusedTriangles;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+static void FinishImport(const SImportSettings& _rSettings, bool _HasNormals, SImportedMesh& _rMesh)
+{
+	_rMesh.m_Statistics.m_NumberOfWeldedVertices = _rMesh.GetNumberOfVertices();
+
+	if(!_HasNormals || _rSettings.m_GenerateNormals)
+	{
+		SVertexTriangles VertexTriangles;
+
+		BuildVertexTriangles(_rMesh.GetNumberOfVertices(), _rMesh.m_Indices.data(), _rMesh.GetNumberOfIndices(), VertexTriangles);
+
+		GenerateNormals(_rMesh.m_Vertices.data(), _rMesh.GetNumberOfVertices(), _rMesh.m_Indices.data(), _rMesh.GetNumberOfIndices(), VertexTriangles, _rSettings.m_NumberOfThreads);
+	}
+
+	std::vector<SCornerFrame> Frames;
+
+	_rMesh.m_Statistics.m_NumberOfDegenerateUVs = GenerateCornerFrames(_rMesh.m_Vertices.data(), _rMesh.GetNumberOfVertices(), _rMesh.m_Indices.data(), _rMesh.GetNumberOfIndices(), _rSettings.m_NumberOfThreads, Frames);
+
+	// -----------------------------------------------------------------------------
+	// Write the frames of the corners into their vertices. A corner whose frame
+	// differs from the one already in its vertex moves to a copy of the vertex with
+	// that frame, so no corner loses its MikkTSpace result.
+	// -----------------------------------------------------------------------------
+	std::vector<int> NextCopies(_rMesh.GetNumberOfVertices(), -1);
+	std::vector<char> IsWritten(_rMesh.GetNumberOfVertices(), 0);
+
+	for(int IndexOfCorner = 0; IndexOfCorner < static_cast<int>(Frames.size()); ++ IndexOfCorner)
+	{
+		int   IndexOfVertex = _rMesh.m_Indices[IndexOfCorner];
+		float Vertex[g_NumberOfFloatsPerImportedVertex];
+
+		memcpy(Vertex, &_rMesh.m_Vertices[IndexOfVertex * g_NumberOfFloatsPerImportedVertex], sizeof(Vertex));
+
+		SetTangentFrame(Vertex, Frames[IndexOfCorner], _rSettings.m_FlipBinormal);
+
+		if(!IsWritten[IndexOfVertex])
+		{
+			memcpy(&_rMesh.m_Vertices[IndexOfVertex * g_NumberOfFloatsPerImportedVertex], Vertex, sizeof(Vertex));
+
+			IsWritten[IndexOfVertex] = 1;
+
+			continue;
+		}
+
+		int IndexOfCopy = IndexOfVertex;
+		int IndexOfLast = IndexOfVertex;
+
+		for(; IndexOfCopy != -1; IndexOfCopy = NextCopies[IndexOfCopy])
+		{
+			if(memcmp(&_rMesh.m_Vertices[IndexOfCopy * g_NumberOfFloatsPerImportedVertex], Vertex, sizeof(Vertex)) == 0)
+			{
+				break;
+			}
+
+			IndexOfLast = IndexOfCopy;
+		}
+
+		if(IndexOfCopy == -1)
+		{
+			IndexOfCopy = _rMesh.GetNumberOfVertices();
+
+			_rMesh.m_Vertices.insert(_rMesh.m_Vertices.end(), Vertex, Vertex + g_NumberOfFloatsPerImportedVertex);
+
+			NextCopies.push_back(-1);
+			IsWritten .push_back(1);
+
+			NextCopies[IndexOfLast] = IndexOfCopy;
+
+			++ _rMesh.m_Statistics.m_NumberOfSplitVertices;
+		}
+
+		_rMesh.m_Indices[IndexOfCorner] = IndexOfCopy;
+	}
+
+	std::cout << "Imported " << _rMesh.m_Statistics.m_NumberOfSourceTriangles << " triangles, welded " << _rMesh.m_Statistics.m_NumberOfInputCorners << " corners into " << _rMesh.m_Statistics.m_NumberOfWeldedVertices << " vertices, split " << _rMesh.m_Statistics.m_NumberOfSplitVertices << " for their tangent frames" << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ImportOBJ(const char* _pPath, const SImportSettings& _rSettings, SImportedMesh& _rMesh)
+{
+	std::ifstream Stream(_pPath);
+
+	if(!Stream)
+	{
+		std::cout << "Could not open mesh " << _pPath << std::endl;
+
+		return false;
+	}
+
+	// -----------------------------------------------------------------------------
+	// OBJ faces address the global attribute lists, so these have to be kept. The
+	// faces themselves are triangulated and welded line by line.
+	// -----------------------------------------------------------------------------
+	std::vector<float>   Positions;
+	std::vector<float>   Normals;
+	std::vector<float>   TexCoords;
+	std::vector<SCorner> Polygon;
+	std::string          Line;
+
+	CMeshWelder Welder(_rSettings, _rMesh);
+
+	bool HasNormals = true;
+
+	while(std::getline(Stream, Line))
+	{
+		const char* pText = SkipSpaces(Line.c_str());
+
+		if(pText[0] == 'v' && (pText[1] == ' ' || pText[1] == '\t'))
+		{
+			float Values[3] = { 0.0f, 0.0f, 0.0f };
+
+			ReadFloats(pText + 2, Values, 3);
+
+			// OBJ is right handed, YoshiX is left handed.
+			Positions.push_back(Values[0]);
+			Positions.push_back(Values[1]);
+			Positions.push_back(-Values[2]);
+		}
+		else if(pText[0] == 'v' && pText[1] == 'n')
+		{
+			float Values[3] = { 0.0f, 0.0f, 0.0f };
+
+			ReadFloats(pText + 2, Values, 3);
+
+			Normals.push_back(Values[0]);
+			Normals.push_back(Values[1]);
+			Normals.push_back(-Values[2]);
+		}
+		else if(pText[0] == 'v' && pText[1] == 't')
+		{
+			float Values[2] = { 0.0f, 0.0f };
+
+			ReadFloats(pText + 2, Values, 2);
+
+			// OBJ has its texture origin at the bottom left, YoshiX at the top left.
+			TexCoords.push_back(Values[0]);
+			TexCoords.push_back(1.0f - Values[1]);
+		}
+		else if(pText[0] == 'f' && (pText[1] == ' ' || pText[1] == '\t'))
+		{
+			Polygon.clear();
+
+			pText = SkipSpaces(pText + 1);
+
+			while(*pText != '\0' && *pText != '\r')
+			{
+				SCorner Corner;
+				char*   pEnd;
+				long    References[3] = { 0, 0, 0 };
+
+				memset(&Corner, 0, sizeof(Corner));
+
+				// Parse 'v', 'v/vt', 'v//vn' or 'v/vt/vn'.
+				for(int IndexOfReference = 0; IndexOfReference < 3; ++ IndexOfReference)
+				{
+					References[IndexOfReference] = strtol(pText, &pEnd, 10);
+					pText = pEnd;
+
+					if(*pText != '/')
+					{
+						break;
+					}
+
+					++ pText;
+				}
+
+				int IndexOfPosition = ResolveOBJIndex(References[0], Positions.size() / 3);
+				int IndexOfTexCoord = ResolveOBJIndex(References[1], TexCoords.size() / 2);
+				int IndexOfNormal   = ResolveOBJIndex(References[2], Normals.size() / 3);
+
+				if(IndexOfPosition < 0)
+				{
+					break;
+				}
+
+				memcpy(Corner.m_Position, &Positions[IndexOfPosition * 3], 3 * sizeof(float));
+
+				if(IndexOfTexCoord >= 0)
+				{
+					memcpy(Corner.m_TexCoord, &TexCoords[IndexOfTexCoord * 2], 2 * sizeof(float));
+				}
+
+				if(IndexOfNormal >= 0)
+				{
+					memcpy(Corner.m_Normal, &Normals[IndexOfNormal * 3], 3 * sizeof(float));
+				}
+				else
+				{
+					HasNormals = false;
+				}
+
+				Polygon.push_back(Corner);
+
+				pText = SkipSpaces(pText);
+			}
+
+			// Triangulate the polygon as a fan.
+			for(size_t IndexOfCorner = 2; IndexOfCorner < Polygon.size(); ++ IndexOfCorner)
+			{
+				SCorner Corners[3] = { Polygon[0], Polygon[IndexOfCorner - 1], Polygon[IndexOfCorner] };
+
+				Welder.AddTriangle(Corners);
+			}
+		}
+	}
+
+	if(_rMesh.m_Indices.empty())
+	{
+		std::cout << "Mesh " << _pPath << " does not contain any faces" << std::endl;
+
+		return false;
+	}
+
+	FinishImport(_rSettings, HasNormals, _rMesh);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ImportGLTF(const char* _pPath, const SImportSettings& _rSettings, SImportedMesh& _rMesh)
+{
+	std::ifstream Stream(_pPath, std::ios::binary);
+	std::ifstream BufferStream;
+	std::string   Json;
+	uint64_t      BufferFileOffset = 0;
+	SJsonValue    Document;
+
+	if(!Stream)
+	{
+		std::cout << "Could not open mesh " << _pPath << std::endl;
+
+		return false;
+	}
+
+	// -----------------------------------------------------------------------------
+	// A binary glTF file starts with a 12 byte header followed by the JSON chunk
+	// and the binary chunk. Only the JSON chunk is loaded into memory, the binary
+	// chunk is read on demand.
+	// -----------------------------------------------------------------------------
+	uint32_t Header[5] = { 0 };
+
+	Stream.read(reinterpret_cast<char*>(Header), sizeof(Header));
+
+	bool IsBinary = Stream && Header[0] == 0x46546C67;       // 'glTF'
+
+	if(IsBinary)
+	{
+		uint32_t JsonLength = Header[3];
+
+		Json.resize(JsonLength);
+
+		Stream.read(&Json[0], JsonLength);
+
+		BufferFileOffset = sizeof(Header) + JsonLength + 8;   // Skip the length and type of the binary chunk.
+	}
+	else
+	{
+		Stream.clear();
+		Stream.seekg(0);
+
+		Json.assign(std::istreambuf_iterator<char>(Stream), std::istreambuf_iterator<char>());
+	}
+
+	CJsonParser Parser(Json.data(), Json.data() + Json.size());
+
+	if(!Parser.Parse(Document) || Document.m_Type != SJsonValue::Object)
+	{
+		std::cout << "Could not parse glTF file " << _pPath << std::endl;
+
+		return false;
+	}
+
+	if(!IsBinary)
+	{
+		const SJsonValue* pBuffer = Document.GetElement("buffers", 0);
+		const SJsonValue* pUri    = pBuffer != nullptr ? pBuffer->Find("uri") : nullptr;
+
+		if(pUri == nullptr || pUri->m_String.compare(0, 5, "data:") == 0)
+		{
+			std::cout << "glTF file " << _pPath << " has no external buffer, embedded data URIs are not supported" << std::endl;
+
+			return false;
+		}
+
+		BufferStream.open((GetDirectory(_pPath) + pUri->m_String).c_str(), std::ios::binary);
+
+		if(!BufferStream)
+		{
+			std::cout << "Could not open glTF buffer " << pUri->m_String << std::endl;
+
+			return false;
+		}
+	}
+
+	CMeshWelder Welder(_rSettings, _rMesh);
+
+	if(!ReadGLTFMeshes(Document, IsBinary ? Stream : BufferStream, BufferFileOffset, Welder) || _rMesh.m_Indices.empty())
+	{
+		std::cout << "Could not read any triangles from " << _pPath << std::endl;
+
+		return false;
+	}
+
+	// Normals are per primitive in glTF. Generating them if any primitive lacks
+	// them keeps things simple, missing normals are rare in exported files.
+	bool HasNormals = true;
+
+	for(int IndexOfVertex = 0; IndexOfVertex < _rMesh.GetNumberOfVertices() && HasNormals; ++ IndexOfVertex)
+	{
+		HasNormals = GetDotProduct3D(&_rMesh.m_Vertices[IndexOfVertex * g_NumberOfFloatsPerImportedVertex + g_NormalOffset], &_rMesh.m_Vertices[IndexOfVertex * g_NumberOfFloatsPerImportedVertex + g_NormalOffset]) > 0.0f;
+	}
+
+	FinishImport(_rSettings, HasNormals, _rMesh);
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+bool ImportMesh(const char* _pPath, const SImportSettings& _rSettings, SImportedMesh& _rMesh)
+{
+	std::string Path      = _pPath;
+	size_t      Dot       = Path.find_last_of('.');
+	std::string Extension = Dot == std::string::npos ? std::string() : Path.substr(Dot + 1);
+
+	for(char& rCharacter : Extension)
+	{
+		rCharacter = static_cast<char>(tolower(static_cast<unsigned char>(rCharacter)));
+	}
+
+	if(Extension == "obj")
+	{
+		return ImportOBJ(_pPath, _rSettings, _rMesh);
+	}
+
+	if(Extension == "gltf" || Extension == "glb")
+	{
+		return ImportGLTF(_pPath, _rSettings, _rMesh);
+	}
+
+	std::cout << "Unknown mesh format " << _pPath << std::endl;
+
+	return false;
+}
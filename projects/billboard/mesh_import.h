@@ -0,0 +1,73 @@
+
+#pragma once
+
+#include "yoshix.h"
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Imports OBJ and glTF meshes into the interleaved vertex layout used by the
+// normal mapping material:
+//
+//     Position (3D), Tangent (3D), Binormal (3D), Normal (3D), TexCoord (2D)
+//
+// The source file is read as a stream. Faces are triangulated and welded into
+// unique vertices while reading, so only the compact welded mesh is kept in
+// memory and never the whole file. Missing normals are generated afterwards
+// and MikkTSpace tangent frames are always generated on worker threads.
+// -----------------------------------------------------------------------------
+
+static const int g_NumberOfFloatsPerImportedVertex = 14;
+
+struct SImportSettings
+{
+	SImportSettings();
+
+	int   m_NumberOfThreads;        // The number of threads used for the tangent generation. Zero uses one thread per core.
+	float m_Scale;                  // A uniform scale applied to all positions.
+	bool  m_FlipTexCoordV;          // Flips the v texture coordinate (v' = 1 - v) once more. OBJ files are already converted from their bottom left origin, glTF has a top left origin.
+	bool  m_FlipBinormal;           // Negates the binormal 'sign * cross(normal, tangent)' of MikkTSpace. In the left handed YoshiX space it already points up the texture, i.e. against the v direction, as our normal maps expect.
+	bool  m_GenerateNormals;        // Generates smooth normals even if the file contains normals.
+};
+
+struct SImportStatistics
+{
+	int m_NumberOfSourceTriangles;  // The number of triangles after triangulation of the source faces.
+	int m_NumberOfDegenerateUVs;    // The number of triangles without texture area or without area, which do not add to any tangent frame.
+	int m_NumberOfWeldedVertices;   // The number of unique vertices after welding.
+	int m_NumberOfSplitVertices;    // The number of vertices added because the corners of a welded vertex got different tangent frames.
+	int m_NumberOfInputCorners;     // The number of triangle corners read from the file.
+};
+
+struct SImportedMesh
+{
+	std::vector<float> m_Vertices;  // The interleaved vertices, 'g_NumberOfFloatsPerImportedVertex' floats per vertex.
+	std::vector<int>   m_Indices;   // Three indices per triangle, counter-clockwise.
+	SImportStatistics  m_Statistics;
+
+	int GetNumberOfVertices() const;
+	int GetNumberOfIndices() const;
+
+	// Fills a YoshiX mesh info pointing to the data of this mesh. The mesh has to
+	// stay alive until 'CreateMesh' has been called.
+	void GetMeshInfo(gfx::BHandle _pMaterial, gfx::SMeshInfo& _rMeshInfo);
+};
+
+// -----------------------------------------------------------------------------
+// Imports a mesh and picks the loader by file extension ('.obj', '.gltf' or
+// '.glb'). Returns false and prints the reason if the file could not be read.
+// -----------------------------------------------------------------------------
+bool ImportMesh(const char* _pPath, const SImportSettings& _rSettings, SImportedMesh& _rMesh);
+
+bool ImportOBJ(const char* _pPath, const SImportSettings& _rSettings, SImportedMesh& _rMesh);
+bool ImportGLTF(const char* _pPath, const SImportSettings& _rSettings, SImportedMesh& _rMesh);
+
+// -----------------------------------------------------------------------------
+// Regenerates the tangent and binormal of every vertex of an interleaved mesh
+// from its positions, normals and texture coordinates with MikkTSpace. This can
+// also be used for meshes defined in code instead of typing the tangent frames
+// by hand. MikkTSpace computes a frame per triangle corner, here a vertex takes
+// the frame of its first corner. This is exact as long as all corners of a
+// vertex get the same frame, the importer splits the vertices where they do not.
+// -----------------------------------------------------------------------------
+void GenerateTangentFrames(float* _pVertices, int _NumberOfVertices, const int* _pIndices, int _NumberOfIndices, const SImportSettings& _rSettings, int* _pNumberOfDegenerateUVs = nullptr);
@@ -0,0 +1,404 @@
+
+#include "occlusion.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#include <emmintrin.h>
+#define OCCLUSION_USE_SSE2
+#endif
+
+namespace
+{
+	// -----------------------------------------------------------------------------
+	// Transforms a position as row vector with the view projection matrix.
+	// -----------------------------------------------------------------------------
+	void TransformToClipSpace(const float* _pPosition, const float* _pMatrix, float* _pClip)
+	{
+		for(int Axis = 0; Axis < 4; ++ Axis)
+		{
+			_pClip[Axis] = _pPosition[0] * _pMatrix[0 * 4 + Axis] + _pPosition[1] * _pMatrix[1 * 4 + Axis] + _pPosition[2] * _pMatrix[2 * 4 + Axis] + _pMatrix[3 * 4 + Axis];
+		}
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+COcclusionCuller::COcclusionCuller()
+	: m_Width (0)
+	, m_Height(0)
+{
+	memset(m_ViewProjectionMatrix, 0, sizeof(m_ViewProjectionMatrix));
+	memset(&m_Statistics,          0, sizeof(m_Statistics));
+}
+
+// -----------------------------------------------------------------------------
+
+void COcclusionCuller::Create(int _Width, int _Height)
+{
+	m_Width  = (std::max(_Width, 4) + 3) & ~3;
+	m_Height = std::max(_Height, 1);
+
+	m_Levels.clear();
+
+	int Width  = m_Width;
+	int Height = m_Height;
+
+	for(;;)
+	{
+		m_Levels.push_back(std::vector<float>(static_cast<size_t>(Width) * Height, 1.0f));
+
+		if(Width == 1 && Height == 1)
+		{
+			break;
+		}
+
+		Width  = std::max(Width  / 2, 1);
+		Height = std::max(Height / 2, 1);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+void COcclusionCuller::BeginFrame(const float* _pViewProjectionMatrix)
+{
+	memcpy(m_ViewProjectionMatrix, _pViewProjectionMatrix, sizeof(m_ViewProjectionMatrix));
+	memset(&m_Statistics, 0, sizeof(m_Statistics));
+
+	std::fill(m_Levels[0].begin(), m_Levels[0].end(), 1.0f);
+}
+
+// -----------------------------------------------------------------------------
+
+void COcclusionCuller::AddOccluder(const float* _pPositions, const int* _pIndices, int _NumberOfIndices)
+{
+	for(int IndexOfTriangle = 0; IndexOfTriangle + 2 < _NumberOfIndices; IndexOfTriangle += 3)
+	{
+		float Clip[3][4];
+		float Polygon[4][4];
+		int   NumberOfPoints = 0;
+
+		for(int Corner = 0; Corner < 3; ++ Corner)
+		{
+			TransformToClipSpace(&_pPositions[_pIndices[IndexOfTriangle + Corner] * 3], m_ViewProjectionMatrix, Clip[Corner]);
+		}
+
+		// -----------------------------------------------------------------------------
+		// Clip the triangle against the near plane (z >= 0). The result has at most
+		// four corners.
+		// -----------------------------------------------------------------------------
+		for(int Corner = 0; Corner < 3; ++ Corner)
+		{
+			const float* pA = Clip[Corner];
+			const float* pB = Clip[(Corner + 1) % 3];
+
+			if(pA[2] >= 0.0f)
+			{
+				memcpy(Polygon[NumberOfPoints ++], pA, 4 * sizeof(float));
+			}
+
+			if((pA[2] >= 0.0f) != (pB[2] >= 0.0f))
+			{
+				float T = pA[2] / (pA[2] - pB[2]);
+
+				for(int Axis = 0; Axis < 4; ++ Axis)
+				{
+					Polygon[NumberOfPoints][Axis] = pA[Axis] + (pB[Axis] - pA[Axis]) * T;
+				}
+
+				++ NumberOfPoints;
+			}
+		}
+
+		if(NumberOfPoints < 3)
+		{
+			continue;
+		}
+
+		// Project to the pixels of the depth buffer, y grows downwards.
+		float Screen[4][3];
+
+		for(int IndexOfPoint = 0; IndexOfPoint < NumberOfPoints; ++ IndexOfPoint)
+		{
+			float InverseW = 1.0f / std::max(Polygon[IndexOfPoint][3], 1.0e-6f);
+
+			Screen[IndexOfPoint][0] = ( Polygon[IndexOfPoint][0] * InverseW * 0.5f + 0.5f) * m_Width;
+			Screen[IndexOfPoint][1] = (-Polygon[IndexOfPoint][1] * InverseW * 0.5f + 0.5f) * m_Height;
+			Screen[IndexOfPoint][2] =   Polygon[IndexOfPoint][2] * InverseW;
+		}
+
+		for(int IndexOfPoint = 2; IndexOfPoint < NumberOfPoints; ++ IndexOfPoint)
+		{
+			RasterizeTriangle(Screen[0], Screen[IndexOfPoint - 1], Screen[IndexOfPoint]);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+// Rasterizes a screen space triangle with edge functions evaluated at the pixel
+// centers and keeps the nearest depth per pixel. With SSE2 four neighboring
+// pixels of a row are processed at once.
+// -----------------------------------------------------------------------------
+void COcclusionCuller::RasterizeTriangle(const float* _pV0, const float* _pV1, const float* _pV2)
+{
+	const float* pV[3] = { _pV0, _pV1, _pV2 };
+
+	float Area = (pV[1][0] - pV[0][0]) * (pV[2][1] - pV[0][1]) - (pV[1][1] - pV[0][1]) * (pV[2][0] - pV[0][0]);
+
+	if(fabsf(Area) < 1.0e-8f)
+	{
+		return;
+	}
+
+	// Occluders are two sided, so bring every triangle into the same orientation.
+	if(Area < 0.0f)
+	{
+		std::swap(pV[1], pV[2]);
+
+		Area = -Area;
+	}
+
+	int MinX = std::max(static_cast<int>(floorf(std::min(std::min(pV[0][0], pV[1][0]), pV[2][0]))), 0);
+	int MaxX = std::min(static_cast<int>(ceilf (std::max(std::max(pV[0][0], pV[1][0]), pV[2][0]))), m_Width  - 1);
+	int MinY = std::max(static_cast<int>(floorf(std::min(std::min(pV[0][1], pV[1][1]), pV[2][1]))), 0);
+	int MaxY = std::min(static_cast<int>(ceilf (std::max(std::max(pV[0][1], pV[1][1]), pV[2][1]))), m_Height - 1);
+
+	if(MinX > MaxX || MinY > MaxY)
+	{
+		return;
+	}
+
+	++ m_Statistics.m_NumberOfOccluderTriangles;
+
+	// -----------------------------------------------------------------------------
+	// Edge function i is positive on the inner side of the edge from vertex i to
+	// vertex i + 1: E(x, y) = A * x + B * y + C. The depth is a plane in screen
+	// space as well.
+	// -----------------------------------------------------------------------------
+	float EdgeA[3];
+	float EdgeB[3];
+	float EdgeC[3];
+
+	for(int Edge = 0; Edge < 3; ++ Edge)
+	{
+		const float* pA = pV[Edge];
+		const float* pB = pV[(Edge + 1) % 3];
+
+		EdgeA[Edge] = -(pB[1] - pA[1]);
+		EdgeB[Edge] =   pB[0] - pA[0];
+		EdgeC[Edge] = (pB[1] - pA[1]) * pA[0] - (pB[0] - pA[0]) * pA[1];
+	}
+
+	// The barycentric weight of vertex i is the edge function of the opposite edge.
+	float DepthA = (EdgeA[1] * pV[0][2] + EdgeA[2] * pV[1][2] + EdgeA[0] * pV[2][2]) / Area;
+	float DepthB = (EdgeB[1] * pV[0][2] + EdgeB[2] * pV[1][2] + EdgeB[0] * pV[2][2]) / Area;
+	float DepthC = (EdgeC[1] * pV[0][2] + EdgeC[2] * pV[1][2] + EdgeC[0] * pV[2][2]) / Area;
+
+	float* pDepthBuffer = m_Levels[0].data();
+
+	int StartX = MinX & ~3;
+
+	for(int Y = MinY; Y <= MaxY; ++ Y)
+	{
+		float  CenterY = Y + 0.5f;
+		float* pRow    = pDepthBuffer + static_cast<size_t>(Y) * m_Width;
+
+#if defined(OCCLUSION_USE_SSE2)
+		__m128 Offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+		__m128 Zero    = _mm_setzero_ps();
+
+		for(int X = StartX; X <= MaxX; X += 4)
+		{
+			__m128 CenterX = _mm_add_ps(_mm_set1_ps(static_cast<float>(X)), Offsets);
+
+			__m128 Edge0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(EdgeA[0]), CenterX), _mm_set1_ps(EdgeB[0] * CenterY + EdgeC[0]));
+			__m128 Edge1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(EdgeA[1]), CenterX), _mm_set1_ps(EdgeB[1] * CenterY + EdgeC[1]));
+			__m128 Edge2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(EdgeA[2]), CenterX), _mm_set1_ps(EdgeB[2] * CenterY + EdgeC[2]));
+
+			__m128 Inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(Edge0, Zero), _mm_cmpge_ps(Edge1, Zero)), _mm_cmpge_ps(Edge2, Zero));
+
+			if(_mm_movemask_ps(Inside) == 0)
+			{
+				continue;
+			}
+
+			__m128 Depth    = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(DepthA), CenterX), _mm_set1_ps(DepthB * CenterY + DepthC));
+			__m128 Stored   = _mm_loadu_ps(pRow + X);
+			__m128 Nearest  = _mm_min_ps(Stored, Depth);
+
+			_mm_storeu_ps(pRow + X, _mm_or_ps(_mm_and_ps(Inside, Nearest), _mm_andnot_ps(Inside, Stored)));
+		}
+#else
+		for(int X = StartX; X <= MaxX; ++ X)
+		{
+			float CenterX = X + 0.5f;
+
+			if(EdgeA[0] * CenterX + EdgeB[0] * CenterY + EdgeC[0] < 0.0f
+			|| EdgeA[1] * CenterX + EdgeB[1] * CenterY + EdgeC[1] < 0.0f
+			|| EdgeA[2] * CenterX + EdgeB[2] * CenterY + EdgeC[2] < 0.0f)
+			{
+				continue;
+			}
+
+			pRow[X] = std::min(pRow[X], DepthA * CenterX + DepthB * CenterY + DepthC);
+		}
+#endif
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+void COcclusionCuller::EndOccluders()
+{
+	int Width  = m_Width;
+	int Height = m_Height;
+
+	for(size_t IndexOfLevel = 1; IndexOfLevel < m_Levels.size(); ++ IndexOfLevel)
+	{
+		const std::vector<float>& rSource = m_Levels[IndexOfLevel - 1];
+		std::vector<float>&       rTarget = m_Levels[IndexOfLevel];
+
+		int SourceWidth  = Width;
+		int SourceHeight = Height;
+
+		Width  = std::max(Width  / 2, 1);
+		Height = std::max(Height / 2, 1);
+
+		for(int Y = 0; Y < Height; ++ Y)
+		{
+			int Y0 = std::min(Y * 2,     SourceHeight - 1);
+			int Y1 = std::min(Y * 2 + 1, SourceHeight - 1);
+
+			for(int X = 0; X < Width; ++ X)
+			{
+				int X0 = std::min(X * 2,     SourceWidth - 1);
+				int X1 = std::min(X * 2 + 1, SourceWidth - 1);
+
+				float Farthest = std::max(std::max(rSource[Y0 * SourceWidth + X0], rSource[Y0 * SourceWidth + X1]), std::max(rSource[Y1 * SourceWidth + X0], rSource[Y1 * SourceWidth + X1]));
+
+				// Odd sizes fold the last row or column into the last texel.
+				if(X == Width - 1 && SourceWidth > Width * 2)
+				{
+					Farthest = std::max(Farthest, std::max(rSource[Y0 * SourceWidth + SourceWidth - 1], rSource[Y1 * SourceWidth + SourceWidth - 1]));
+				}
+
+				if(Y == Height - 1 && SourceHeight > Height * 2)
+				{
+					Farthest = std::max(Farthest, std::max(rSource[(SourceHeight - 1) * SourceWidth + X0], rSource[(SourceHeight - 1) * SourceWidth + X1]));
+				}
+
+				rTarget[Y * Width + X] = Farthest;
+			}
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+bool COcclusionCuller::IsBoxVisible(const float* _pMin, const float* _pMax)
+{
+	bool IsVisible = IsBoxVisibleConcurrent(_pMin, _pMax);
+
+	AddTests(1, IsVisible ? 0 : 1);
+
+	return IsVisible;
+}
+
+// -----------------------------------------------------------------------------
+
+bool COcclusionCuller::IsBoxVisibleConcurrent(const float* _pMin, const float* _pMax) const
+{
+	float MinX     =  1.0e30f;
+	float MaxX     = -1.0e30f;
+	float MinY     =  1.0e30f;
+	float MaxY     = -1.0e30f;
+	float MinDepth =  1.0e30f;
+
+	for(int IndexOfCorner = 0; IndexOfCorner < 8; ++ IndexOfCorner)
+	{
+		float Corner[3] =
+		{
+			(IndexOfCorner & 1) != 0 ? _pMax[0] : _pMin[0],
+			(IndexOfCorner & 2) != 0 ? _pMax[1] : _pMin[1],
+			(IndexOfCorner & 4) != 0 ? _pMax[2] : _pMin[2],
+		};
+
+		float Clip[4];
+
+		TransformToClipSpace(Corner, m_ViewProjectionMatrix, Clip);
+
+		// A box reaching behind the near plane can not be tested reliably.
+		if(Clip[2] < 0.0f || Clip[3] <= 1.0e-6f)
+		{
+			return true;
+		}
+
+		float InverseW = 1.0f / Clip[3];
+
+		float X = ( Clip[0] * InverseW * 0.5f + 0.5f) * m_Width;
+		float Y = (-Clip[1] * InverseW * 0.5f + 0.5f) * m_Height;
+
+		MinX     = std::min(MinX, X);
+		MaxX     = std::max(MaxX, X);
+		MinY     = std::min(MinY, Y);
+		MaxY     = std::max(MaxY, Y);
+		MinDepth = std::min(MinDepth, Clip[2] * InverseW);
+	}
+
+	// Boxes outside of the screen are left to the frustum culling.
+	if(MaxX < 0.0f || MaxY < 0.0f || MinX >= m_Width || MinY >= m_Height)
+	{
+		return true;
+	}
+
+	int X0 = std::max(static_cast<int>(MinX), 0);
+	int X1 = std::min(static_cast<int>(MaxX), m_Width  - 1);
+	int Y0 = std::max(static_cast<int>(MinY), 0);
+	int Y1 = std::min(static_cast<int>(MaxY), m_Height - 1);
+
+	// -----------------------------------------------------------------------------
+	// Go up the pyramid until the rectangle covers at most 8 x 8 texels. Coarser
+	// levels would be cheaper, but their texels reach far over the occluder edges.
+	// -----------------------------------------------------------------------------
+	int Level = 0;
+
+	while(Level + 1 < static_cast<int>(m_Levels.size()) && ((X1 >> Level) - (X0 >> Level) > 7 || (Y1 >> Level) - (Y0 >> Level) > 7))
+	{
+		++ Level;
+	}
+
+	int LevelWidth  = std::max(m_Width  >> Level, 1);
+	int LevelHeight = std::max(m_Height >> Level, 1);
+
+	const std::vector<float>& rLevel = m_Levels[Level];
+
+	for(int Y = std::min(Y0 >> Level, LevelHeight - 1); Y <= std::min(Y1 >> Level, LevelHeight - 1); ++ Y)
+	{
+		for(int X = std::min(X0 >> Level, LevelWidth - 1); X <= std::min(X1 >> Level, LevelWidth - 1); ++ X)
+		{
+			if(rLevel[Y * LevelWidth + X] >= MinDepth)
+			{
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+
+void COcclusionCuller::AddTests(int _NumberOfTests, int _NumberOfOccluded)
+{
+	m_Statistics.m_NumberOfTests    += _NumberOfTests;
+	m_Statistics.m_NumberOfOccluded += _NumberOfOccluded;
+}
+
+// -----------------------------------------------------------------------------
+
+const SOcclusionStatistics& COcclusionCuller::GetStatistics() const
+{
+	return m_Statistics;
+}
@@ -0,0 +1,80 @@
+
+#pragma once
+
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Software occlusion culling on the CPU. A few large opaque occluders (walls,
+// buildings) are rasterized into a small depth buffer. From this buffer a
+// pyramid of mip levels is built, where each texel holds the farthest depth of
+// the four texels below it. An object is hidden if the nearest depth of its
+// bounding box is behind the farthest occluder depth everywhere in its screen
+// rectangle. The test touches only a few texels by picking the mip level
+// matching the size of the rectangle.
+//
+// Depth runs from 0 (near plane) to 1 (far plane) like in YoshiX clip space.
+// -----------------------------------------------------------------------------
+
+struct SOcclusionStatistics
+{
+	int m_NumberOfOccluderTriangles;    // Triangles rasterized into the depth buffer this frame.
+	int m_NumberOfTests;                // Bounding boxes tested this frame.
+	int m_NumberOfOccluded;             // Bounding boxes found hidden this frame.
+};
+
+class COcclusionCuller
+{
+public:
+
+	COcclusionCuller();
+
+public:
+
+	// -----------------------------------------------------------------------------
+	// Sets the resolution of the depth buffer. The width is rounded up to a
+	// multiple of four to rasterize four pixels at once.
+	// -----------------------------------------------------------------------------
+	void Create(int _Width, int _Height);
+
+	// Clears the depth buffer for a new view.
+	void BeginFrame(const float* _pViewProjectionMatrix);
+
+	// -----------------------------------------------------------------------------
+	// Rasterizes an occluder given as world space positions (3 floats each) and
+	// three indices per triangle. Occluders are drawn from both sides and must be
+	// completely opaque, otherwise objects seen through them get culled.
+	// -----------------------------------------------------------------------------
+	void AddOccluder(const float* _pPositions, const int* _pIndices, int _NumberOfIndices);
+
+	// Builds the depth pyramid. Has to be called after the last occluder and
+	// before the first test.
+	void EndOccluders();
+
+	// Returns false if the world space box is completely hidden by the occluders.
+	bool IsBoxVisible(const float* _pMin, const float* _pMax);
+
+	// -----------------------------------------------------------------------------
+	// The same test without counting it, so several threads can test boxes at the
+	// same time between 'EndOccluders' and the next frame. The threads add their
+	// counts with 'AddTests' when they are done.
+	// -----------------------------------------------------------------------------
+	bool IsBoxVisibleConcurrent(const float* _pMin, const float* _pMax) const;
+
+	void AddTests(int _NumberOfTests, int _NumberOfOccluded);
+
+	const SOcclusionStatistics& GetStatistics() const;
+
+private:
+
+	void RasterizeTriangle(const float* _pV0, const float* _pV1, const float* _pV2);
+
+private:
+
+	int   m_Width;
+	int   m_Height;
+	float m_ViewProjectionMatrix[16];
+
+	std::vector<std::vector<float>> m_Levels;       // The depth pyramid, level 0 is the depth buffer.
+
+	SOcclusionStatistics m_Statistics;
+};
@@ -0,0 +1,69 @@
+
+#pragma once
+
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Returns the number of worker threads to use. A value of zero or less asks for
+// one thread per hardware core.
+// -----------------------------------------------------------------------------
+inline int GetNumberOfWorkerThreads(int _NumberOfThreads)
+{
+	if(_NumberOfThreads > 0)
+	{
+		return _NumberOfThreads;
+	}
+
+	int NumberOfCores = static_cast<int>(std::thread::hardware_concurrency());
+
+	return NumberOfCores > 0 ? NumberOfCores : 1;
+}
+
+// -----------------------------------------------------------------------------
+// Splits the range [0, _Count) into contiguous blocks and calls
+// '_Function(Begin, End)' for each block on its own thread. The calling thread
+// processes the first block itself and waits for the others to finish. Small
+// ranges are processed on the calling thread only.
+// -----------------------------------------------------------------------------
+template<typename TFunction>
+void ParallelFor(int _Count, int _NumberOfThreads, const TFunction& _rFunction, int _MinimumBlockSize = 1024)
+{
+	if(_Count <= 0)
+	{
+		return;
+	}
+
+	int NumberOfThreads = GetNumberOfWorkerThreads(_NumberOfThreads);
+	int MinimumBlockSize = std::max(_MinimumBlockSize, 1);
+
+	NumberOfThreads = std::min(NumberOfThreads, (_Count + MinimumBlockSize - 1) / MinimumBlockSize);
+
+	if(NumberOfThreads <= 1)
+	{
+		_rFunction(0, _Count);
+
+		return;
+	}
+
+	int BlockSize = (_Count + NumberOfThreads - 1) / NumberOfThreads;
+
+	std::vector<std::thread> Threads;
+
+	Threads.reserve(NumberOfThreads - 1);
+
+	for(int Begin = BlockSize; Begin < _Count; Begin += BlockSize)
+	{
+		int End = std::min(Begin + BlockSize, _Count);
+
+		Threads.emplace_back([&_rFunction, Begin, End]() { _rFunction(Begin, End); });
+	}
+
+	_rFunction(0, std::min(BlockSize, _Count));
+
+	for(std::thread& rThread : Threads)
+	{
+		rThread.join();
+	}
+}
@@ -0,0 +1,254 @@
+
+#include "quality_governor.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+namespace
+{
+	// -----------------------------------------------------------------------------
+	// The ladder of quality levels, from full quality to the cheapest one. Each
+	// step lowers a few knobs, the ones costing the least visible quality first.
+	// -----------------------------------------------------------------------------
+	const SQualityLevel g_QualityLevels[] =
+	{
+		//  terrain  texture  distance  billboards  lights  normal maps
+		{   1.00f,   0.0f,    100.0f,   1000000,    1024,   true  },
+		{   0.85f,   0.0f,     80.0f,     16384,     192,   true  },
+		{   0.70f,   1.0f,     60.0f,      8192,     128,   true  },
+		{   0.60f,   1.0f,     45.0f,      4096,      64,   false },
+		{   0.50f,   2.0f,     30.0f,      2048,      32,   false },
+		{   0.40f,   2.0f,     20.0f,      1024,       0,   false },
+	};
+
+	const int g_NumberOfQualityLevels = sizeof(g_QualityLevels) / sizeof(g_QualityLevels[0]);
+
+	// The number of frames the moving average needs before the first decision.
+	const int g_NumberOfWarmUpFrames = 30;
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+SQualityGovernorSettings::SQualityGovernorSettings()
+	: m_TargetFrameTime (16.6f)
+	, m_Smoothing       (0.1f)
+	, m_DowngradeRatio  (0.9f)
+	, m_DowngradeFrames (10)
+	, m_UpgradeRatio    (0.6f)
+	, m_UpgradeFrames   (120)
+	, m_MaxUpgradeFrames(3840)
+	, m_MissedFrameRatio(1.5f)
+	, m_CooldownFrames  (60)
+	, m_InitialLevel    (0)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+CQualityGovernor::CQualityGovernor()
+	: m_Level             (0)
+	, m_SmoothedFrameTime (0.0)
+	, m_SmoothedCPUTime   (0.0)
+	, m_NumberOfFrames    (0)
+	, m_OverBudgetFrames  (0)
+	, m_UnderBudgetFrames (0)
+	, m_CooldownFrames    (0)
+	, m_UpgradeFrames     (0)
+	, m_FramesSinceUpgrade(-1)
+	, m_NumberOfDowngrades(0)
+	, m_NumberOfUpgrades  (0)
+{
+}
+
+// -----------------------------------------------------------------------------
+
+void CQualityGovernor::Create(const SQualityGovernorSettings& _rSettings)
+{
+	m_Settings = _rSettings;
+
+	m_Settings.m_Smoothing = std::min(std::max(m_Settings.m_Smoothing, 0.001f), 1.0f);
+
+	m_Level              = std::min(std::max(m_Settings.m_InitialLevel, 0), g_NumberOfQualityLevels - 1);
+	m_SmoothedFrameTime  = 0.0;
+	m_SmoothedCPUTime    = 0.0;
+	m_NumberOfFrames     = 0;
+	m_OverBudgetFrames   = 0;
+	m_UnderBudgetFrames  = 0;
+	m_CooldownFrames     = 0;
+	m_UpgradeFrames      = m_Settings.m_UpgradeFrames;
+	m_FramesSinceUpgrade = -1;
+	m_NumberOfDowngrades = 0;
+	m_NumberOfUpgrades   = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CQualityGovernor::Update(double _FrameTime, double _CPUTime)
+{
+	if(m_NumberOfFrames == 0)
+	{
+		m_SmoothedFrameTime = _FrameTime;
+		m_SmoothedCPUTime   = _CPUTime;
+	}
+	else
+	{
+		m_SmoothedFrameTime += m_Settings.m_Smoothing * (_FrameTime - m_SmoothedFrameTime);
+		m_SmoothedCPUTime   += m_Settings.m_Smoothing * (_CPUTime   - m_SmoothedCPUTime);
+	}
+
+	++ m_NumberOfFrames;
+
+	if(m_NumberOfFrames < g_NumberOfWarmUpFrames)
+	{
+		return false;
+	}
+
+	// -----------------------------------------------------------------------------
+	// An upgrade holds if no downgrade follows until the governor could have
+	// upgraded again with the initial delay. Then the load has changed and the
+	// delay starts over.
+	// -----------------------------------------------------------------------------
+	if(m_FramesSinceUpgrade >= 0 && ++ m_FramesSinceUpgrade > m_Settings.m_CooldownFrames + m_Settings.m_UpgradeFrames)
+	{
+		m_UpgradeFrames      = m_Settings.m_UpgradeFrames;
+		m_FramesSinceUpgrade = -1;
+	}
+
+	if(m_CooldownFrames > 0)
+	{
+		-- m_CooldownFrames;
+
+		return false;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Count the frames in a row on either side of the budget. Frames between the
+	// two thresholds reset both counters and keep the current level.
+	// -----------------------------------------------------------------------------
+	double Budget = m_Settings.m_TargetFrameTime;
+
+	bool IsCPUOverBudget   = m_SmoothedCPUTime   > Budget * m_Settings.m_DowngradeRatio;
+	bool IsFrameOverBudget = m_SmoothedFrameTime > Budget * m_Settings.m_MissedFrameRatio;
+	bool IsUnderBudget     = m_SmoothedCPUTime   < Budget * m_Settings.m_UpgradeRatio && !IsFrameOverBudget;
+
+	m_OverBudgetFrames  = IsCPUOverBudget || IsFrameOverBudget ? m_OverBudgetFrames  + 1 : 0;
+	m_UnderBudgetFrames = IsUnderBudget                        ? m_UnderBudgetFrames + 1 : 0;
+
+	if(m_OverBudgetFrames >= m_Settings.m_DowngradeFrames && m_Level + 1 < g_NumberOfQualityLevels)
+	{
+		++ m_NumberOfDowngrades;
+
+		if(m_FramesSinceUpgrade >= 0)
+		{
+			m_UpgradeFrames      = std::min(m_UpgradeFrames * 2, std::max(m_Settings.m_MaxUpgradeFrames, m_Settings.m_UpgradeFrames));
+			m_FramesSinceUpgrade = -1;
+
+			std::cout << "Quality level " << m_Level << " failed, the next upgrade waits " << m_UpgradeFrames << " frames" << std::endl;
+		}
+
+		ChangeLevel(m_Level + 1, IsCPUOverBudget ? "cpu over budget" : "missed vertical blanks");
+
+		return true;
+	}
+
+	if(m_UnderBudgetFrames >= m_UpgradeFrames && m_Level > 0)
+	{
+		++ m_NumberOfUpgrades;
+
+		m_FramesSinceUpgrade = 0;
+
+		ChangeLevel(m_Level - 1, "cpu well below budget");
+
+		return true;
+	}
+
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+
+void CQualityGovernor::SetLevel(int _Level)
+{
+	_Level = std::min(std::max(_Level, 0), g_NumberOfQualityLevels - 1);
+
+	// A level set by hand says nothing about the load.
+	m_UpgradeFrames      = m_Settings.m_UpgradeFrames;
+	m_FramesSinceUpgrade = -1;
+
+	if(_Level != m_Level)
+	{
+		ChangeLevel(_Level, "set by hand");
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+int CQualityGovernor::GetLevel() const
+{
+	return m_Level;
+}
+
+// -----------------------------------------------------------------------------
+
+int CQualityGovernor::GetNumberOfLevels() const
+{
+	return g_NumberOfQualityLevels;
+}
+
+// -----------------------------------------------------------------------------
+
+const SQualityLevel& CQualityGovernor::GetQuality() const
+{
+	return g_QualityLevels[m_Level];
+}
+
+// -----------------------------------------------------------------------------
+
+double CQualityGovernor::GetSmoothedFrameTime() const
+{
+	return m_SmoothedFrameTime;
+}
+
+// -----------------------------------------------------------------------------
+
+double CQualityGovernor::GetSmoothedCPUTime() const
+{
+	return m_SmoothedCPUTime;
+}
+
+// -----------------------------------------------------------------------------
+
+void CQualityGovernor::PrintReport() const
+{
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Quality level " << m_Level << " of " << g_NumberOfQualityLevels - 1 << ", cpu " << m_SmoothedCPUTime << " ms, frame " << m_SmoothedFrameTime << " ms, budget " << m_Settings.m_TargetFrameTime << " ms, " << m_NumberOfDowngrades << " downgrades, " << m_NumberOfUpgrades << " upgrades" << std::endl;
+	std::cout << std::defaultfloat;
+
+	PrintQuality();
+}
+
+// -----------------------------------------------------------------------------
+
+void CQualityGovernor::PrintQuality() const
+{
+	const SQualityLevel& rQuality = GetQuality();
+
+	std::cout << "    terrain lod " << rQuality.m_LodDistanceScale << ", texture bias " << rQuality.m_TextureLevelBias << ", billboard distance " << rQuality.m_BillboardDistance << ", max " << rQuality.m_MaxNumberOfBillboards << " billboards, max " << rQuality.m_MaxNumberOfPointLights << " lights, normal maps " << (rQuality.m_UseNormalMaps ? "on" : "off") << std::endl;
+}
+
+// -----------------------------------------------------------------------------
+
+void CQualityGovernor::ChangeLevel(int _Level, const char* _pReason)
+{
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << "Quality level " << m_Level << " -> " << _Level << ": " << _pReason << " (cpu " << m_SmoothedCPUTime << " ms, frame " << m_SmoothedFrameTime << " ms, budget " << m_Settings.m_TargetFrameTime << " ms)" << std::endl;
+	std::cout << std::defaultfloat;
+
+	m_Level             = _Level;
+	m_OverBudgetFrames  = 0;
+	m_UnderBudgetFrames = 0;
+	m_CooldownFrames    = m_Settings.m_CooldownFrames;
+
+	PrintQuality();
+}
@@ -0,0 +1,99 @@
+
+#pragma once
+
+// -----------------------------------------------------------------------------
+// Holds the frame time by trading quality for speed. The governor is fed the
+// CPU and the frame time of every frame and walks a ladder of quality levels,
+// level 0 being the full quality. Each level sets all knobs at once, so the
+// levels can be tuned and compared as a whole.
+//
+// The times are smoothed with an exponential moving average. The quality is
+// lowered if the smoothed times stay above the budget for some frames and only
+// raised again if they stay well below it for a longer time. After a change the
+// governor waits for the times to settle before the next decision. The gap
+// between the two thresholds and the different delays keep the quality from
+// oscillating between two levels. If the load sits right at the edge of a level,
+// an upgrade is followed by a downgrade after all. Such a failed upgrade doubles
+// the delay before the next one, an upgrade which holds resets it.
+//
+// YoshiX waits for the vertical blank, so the frame time does not drop below
+// the refresh interval even if the frame is cheap. The CPU time is therefore
+// compared against the budget, the frame time only counts if it shows missed
+// vertical blanks.
+// -----------------------------------------------------------------------------
+
+struct SQualityGovernorSettings
+{
+	SQualityGovernorSettings();
+
+	float m_TargetFrameTime;            // The budget in milliseconds, e.g. 16.6 for 60 Hz.
+	float m_Smoothing;                  // The weight of the newest frame in the moving average (0..1).
+	float m_DowngradeRatio;             // Lower the quality if the CPU time is above the budget times this ratio...
+	int   m_DowngradeFrames;            // ... for this number of frames in a row.
+	float m_UpgradeRatio;               // Raise the quality if the CPU time is below the budget times this ratio...
+	int   m_UpgradeFrames;              // ... for this number of frames in a row.
+	int   m_MaxUpgradeFrames;           // The limit of the upgrade delay, which doubles after each failed upgrade.
+	float m_MissedFrameRatio;           // A frame time above the budget times this ratio missed a vertical blank.
+	int   m_CooldownFrames;             // The number of frames after a change without a new decision.
+	int   m_InitialLevel;
+};
+
+struct SQualityLevel
+{
+	float m_LodDistanceScale;           // Scales the distance at which the terrain switches to finer chunks.
+	float m_TextureLevelBias;           // Added to the mip level the texture streaming loads.
+	float m_BillboardDistance;          // Billboards farther away from the camera are not drawn.
+	int   m_MaxNumberOfBillboards;      // The number of billboards drawn at most.
+	int   m_MaxNumberOfPointLights;     // The number of point lights binned into the clusters at most.
+	bool  m_UseNormalMaps;              // If false the billboard shader skips the normal map.
+};
+
+class CQualityGovernor
+{
+public:
+
+	CQualityGovernor();
+
+public:
+
+	void Create(const SQualityGovernorSettings& _rSettings);
+
+	// -----------------------------------------------------------------------------
+	// Takes the times of the last frame in milliseconds. Returns true if the level
+	// changed, the decision is logged to the console.
+	// -----------------------------------------------------------------------------
+	bool Update(double _FrameTime, double _CPUTime);
+
+	// Sets the level by hand, e.g. while the governor is turned off.
+	void SetLevel(int _Level);
+
+	int GetLevel() const;
+	int GetNumberOfLevels() const;
+
+	const SQualityLevel& GetQuality() const;
+
+	double GetSmoothedFrameTime() const;
+	double GetSmoothedCPUTime() const;
+
+	void PrintReport() const;
+
+private:
+
+	void ChangeLevel(int _Level, const char* _pReason);
+	void PrintQuality() const;
+
+private:
+
+	SQualityGovernorSettings m_Settings;
+	int                      m_Level;
+	double                   m_SmoothedFrameTime;
+	double                   m_SmoothedCPUTime;
+	int                      m_NumberOfFrames;          // Frames since the start, the average needs a few to settle.
+	int                      m_OverBudgetFrames;        // Frames in a row above the downgrade threshold.
+	int                      m_UnderBudgetFrames;       // Frames in a row below the upgrade threshold.
+	int                      m_CooldownFrames;          // Frames left until the next decision.
+	int                      m_UpgradeFrames;           // The current upgrade delay.
+	int                      m_FramesSinceUpgrade;      // Frames since the last upgrade while it may still fail, -1 otherwise.
+	int                      m_NumberOfDowngrades;
+	int                      m_NumberOfUpgrades;
+};
@@ -0,0 +1,494 @@
+
+#include "resource_tracking.h"
+#include "dds_file.h"
+
+#include <ctype.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using namespace gfx;
+
+namespace
+{
+	struct SResource
+	{
+		SResourceCategory::EType m_Category;
+		size_t                   m_NumberOfBytes;
+		size_t                   m_VertexSize;      // The bytes per vertex of a material, used for the meshes.
+		unsigned int             m_IndexOfCreate;   // Orders the live handles by age.
+		const char*              m_pSite;           // Points to a string literal, so it does not have to be copied.
+	};
+
+	std::mutex                              g_Mutex;
+	std::unordered_map<BHandle, SResource>  g_Resources;
+	SResourceStatistics                     g_Statistics;
+	SResourceBudgets                        g_Budgets;
+	bool                                    g_IsOverBudget[SResourceCategory::NumberOfTypes + 1];
+	unsigned int                            g_IndexOfNextCreate = 0;
+
+	// -----------------------------------------------------------------------------
+
+	bool HasExtension(const char* _pPath, const char* _pExtension)
+	{
+		size_t PathLength      = strlen(_pPath);
+		size_t ExtensionLength = strlen(_pExtension);
+
+		if(PathLength < ExtensionLength)
+		{
+			return false;
+		}
+
+		for(size_t IndexOfCharacter = 0; IndexOfCharacter < ExtensionLength; ++ IndexOfCharacter)
+		{
+			if(tolower(_pPath[PathLength - ExtensionLength + IndexOfCharacter]) != tolower(_pExtension[IndexOfCharacter]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// -----------------------------------------------------------------------------
+	// The GPU has no 24 bit formats, so such textures are stored with 32 bits per
+	// pixel. Block compressed levels keep their size.
+	// -----------------------------------------------------------------------------
+	size_t GetDDSBytes(const char* _pPath)
+	{
+		SDDSInfo Info;
+
+		if(!ReadDDSInfo(_pPath, Info))
+		{
+			return 0;
+		}
+
+		size_t NumberOfBytes = 0;
+
+		for(const SDDSLevel& rLevel : Info.m_Levels)
+		{
+			if(Info.m_FourCC != 0)
+			{
+				NumberOfBytes += rLevel.m_Size;
+			}
+			else
+			{
+				int BitsPerPixel = Info.m_BitsPerPixel == 24 ? 32 : Info.m_BitsPerPixel;
+
+				NumberOfBytes += static_cast<size_t>(rLevel.m_Width) * rLevel.m_Height * BitsPerPixel / 8;
+			}
+		}
+
+		return NumberOfBytes;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Other images are decoded into 32 bits per pixel without mip levels. Only the
+	// PNG header is read for the size.
+	// -----------------------------------------------------------------------------
+	size_t GetPNGBytes(const char* _pPath)
+	{
+		unsigned char Header[24];
+
+		std::ifstream Stream(_pPath, std::ios::binary);
+
+		if(!Stream.read(reinterpret_cast<char*>(Header), sizeof(Header)) || memcmp(Header + 12, "IHDR", 4) != 0)
+		{
+			return 0;
+		}
+
+		size_t Width  = (size_t(Header[16]) << 24) | (size_t(Header[17]) << 16) | (size_t(Header[18]) << 8) | size_t(Header[19]);
+		size_t Height = (size_t(Header[20]) << 24) | (size_t(Header[21]) << 16) | (size_t(Header[22]) << 8) | size_t(Header[23]);
+
+		return Width * Height * 4;
+	}
+
+	// -----------------------------------------------------------------------------
+
+	size_t GetTextureBytes(const char* _pPath)
+	{
+		if(HasExtension(_pPath, ".dds"))
+		{
+			return GetDDSBytes(_pPath);
+		}
+
+		if(HasExtension(_pPath, ".png"))
+		{
+			return GetPNGBytes(_pPath);
+		}
+
+		return 0;
+	}
+
+	// -----------------------------------------------------------------------------
+	// All input element types have four bytes per component and are ordered by
+	// the number of components.
+	// -----------------------------------------------------------------------------
+	size_t GetVertexSize(const SMaterialInfo& _rInfo)
+	{
+		size_t VertexSize = 0;
+
+		for(int IndexOfElement = 0; IndexOfElement < _rInfo.m_NumberOfInputElements; ++ IndexOfElement)
+		{
+			VertexSize += (static_cast<int>(_rInfo.m_InputElements[IndexOfElement].m_Type) % 4 + 1) * 4;
+		}
+
+		return VertexSize;
+	}
+
+	// -----------------------------------------------------------------------------
+
+	void AddToCounters(SResourceCounters& _rCounters, size_t _NumberOfBytes)
+	{
+		++ _rCounters.m_NumberOfHandles;
+		++ _rCounters.m_NumberOfCreates;
+
+		_rCounters.m_NumberOfBytes     += _NumberOfBytes;
+		_rCounters.m_MaxNumberOfHandles = std::max(_rCounters.m_MaxNumberOfHandles, _rCounters.m_NumberOfHandles);
+		_rCounters.m_MaxNumberOfBytes   = std::max(_rCounters.m_MaxNumberOfBytes,   _rCounters.m_NumberOfBytes);
+	}
+
+	// -----------------------------------------------------------------------------
+
+	void RemoveFromCounters(SResourceCounters& _rCounters, size_t _NumberOfBytes)
+	{
+		-- _rCounters.m_NumberOfHandles;
+		++ _rCounters.m_NumberOfReleases;
+
+		_rCounters.m_NumberOfBytes -= _NumberOfBytes;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Warns when the memory crosses the budget. 'g_IsOverBudget' is reset once the
+	// memory is below the budget again, so a budget does not warn every frame.
+	// The last entry of 'g_IsOverBudget' belongs to the total budget.
+	// -----------------------------------------------------------------------------
+	void CheckBudget(int _IndexOfBudget, const char* _pName, size_t _NumberOfBytes, size_t _Budget, const char* _pSite)
+	{
+		if(_Budget == 0 || _NumberOfBytes <= _Budget)
+		{
+			g_IsOverBudget[_IndexOfBudget] = false;
+
+			return;
+		}
+
+		if(g_IsOverBudget[_IndexOfBudget])
+		{
+			return;
+		}
+
+		g_IsOverBudget[_IndexOfBudget] = true;
+
+		++ g_Statistics.m_NumberOfBudgetWarnings;
+
+		std::cout << "Warning: " << _pName << " memory of " << _NumberOfBytes / 1024 << " KB exceeds the budget of " << _Budget / 1024 << " KB, created at " << _pSite << std::endl;
+	}
+
+	// -----------------------------------------------------------------------------
+
+	void AddResource(BHandle _pHandle, SResourceCategory::EType _Category, size_t _NumberOfBytes, size_t _VertexSize, const char* _pSite)
+	{
+		if(_pHandle == nullptr)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> Lock(g_Mutex);
+
+		SResource Resource;
+
+		Resource.m_Category      = _Category;
+		Resource.m_NumberOfBytes = _NumberOfBytes;
+		Resource.m_VertexSize    = _VertexSize;
+		Resource.m_IndexOfCreate = g_IndexOfNextCreate ++;
+		Resource.m_pSite         = _pSite;
+
+		g_Resources[_pHandle] = Resource;
+
+		SResourceCounters& rCounters = g_Statistics.m_Categories[_Category];
+
+		AddToCounters(rCounters, _NumberOfBytes);
+		AddToCounters(g_Statistics.m_Total, _NumberOfBytes);
+
+		CheckBudget(_Category, GetResourceCategoryName(_Category), rCounters.m_NumberOfBytes, g_Budgets.m_NumberOfBytes[_Category], _pSite);
+		CheckBudget(SResourceCategory::NumberOfTypes, "Total", g_Statistics.m_Total.m_NumberOfBytes, g_Budgets.m_NumberOfTotalBytes, _pSite);
+	}
+
+	// -----------------------------------------------------------------------------
+
+	void RemoveResource(BHandle _pHandle, SResourceCategory::EType _Category)
+	{
+		if(_pHandle == nullptr)
+		{
+			return;
+		}
+
+		std::lock_guard<std::mutex> Lock(g_Mutex);
+
+		auto Resource = g_Resources.find(_pHandle);
+
+		if(Resource == g_Resources.end() || Resource->second.m_Category != _Category)
+		{
+			++ g_Statistics.m_NumberOfUnknownReleases;
+
+			std::cout << "Warning: released " << GetResourceCategoryName(_Category) << " " << _pHandle << " was not created by the resource tracking or is released twice" << std::endl;
+
+			return;
+		}
+
+		size_t NumberOfBytes = Resource->second.m_NumberOfBytes;
+
+		RemoveFromCounters(g_Statistics.m_Categories[_Category], NumberOfBytes);
+		RemoveFromCounters(g_Statistics.m_Total, NumberOfBytes);
+
+		g_Resources.erase(Resource);
+
+		if(g_Statistics.m_Categories[_Category].m_NumberOfBytes <= g_Budgets.m_NumberOfBytes[_Category])
+		{
+			g_IsOverBudget[_Category] = false;
+		}
+
+		if(g_Statistics.m_Total.m_NumberOfBytes <= g_Budgets.m_NumberOfTotalBytes)
+		{
+			g_IsOverBudget[SResourceCategory::NumberOfTypes] = false;
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+
+	size_t GetMaterialVertexSize(BHandle _pMaterial)
+	{
+		std::lock_guard<std::mutex> Lock(g_Mutex);
+
+		auto Resource = g_Resources.find(_pMaterial);
+
+		return Resource != g_Resources.end() ? Resource->second.m_VertexSize : 0;
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+SResourceBudgets::SResourceBudgets()
+	: m_NumberOfTotalBytes(64 * 1024 * 1024)
+{
+	for(size_t& rNumberOfBytes : m_NumberOfBytes)
+	{
+		rNumberOfBytes = 0;
+	}
+
+	m_NumberOfBytes[SResourceCategory::Texture]        = 32 * 1024 * 1024;
+	m_NumberOfBytes[SResourceCategory::ConstantBuffer] =  1 * 1024 * 1024;
+	m_NumberOfBytes[SResourceCategory::Mesh]           = 32 * 1024 * 1024;
+}
+
+// -----------------------------------------------------------------------------
+
+const char* GetResourceCategoryName(SResourceCategory::EType _Category)
+{
+	static const char* s_pNames[SResourceCategory::NumberOfTypes] =
+	{
+		"Texture",
+		"Constant buffer",
+		"Vertex shader",
+		"Pixel shader",
+		"Material",
+		"Mesh",
+	};
+
+	return s_pNames[_Category];
+}
+
+// -----------------------------------------------------------------------------
+
+void SetResourceBudgets(const SResourceBudgets& _rBudgets)
+{
+	std::lock_guard<std::mutex> Lock(g_Mutex);
+
+	g_Budgets = _rBudgets;
+}
+
+// -----------------------------------------------------------------------------
+
+void GetResourceStatistics(SResourceStatistics& _rStatistics)
+{
+	std::lock_guard<std::mutex> Lock(g_Mutex);
+
+	_rStatistics = g_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+void PrintResourceReport()
+{
+	SResourceStatistics Statistics;
+	SResourceBudgets    Budgets;
+
+	{
+		std::lock_guard<std::mutex> Lock(g_Mutex);
+
+		Statistics = g_Statistics;
+		Budgets    = g_Budgets;
+	}
+
+	std::cout << "GPU resources: " << Statistics.m_Total.m_NumberOfHandles << " handles, " << Statistics.m_Total.m_NumberOfBytes / 1024 << " KB, high-water mark " << Statistics.m_Total.m_MaxNumberOfBytes / 1024 << " KB, " << Statistics.m_NumberOfBudgetWarnings << " budget warnings, " << Statistics.m_NumberOfUnknownReleases << " unknown releases" << std::endl;
+
+	for(int IndexOfCategory = 0; IndexOfCategory < SResourceCategory::NumberOfTypes; ++ IndexOfCategory)
+	{
+		const SResourceCounters& rCounters = Statistics.m_Categories[IndexOfCategory];
+
+		std::cout << "    " << GetResourceCategoryName(static_cast<SResourceCategory::EType>(IndexOfCategory)) << ": " << rCounters.m_NumberOfHandles << " handles (max " << rCounters.m_MaxNumberOfHandles << "), " << rCounters.m_NumberOfBytes / 1024 << " KB (max " << rCounters.m_MaxNumberOfBytes / 1024 << " KB)";
+
+		if(Budgets.m_NumberOfBytes[IndexOfCategory] != 0)
+		{
+			std::cout << ", budget " << Budgets.m_NumberOfBytes[IndexOfCategory] / 1024 << " KB";
+		}
+
+		std::cout << ", " << rCounters.m_NumberOfCreates << " created, " << rCounters.m_NumberOfReleases << " released" << std::endl;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+int PrintLiveResources()
+{
+	std::vector<std::pair<BHandle, SResource>> Resources;
+
+	{
+		std::lock_guard<std::mutex> Lock(g_Mutex);
+
+		Resources.assign(g_Resources.begin(), g_Resources.end());
+	}
+
+	if(Resources.empty())
+	{
+		std::cout << "All GPU resources were released" << std::endl;
+
+		return 0;
+	}
+
+	std::sort(Resources.begin(), Resources.end(), [](const std::pair<BHandle, SResource>& _rLeft, const std::pair<BHandle, SResource>& _rRight) { return _rLeft.second.m_IndexOfCreate < _rRight.second.m_IndexOfCreate; });
+
+	std::cout << Resources.size() << " GPU resources were not released:" << std::endl;
+
+	for(const std::pair<BHandle, SResource>& rResource : Resources)
+	{
+		std::cout << "    " << rResource.second.m_pSite << ": " << GetResourceCategoryName(rResource.second.m_Category) << " " << rResource.first << ", " << rResource.second.m_NumberOfBytes << " bytes" << std::endl;
+	}
+
+	return static_cast<int>(Resources.size());
+}
+
+// -----------------------------------------------------------------------------
+
+void CreateTrackedTexture(const char* _pPath, BHandle* _ppTexture, const char* _pSite)
+{
+	CreateTexture(_pPath, _ppTexture);
+
+	AddResource(*_ppTexture, SResourceCategory::Texture, GetTextureBytes(_pPath), 0, _pSite);
+}
+
+// -----------------------------------------------------------------------------
+
+void ReleaseTrackedTexture(BHandle _pTexture)
+{
+	RemoveResource(_pTexture, SResourceCategory::Texture);
+
+	ReleaseTexture(_pTexture);
+}
+
+// -----------------------------------------------------------------------------
+
+void CreateTrackedConstantBuffer(int _NumberOfBytes, BHandle* _ppConstantBuffer, const char* _pSite)
+{
+	CreateConstantBuffer(_NumberOfBytes, _ppConstantBuffer);
+
+	AddResource(*_ppConstantBuffer, SResourceCategory::ConstantBuffer, static_cast<size_t>(_NumberOfBytes), 0, _pSite);
+}
+
+// -----------------------------------------------------------------------------
+
+void ReleaseTrackedConstantBuffer(BHandle _pConstantBuffer)
+{
+	RemoveResource(_pConstantBuffer, SResourceCategory::ConstantBuffer);
+
+	ReleaseConstantBuffer(_pConstantBuffer);
+}
+
+// -----------------------------------------------------------------------------
+
+void CreateTrackedVertexShader(const char* _pPath, const char* _pMain, BHandle* _ppShader, const char* _pSite)
+{
+	CreateVertexShader(_pPath, _pMain, _ppShader);
+
+	AddResource(*_ppShader, SResourceCategory::VertexShader, 0, 0, _pSite);
+}
+
+// -----------------------------------------------------------------------------
+
+void ReleaseTrackedVertexShader(BHandle _pShader)
+{
+	RemoveResource(_pShader, SResourceCategory::VertexShader);
+
+	ReleaseVertexShader(_pShader);
+}
+
+// -----------------------------------------------------------------------------
+
+void CreateTrackedPixelShader(const char* _pPath, const char* _pMain, BHandle* _ppShader, const char* _pSite)
+{
+	CreatePixelShader(_pPath, _pMain, _ppShader);
+
+	AddResource(*_ppShader, SResourceCategory::PixelShader, 0, 0, _pSite);
+}
+
+// -----------------------------------------------------------------------------
+
+void ReleaseTrackedPixelShader(BHandle _pShader)
+{
+	RemoveResource(_pShader, SResourceCategory::PixelShader);
+
+	ReleasePixelShader(_pShader);
+}
+
+// -----------------------------------------------------------------------------
+
+void CreateTrackedMaterial(const SMaterialInfo& _rInfo, BHandle* _ppMaterial, const char* _pSite)
+{
+	CreateMaterial(_rInfo, _ppMaterial);
+
+	AddResource(*_ppMaterial, SResourceCategory::Material, 0, GetVertexSize(_rInfo), _pSite);
+}
+
+// -----------------------------------------------------------------------------
+
+void ReleaseTrackedMaterial(BHandle _pMaterial)
+{
+	RemoveResource(_pMaterial, SResourceCategory::Material);
+
+	ReleaseMaterial(_pMaterial);
+}
+
+// -----------------------------------------------------------------------------
+
+void CreateTrackedMesh(const SMeshInfo& _rInfo, BHandle* _ppMesh, const char* _pSite)
+{
+	CreateMesh(_rInfo, _ppMesh);
+
+	// The vertex layout is only known by the material of the mesh.
+	size_t NumberOfBytes = static_cast<size_t>(_rInfo.m_NumberOfVertices) * GetMaterialVertexSize(_rInfo.m_pMaterial) + static_cast<size_t>(_rInfo.m_NumberOfIndices) * sizeof(int);
+
+	AddResource(*_ppMesh, SResourceCategory::Mesh, NumberOfBytes, 0, _pSite);
+}
+
+// -----------------------------------------------------------------------------
+
+void ReleaseTrackedMesh(BHandle _pMesh)
+{
+	RemoveResource(_pMesh, SResourceCategory::Mesh);
+
+	ReleaseMesh(_pMesh);
+}
@@ -0,0 +1,112 @@
+
+#pragma once
+
+#include "yoshix.h"
+
+#include <stddef.h>
+
+// -----------------------------------------------------------------------------
+// Accounting of the YoshiX resources. The tracked create and release functions
+// forward to YoshiX and keep a record of every live handle: its category, the
+// estimated GPU memory and the place in the source which created it.
+//
+// The memory is estimated from what is passed to YoshiX:
+//
+//     textures           size x format x mip levels as stored in the file
+//     constant buffers   the size of the buffer
+//     meshes             vertices x vertex size of the material + indices
+//     shaders, materials only counted, their memory is not known
+//
+// Each category can have a budget. Crossing it prints a warning once, the next
+// warning comes after the category fell below the budget again. At shutdown
+// 'PrintLiveResources' lists all handles which were not released.
+//
+// All functions can be called from any thread.
+// -----------------------------------------------------------------------------
+
+#define RESOURCE_STRINGIZE_VALUE(_Value) #_Value
+#define RESOURCE_STRINGIZE(_Value) RESOURCE_STRINGIZE_VALUE(_Value)
+
+// The place of the call in the form 'file(line)', passed as the creation site.
+#define RESOURCE_SITE __FILE__ "(" RESOURCE_STRINGIZE(__LINE__) ")"
+
+struct SResourceCategory
+{
+	enum EType
+	{
+		Texture,
+		ConstantBuffer,
+		VertexShader,
+		PixelShader,
+		Material,
+		Mesh,
+		NumberOfTypes,
+	};
+};
+
+struct SResourceBudgets
+{
+	SResourceBudgets();
+
+	size_t m_NumberOfBytes[SResourceCategory::NumberOfTypes];  // The budget of each category, 0 means no budget.
+	size_t m_NumberOfTotalBytes;                                // The budget of all categories together, 0 means no budget.
+};
+
+struct SResourceCounters
+{
+	int    m_NumberOfHandles;           // The live handles.
+	size_t m_NumberOfBytes;             // The estimated memory of the live handles.
+	int    m_NumberOfCreates;           // All handles created so far.
+	int    m_NumberOfReleases;          // All handles released so far.
+	int    m_MaxNumberOfHandles;        // The high-water marks of the live handles and their memory.
+	size_t m_MaxNumberOfBytes;
+};
+
+struct SResourceStatistics
+{
+	SResourceCounters m_Categories[SResourceCategory::NumberOfTypes];
+	SResourceCounters m_Total;
+	int               m_NumberOfBudgetWarnings;     // The number of times a budget was crossed.
+	int               m_NumberOfUnknownReleases;    // Releases of handles which were not created by the tracked functions.
+};
+
+const char* GetResourceCategoryName(SResourceCategory::EType _Category);
+
+void SetResourceBudgets(const SResourceBudgets& _rBudgets);
+
+// -----------------------------------------------------------------------------
+// Copies the current counters. The counters are kept up to date by the create
+// and release functions, so this is cheap enough to be polled every frame.
+// -----------------------------------------------------------------------------
+void GetResourceStatistics(SResourceStatistics& _rStatistics);
+
+// Prints the counters and the budget of each category.
+void PrintResourceReport();
+
+// -----------------------------------------------------------------------------
+// Prints every live handle with its category, memory and creation site, oldest
+// first. Returns the number of live handles.
+// -----------------------------------------------------------------------------
+int PrintLiveResources();
+
+// -----------------------------------------------------------------------------
+// The tracked versions of the YoshiX create and release functions. Pass
+// 'RESOURCE_SITE' as the creation site.
+// -----------------------------------------------------------------------------
+void CreateTrackedTexture(const char* _pPath, gfx::BHandle* _ppTexture, const char* _pSite);
+void ReleaseTrackedTexture(gfx::BHandle _pTexture);
+
+void CreateTrackedConstantBuffer(int _NumberOfBytes, gfx::BHandle* _ppConstantBuffer, const char* _pSite);
+void ReleaseTrackedConstantBuffer(gfx::BHandle _pConstantBuffer);
+
+void CreateTrackedVertexShader(const char* _pPath, const char* _pMain, gfx::BHandle* _ppShader, const char* _pSite);
+void ReleaseTrackedVertexShader(gfx::BHandle _pShader);
+
+void CreateTrackedPixelShader(const char* _pPath, const char* _pMain, gfx::BHandle* _ppShader, const char* _pSite);
+void ReleaseTrackedPixelShader(gfx::BHandle _pShader);
+
+void CreateTrackedMaterial(const gfx::SMaterialInfo& _rInfo, gfx::BHandle* _ppMaterial, const char* _pSite);
+void ReleaseTrackedMaterial(gfx::BHandle _pMaterial);
+
+void CreateTrackedMesh(const gfx::SMeshInfo& _rInfo, gfx::BHandle* _ppMesh, const char* _pSite);
+void ReleaseTrackedMesh(gfx::BHandle _pMesh);
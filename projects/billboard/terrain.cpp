@@ -0,0 +1,666 @@
+
+#include "terrain.h"
+#include "dds_file.h"
+#include "parallel.h"
+#include "resource_tracking.h"
+
+#include <math.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+using namespace gfx;
+
+namespace
+{
+	// The number of floats of a chunk vertex: Position (3D), TexCoord (2D).
+	const int g_NumberOfFloatsPerTerrainVertex = 5;
+
+	int GetLevel(uint64_t _Key) { return static_cast<int>(_Key >> 56); }
+	int GetX    (uint64_t _Key) { return static_cast<int>((_Key >> 28) & 0xFFFFFFF); }
+	int GetZ    (uint64_t _Key) { return static_cast<int>(_Key & 0xFFFFFFF); }
+
+	// -----------------------------------------------------------------------------
+	// Adds a triangle to the index list so that its front side faces along the
+	// given direction. Front faces are counter-clockwise like in the rest of the
+	// application.
+	// -----------------------------------------------------------------------------
+	void AddFacingTriangle(const std::vector<float>& _rVertices, int _A, int _B, int _C, const float* _pDirection, std::vector<int>& _rIndices)
+	{
+		const float* pA = &_rVertices[_A * g_NumberOfFloatsPerTerrainVertex];
+		const float* pB = &_rVertices[_B * g_NumberOfFloatsPerTerrainVertex];
+		const float* pC = &_rVertices[_C * g_NumberOfFloatsPerTerrainVertex];
+
+		float Edge1[3] = { pB[0] - pA[0], pB[1] - pA[1], pB[2] - pA[2] };
+		float Edge2[3] = { pC[0] - pA[0], pC[1] - pA[1], pC[2] - pA[2] };
+		float Normal[3];
+
+		GetCrossProduct(Edge2, Edge1, Normal);
+
+		bool IsFacing = GetDotProduct3D(Normal, _pDirection) >= 0.0f;
+
+		_rIndices.push_back(_A);
+		_rIndices.push_back(IsFacing ? _B : _C);
+		_rIndices.push_back(IsFacing ? _C : _B);
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+STerrainSettings::STerrainSettings()
+	: m_Size                 (64.0f)
+	, m_HeightScale          (4.0f)
+	, m_TextureRepeat        (8.0f)
+	, m_NumberOfCellsPerChunk(32)
+	, m_NumberOfLevels       (5)
+	, m_LodDistanceFactor    (2.0f)
+	, m_NumberOfThreads      (0)
+	, m_MaxUploadsPerFrame   (8)
+	, m_MaxCachedChunks      (256)
+{
+	m_Origin[0] = -32.0f;
+	m_Origin[1] = -1.0f;
+	m_Origin[2] = -32.0f;
+}
+
+// -----------------------------------------------------------------------------
+
+CTerrain::CTerrain()
+	: m_pMaterial       (nullptr)
+	, m_HeightmapWidth  (0)
+	, m_HeightmapHeight (0)
+	, m_MinHeight       (0.0f)
+	, m_MaxHeight       (0.0f)
+	, m_Frame           (0)
+	, m_LodDistanceScale(1.0f)
+	, m_IsStopping      (false)
+{
+	memset(m_CameraPosition, 0, sizeof(m_CameraPosition));
+	memset(&m_Frustum,       0, sizeof(m_Frustum));
+	memset(&m_Statistics,    0, sizeof(m_Statistics));
+}
+
+// -----------------------------------------------------------------------------
+
+CTerrain::~CTerrain()
+{
+	Release();
+}
+
+// -----------------------------------------------------------------------------
+
+uint64_t CTerrain::GetKey(int _Level, int _X, int _Z)
+{
+	return (static_cast<uint64_t>(_Level) << 56) | (static_cast<uint64_t>(_X) << 28) | static_cast<uint64_t>(_Z);
+}
+
+// -----------------------------------------------------------------------------
+
+bool CTerrain::Create(const STerrainSettings& _rSettings, const char* _pHeightmapPath, BHandle _pMaterial)
+{
+	Release();
+
+	m_Settings  = _rSettings;
+	m_pMaterial = _pMaterial;
+	m_Frame     = 0;
+
+	m_Settings.m_NumberOfLevels        = std::min(std::max(m_Settings.m_NumberOfLevels, 1), 16);
+	m_Settings.m_NumberOfCellsPerChunk = std::max(m_Settings.m_NumberOfCellsPerChunk, 1);
+
+	bool HasHeightmap = LoadHeightmap(_pHeightmapPath);
+
+	// -----------------------------------------------------------------------------
+	// Build the root chunk right away, everything else is built on demand.
+	// -----------------------------------------------------------------------------
+	SChunkData Root;
+
+	BuildChunk(GetKey(0, 0, 0), Root);
+	CreateChunkMesh(Root);
+
+	m_IsStopping = false;
+
+	int NumberOfWorkers = _rSettings.m_NumberOfThreads > 0 ? _rSettings.m_NumberOfThreads : std::max(GetNumberOfWorkerThreads(0) - 1, 1);
+
+	for(int IndexOfWorker = 0; IndexOfWorker < NumberOfWorkers; ++ IndexOfWorker)
+	{
+		m_Workers.emplace_back(&CTerrain::RunWorker, this);
+	}
+
+	return HasHeightmap;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::Release()
+{
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+
+		m_IsStopping = true;
+	}
+
+	m_WorkAvailable.notify_all();
+
+	for(std::thread& rWorker : m_Workers)
+	{
+		rWorker.join();
+	}
+
+	m_Workers .clear();
+	m_Jobs    .clear();
+	m_Finished.clear();
+	m_Pending .clear();
+	m_Selected.clear();
+
+	for(std::pair<const uint64_t, SChunk>& rChunk : m_Chunks)
+	{
+		ReleaseTrackedMesh(rChunk.second.m_pMesh);
+	}
+
+	m_Chunks.clear();
+}
+
+// -----------------------------------------------------------------------------
+
+bool CTerrain::LoadHeightmap(const char* _pPath)
+{
+	m_Heights.clear();
+
+	std::string Path = _pPath != nullptr ? _pPath : "";
+
+	if(Path.size() > 4 && Path.compare(Path.size() - 4, 4, ".dds") == 0)
+	{
+		SDDSInfo                   Info;
+		std::vector<unsigned char> Pixels;
+
+		if(ReadDDSInfo(_pPath, Info) && ReadDDSLevel(_pPath, Info, 0, Pixels))
+		{
+			m_HeightmapWidth  = Info.m_Width;
+			m_HeightmapHeight = Info.m_Height;
+
+			m_Heights.resize(static_cast<size_t>(m_HeightmapWidth) * m_HeightmapHeight);
+
+			for(size_t IndexOfSample = 0; IndexOfSample < m_Heights.size(); ++ IndexOfSample)
+			{
+				m_Heights[IndexOfSample] = Pixels[IndexOfSample * 4] / 255.0f * m_Settings.m_HeightScale;
+			}
+		}
+	}
+	else if(!Path.empty())
+	{
+		// Raw files are square with 16 bit little endian samples.
+		std::ifstream Stream(_pPath, std::ios::binary | std::ios::ate);
+
+		if(Stream)
+		{
+			size_t NumberOfSamples = static_cast<size_t>(Stream.tellg()) / 2;
+			int    Size            = static_cast<int>(sqrt(static_cast<double>(NumberOfSamples)));
+
+			std::vector<unsigned short> Samples(static_cast<size_t>(Size) * Size);
+
+			Stream.seekg(0);
+
+			if(Size > 1 && Stream.read(reinterpret_cast<char*>(Samples.data()), static_cast<std::streamsize>(Samples.size() * 2)))
+			{
+				m_HeightmapWidth  = Size;
+				m_HeightmapHeight = Size;
+
+				m_Heights.resize(Samples.size());
+
+				for(size_t IndexOfSample = 0; IndexOfSample < m_Heights.size(); ++ IndexOfSample)
+				{
+					m_Heights[IndexOfSample] = Samples[IndexOfSample] / 65535.0f * m_Settings.m_HeightScale;
+				}
+			}
+		}
+	}
+
+	if(m_Heights.empty())
+	{
+		std::cout << "Could not load heightmap " << Path << ", using a flat terrain" << std::endl;
+
+		m_HeightmapWidth  = 2;
+		m_HeightmapHeight = 2;
+
+		m_Heights.assign(4, 0.0f);
+	}
+
+	m_MinHeight = *std::min_element(m_Heights.begin(), m_Heights.end());
+	m_MaxHeight = *std::max_element(m_Heights.begin(), m_Heights.end());
+
+	return m_HeightmapWidth > 2;
+}
+
+// -----------------------------------------------------------------------------
+
+float CTerrain::GetSample(int _X, int _Z) const
+{
+	_X = std::min(std::max(_X, 0), m_HeightmapWidth  - 1);
+	_Z = std::min(std::max(_Z, 0), m_HeightmapHeight - 1);
+
+	return m_Heights[static_cast<size_t>(_Z) * m_HeightmapWidth + _X];
+}
+
+// -----------------------------------------------------------------------------
+// Bilinear height at the normalized terrain position (0..1, 0..1).
+// -----------------------------------------------------------------------------
+float CTerrain::GetHeightAt(double _U, double _V) const
+{
+	double X = std::min(std::max(_U, 0.0), 1.0) * (m_HeightmapWidth  - 1);
+	double Z = std::min(std::max(_V, 0.0), 1.0) * (m_HeightmapHeight - 1);
+
+	int   X0 = static_cast<int>(X);
+	int   Z0 = static_cast<int>(Z);
+	float FX = static_cast<float>(X - X0);
+	float FZ = static_cast<float>(Z - Z0);
+
+	float Top    = GetSample(X0, Z0    ) * (1.0f - FX) + GetSample(X0 + 1, Z0    ) * FX;
+	float Bottom = GetSample(X0, Z0 + 1) * (1.0f - FX) + GetSample(X0 + 1, Z0 + 1) * FX;
+
+	return m_Settings.m_Origin[1] + Top * (1.0f - FZ) + Bottom * FZ;
+}
+
+// -----------------------------------------------------------------------------
+
+float CTerrain::GetHeight(float _X, float _Z) const
+{
+	return GetHeightAt((_X - m_Settings.m_Origin[0]) / m_Settings.m_Size, (_Z - m_Settings.m_Origin[2]) / m_Settings.m_Size);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::SetLodDistanceScale(float _Scale)
+{
+	m_LodDistanceScale = _Scale;
+}
+
+// -----------------------------------------------------------------------------
+
+const STerrainStatistics& CTerrain::GetStatistics() const
+{
+	return m_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::GetNodeBounds(int _Level, int _X, int _Z, float* _pMin, float* _pMax) const
+{
+	float NodeSize = m_Settings.m_Size / static_cast<float>(1 << _Level);
+
+	_pMin[0] = m_Settings.m_Origin[0] + _X * NodeSize;
+	_pMin[1] = m_Settings.m_Origin[1] + m_MinHeight;
+	_pMin[2] = m_Settings.m_Origin[2] + _Z * NodeSize;
+
+	_pMax[0] = _pMin[0] + NodeSize;
+	_pMax[1] = m_Settings.m_Origin[1] + m_MaxHeight;
+	_pMax[2] = _pMin[2] + NodeSize;
+}
+
+// -----------------------------------------------------------------------------
+// Builds the grid of a chunk plus a skirt along each border. Runs on the worker
+// threads and must only read the heightmap.
+// -----------------------------------------------------------------------------
+void CTerrain::BuildChunk(uint64_t _Key, SChunkData& _rData) const
+{
+	int Level          = GetLevel(_Key);
+	int NodeX          = GetX(_Key);
+	int NodeZ          = GetZ(_Key);
+	int NumberOfCells  = m_Settings.m_NumberOfCellsPerChunk;
+	int NumberOfPoints = NumberOfCells + 1;
+
+	// -----------------------------------------------------------------------------
+	// Sample positions are computed on the grid of the finest level, so borders
+	// shared with coarser neighbors hit exactly the same heights.
+	// -----------------------------------------------------------------------------
+	int    Step          = 1 << (m_Settings.m_NumberOfLevels - 1 - Level);
+	double FinestPoints  = static_cast<double>(NumberOfCells) * (1 << (m_Settings.m_NumberOfLevels - 1));
+
+	_rData.m_Key = _Key;
+	_rData.m_Vertices.clear();
+	_rData.m_Indices .clear();
+	_rData.m_Vertices.reserve((NumberOfPoints * NumberOfPoints + 4 * NumberOfPoints) * g_NumberOfFloatsPerTerrainVertex);
+	_rData.m_Indices .reserve((NumberOfCells * NumberOfCells + 4 * NumberOfCells) * 6);
+
+	for(int Z = 0; Z < NumberOfPoints; ++ Z)
+	{
+		for(int X = 0; X < NumberOfPoints; ++ X)
+		{
+			double U = static_cast<double>((NodeX * NumberOfCells + X) * Step) / FinestPoints;
+			double V = static_cast<double>((NodeZ * NumberOfCells + Z) * Step) / FinestPoints;
+
+			float WorldX = m_Settings.m_Origin[0] + static_cast<float>(U * m_Settings.m_Size);
+			float WorldZ = m_Settings.m_Origin[2] + static_cast<float>(V * m_Settings.m_Size);
+			float WorldY = GetHeightAt(U, V);
+
+			float Vertex[g_NumberOfFloatsPerTerrainVertex] = { WorldX, WorldY, WorldZ, WorldX / m_Settings.m_TextureRepeat, -WorldZ / m_Settings.m_TextureRepeat };
+
+			_rData.m_Vertices.insert(_rData.m_Vertices.end(), Vertex, Vertex + g_NumberOfFloatsPerTerrainVertex);
+		}
+	}
+
+	for(int Z = 0; Z < NumberOfCells; ++ Z)
+	{
+		for(int X = 0; X < NumberOfCells; ++ X)
+		{
+			int A = Z * NumberOfPoints + X;
+			int B = A + 1;
+			int C = A + NumberOfPoints + 1;
+			int D = A + NumberOfPoints;
+
+			_rData.m_Indices.push_back(A); _rData.m_Indices.push_back(B); _rData.m_Indices.push_back(C);
+			_rData.m_Indices.push_back(A); _rData.m_Indices.push_back(C); _rData.m_Indices.push_back(D);
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+	// A neighbor of any level samples its edge from the finest grid along the same
+	// border and interpolates linearly in between, so its edge stays within the
+	// height range of the finest samples of that border. A skirt reaching from
+	// each of our border vertices below the lowest of these samples covers the gap
+	// to any neighbor, whichever of the two edges is higher.
+	// -----------------------------------------------------------------------------
+	float FinestCellSize  = m_Settings.m_Size / static_cast<float>(FinestPoints);
+	int   FinestPerBorder = NumberOfCells * Step;
+
+	// Start point, direction along the border, and outward direction of each side.
+	const int   Starts    [4]    = { 0, NumberOfCells, NumberOfPoints * NumberOfPoints - 1, NumberOfCells * NumberOfPoints };
+	const int   Strides   [4]    = { 1, NumberOfPoints, -1, -NumberOfPoints };
+	const float Outwards  [4][3] = { { 0.0f, 0.0f, -1.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { -1.0f, 0.0f, 0.0f } };
+
+	// The finest grid position of the start of each side and the step along it.
+	const int   FinestStarts [4][2] = { { 0, 0 }, { FinestPerBorder, 0 }, { FinestPerBorder, FinestPerBorder }, { 0, FinestPerBorder } };
+	const int   FinestStrides[4][2] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+
+	for(int Side = 0; Side < 4; ++ Side)
+	{
+		float BorderMin =  1.0e30f;
+		float BorderMax = -1.0e30f;
+
+		for(int IndexOfSample = 0; IndexOfSample <= FinestPerBorder; ++ IndexOfSample)
+		{
+			int FinestX = NodeX * FinestPerBorder + FinestStarts[Side][0] + IndexOfSample * FinestStrides[Side][0];
+			int FinestZ = NodeZ * FinestPerBorder + FinestStarts[Side][1] + IndexOfSample * FinestStrides[Side][1];
+
+			float Height = GetHeightAt(FinestX / FinestPoints, FinestZ / FinestPoints);
+
+			BorderMin = std::min(BorderMin, Height);
+			BorderMax = std::max(BorderMax, Height);
+		}
+
+		// Our own border vertices are among these samples, so none of them is above the maximum.
+		float SkirtDepth = (BorderMax - BorderMin) + FinestCellSize * 0.5f;
+
+		int FirstSkirtVertex = static_cast<int>(_rData.m_Vertices.size()) / g_NumberOfFloatsPerTerrainVertex;
+
+		for(int IndexOfPoint = 0; IndexOfPoint < NumberOfPoints; ++ IndexOfPoint)
+		{
+			int IndexOfTop = Starts[Side] + IndexOfPoint * Strides[Side];
+
+			float Vertex[g_NumberOfFloatsPerTerrainVertex];
+
+			memcpy(Vertex, &_rData.m_Vertices[IndexOfTop * g_NumberOfFloatsPerTerrainVertex], sizeof(Vertex));
+
+			Vertex[1] -= SkirtDepth;
+
+			_rData.m_Vertices.insert(_rData.m_Vertices.end(), Vertex, Vertex + g_NumberOfFloatsPerTerrainVertex);
+		}
+
+		for(int IndexOfCell = 0; IndexOfCell < NumberOfCells; ++ IndexOfCell)
+		{
+			int Top0    = Starts[Side] + IndexOfCell * Strides[Side];
+			int Top1    = Top0 + Strides[Side];
+			int Bottom0 = FirstSkirtVertex + IndexOfCell;
+			int Bottom1 = Bottom0 + 1;
+
+			AddFacingTriangle(_rData.m_Vertices, Top0, Top1, Bottom1, Outwards[Side], _rData.m_Indices);
+			AddFacingTriangle(_rData.m_Vertices, Top0, Bottom1, Bottom0, Outwards[Side], _rData.m_Indices);
+		}
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::CreateChunkMesh(SChunkData& _rData)
+{
+	SMeshInfo MeshInfo;
+	SChunk    Chunk;
+
+	MeshInfo.m_pVertices        = _rData.m_Vertices.data();
+	MeshInfo.m_NumberOfVertices = static_cast<int>(_rData.m_Vertices.size()) / g_NumberOfFloatsPerTerrainVertex;
+	MeshInfo.m_pIndices         = _rData.m_Indices.data();
+	MeshInfo.m_NumberOfIndices  = static_cast<int>(_rData.m_Indices.size());
+	MeshInfo.m_pMaterial        = m_pMaterial;
+
+	CreateTrackedMesh(MeshInfo, &Chunk.m_pMesh, RESOURCE_SITE);
+
+	Chunk.m_LastUsedFrame = m_Frame;
+
+	m_Chunks [_rData.m_Key] = Chunk;
+	m_Pending.erase(_rData.m_Key);
+
+	++ m_Statistics.m_NumberOfUploadedChunks;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::Update(const float* _pCameraPosition, const float* _pViewProjectionMatrix)
+{
+	std::vector<SChunkData> Uploads;
+
+	++ m_Frame;
+
+	m_Statistics.m_NumberOfVisibleChunks  = 0;
+	m_Statistics.m_NumberOfCulledNodes    = 0;
+	m_Statistics.m_NumberOfUploadedChunks = 0;
+
+	// -----------------------------------------------------------------------------
+	// Take over a limited number of finished chunks, so a burst of finished work
+	// does not stall a single frame. Meshes can only be created on this thread.
+	// -----------------------------------------------------------------------------
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+
+		while(!m_Finished.empty() && static_cast<int>(Uploads.size()) < m_Settings.m_MaxUploadsPerFrame)
+		{
+			Uploads.push_back(std::move(m_Finished.back()));
+
+			m_Finished.pop_back();
+		}
+	}
+
+	for(SChunkData& rData : Uploads)
+	{
+		CreateChunkMesh(rData);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Select the chunks for this frame.
+	// -----------------------------------------------------------------------------
+	memcpy(m_CameraPosition, _pCameraPosition, sizeof(m_CameraPosition));
+
+	GetFrustum(_pViewProjectionMatrix, m_Frustum);
+
+	m_Selected.clear();
+
+	SelectNode(0, 0, 0);
+
+	EvictChunks();
+
+	m_Statistics.m_NumberOfVisibleChunks = static_cast<int>(m_Selected.size());
+	m_Statistics.m_NumberOfCachedChunks  = static_cast<int>(m_Chunks.size());
+	m_Statistics.m_NumberOfPendingChunks = static_cast<int>(m_Pending.size());
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::SelectNode(int _Level, int _X, int _Z)
+{
+	float Min[3];
+	float Max[3];
+
+	GetNodeBounds(_Level, _X, _Z, Min, Max);
+
+	if(!IsBoxVisible(m_Frustum, Min, Max))
+	{
+		++ m_Statistics.m_NumberOfCulledNodes;
+
+		return;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Split the node if the camera is close to it compared to its size and the
+	// children are ready. Otherwise draw the node and ask for the children.
+	// -----------------------------------------------------------------------------
+	float Distance[3];
+
+	for(int Axis = 0; Axis < 3; ++ Axis)
+	{
+		Distance[Axis] = std::max(std::max(Min[Axis] - m_CameraPosition[Axis], m_CameraPosition[Axis] - Max[Axis]), 0.0f);
+	}
+
+	float NodeSize = Max[0] - Min[0];
+	bool  IsNear   = sqrtf(GetDotProduct3D(Distance, Distance)) < NodeSize * m_Settings.m_LodDistanceFactor * m_LodDistanceScale;
+
+	if(IsNear && _Level + 1 < m_Settings.m_NumberOfLevels)
+	{
+		bool AreChildrenReady = true;
+
+		for(int Child = 0; Child < 4; ++ Child)
+		{
+			AreChildrenReady &= IsChunkReady(_Level + 1, _X * 2 + Child % 2, _Z * 2 + Child / 2);
+		}
+
+		if(AreChildrenReady)
+		{
+			for(int Child = 0; Child < 4; ++ Child)
+			{
+				SelectNode(_Level + 1, _X * 2 + Child % 2, _Z * 2 + Child / 2);
+			}
+
+			return;
+		}
+	}
+
+	if(IsChunkReady(_Level, _X, _Z))
+	{
+		m_Selected.push_back(GetKey(_Level, _X, _Z));
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+bool CTerrain::IsChunkReady(int _Level, int _X, int _Z)
+{
+	uint64_t Key = GetKey(_Level, _X, _Z);
+
+	std::unordered_map<uint64_t, SChunk>::iterator Chunk = m_Chunks.find(Key);
+
+	if(Chunk == m_Chunks.end())
+	{
+		RequestChunk(Key);
+
+		return false;
+	}
+
+	Chunk->second.m_LastUsedFrame = m_Frame;
+
+	return true;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::RequestChunk(uint64_t _Key)
+{
+	if(!m_Pending.insert(_Key).second)
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+
+		m_Jobs.push_back(_Key);
+	}
+
+	m_WorkAvailable.notify_one();
+}
+
+// -----------------------------------------------------------------------------
+// Releases the least recently used chunks not needed in this frame until the
+// cache fits into its budget. The root chunk is always kept.
+// -----------------------------------------------------------------------------
+void CTerrain::EvictChunks()
+{
+	if(static_cast<int>(m_Chunks.size()) <= m_Settings.m_MaxCachedChunks)
+	{
+		return;
+	}
+
+	std::vector<std::pair<int, uint64_t>> Candidates;
+
+	for(const std::pair<const uint64_t, SChunk>& rChunk : m_Chunks)
+	{
+		if(rChunk.second.m_LastUsedFrame != m_Frame && rChunk.first != GetKey(0, 0, 0))
+		{
+			Candidates.push_back(std::make_pair(rChunk.second.m_LastUsedFrame, rChunk.first));
+		}
+	}
+
+	std::sort(Candidates.begin(), Candidates.end());
+
+	for(size_t IndexOfCandidate = 0; IndexOfCandidate < Candidates.size() && static_cast<int>(m_Chunks.size()) > m_Settings.m_MaxCachedChunks; ++ IndexOfCandidate)
+	{
+		std::unordered_map<uint64_t, SChunk>::iterator Chunk = m_Chunks.find(Candidates[IndexOfCandidate].second);
+
+		ReleaseTrackedMesh(Chunk->second.m_pMesh);
+
+		m_Chunks.erase(Chunk);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::Draw()
+{
+	for(uint64_t Key : m_Selected)
+	{
+		DrawMesh(m_Chunks[Key].m_pMesh);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+void CTerrain::RunWorker()
+{
+	for(;;)
+	{
+		uint64_t Key;
+
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+
+			m_WorkAvailable.wait(Lock, [this]() { return m_IsStopping || !m_Jobs.empty(); });
+
+			if(m_IsStopping)
+			{
+				return;
+			}
+
+			Key = m_Jobs.front();
+
+			m_Jobs.pop_front();
+		}
+
+		SChunkData Data;
+
+		BuildChunk(Key, Data);
+
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+
+			m_Finished.push_back(std::move(Data));
+		}
+	}
+}
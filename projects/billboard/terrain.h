@@ -0,0 +1,151 @@
+
+#pragma once
+
+#include "yoshix.h"
+#include "frustum.h"
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Heightfield terrain split into a quadtree of chunks. Every chunk has the same
+// number of vertices, so deeper levels of the tree have more detail per world
+// unit. Each frame the tree is traversed from the root and a node is split
+// into its four children while the camera is close compared to its size.
+// Only the selected chunks inside of the view frustum are drawn, so the cost
+// depends on the view and not on the size of the world.
+//
+// The vertex and index data of a chunk is built on worker threads. The main
+// thread only turns finished chunks into YoshiX meshes and keeps them in a
+// cache for later frames. Until all children of a node are ready the node
+// itself is drawn. Cracks between neighbors of different detail are hidden by
+// skirts hanging down from the chunk borders.
+//
+// The chunk vertices use the layout of the ground material: Position (3D),
+// TexCoord (2D), in world space.
+// -----------------------------------------------------------------------------
+
+struct STerrainSettings
+{
+	STerrainSettings();
+
+	float m_Origin[3];                  // The world position of the terrain corner with the smallest x and z.
+	float m_Size;                       // The edge length of the square terrain in world units.
+	float m_HeightScale;                // The height of a heightmap value of 1.
+	float m_TextureRepeat;              // The world size covered by one repeat of the ground texture.
+	int   m_NumberOfCellsPerChunk;      // The number of grid cells along the edge of a chunk.
+	int   m_NumberOfLevels;             // The depth of the quadtree, level 0 is one chunk covering the whole terrain.
+	float m_LodDistanceFactor;          // A node is split if the camera is closer than its size times this factor.
+	int   m_NumberOfThreads;            // The number of worker threads building chunks. Zero uses one thread per core minus one.
+	int   m_MaxUploadsPerFrame;         // The number of finished chunks turned into meshes per frame.
+	int   m_MaxCachedChunks;            // The number of chunk meshes kept alive before unused ones are released.
+};
+
+struct STerrainStatistics
+{
+	int m_NumberOfVisibleChunks;        // Chunks selected by the level of detail inside of the view frustum, i.e. drawn chunks.
+	int m_NumberOfCulledNodes;          // Quadtree nodes skipped because they are outside of the view frustum.
+	int m_NumberOfCachedChunks;         // Chunk meshes currently alive.
+	int m_NumberOfPendingChunks;        // Chunks queued or being built on the worker threads.
+	int m_NumberOfUploadedChunks;       // Chunk meshes created this frame.
+};
+
+class CTerrain
+{
+public:
+
+	CTerrain();
+	~CTerrain();
+
+public:
+
+	// -----------------------------------------------------------------------------
+	// Loads the heightmap and starts the worker threads. The heightmap can be a DDS
+	// file (the red channel is used) or a square raw file with 16 bit heights.
+	// If it can not be loaded the terrain is flat. The root chunk is built right
+	// away, so there is always something to draw.
+	// -----------------------------------------------------------------------------
+	bool Create(const STerrainSettings& _rSettings, const char* _pHeightmapPath, gfx::BHandle _pMaterial);
+	void Release();
+
+	// Selects the chunks for the given camera and requests missing ones.
+	void Update(const float* _pCameraPosition, const float* _pViewProjectionMatrix);
+	void Draw();
+
+	// Returns the terrain height at a world position.
+	float GetHeight(float _X, float _Z) const;
+
+	// Scales the split distance of 'm_LodDistanceFactor', values below 1 select coarser chunks.
+	void SetLodDistanceScale(float _Scale);
+
+	const STerrainStatistics& GetStatistics() const;
+
+private:
+
+	struct SChunkData
+	{
+		uint64_t           m_Key;
+		std::vector<float> m_Vertices;
+		std::vector<int>   m_Indices;
+	};
+
+	struct SChunk
+	{
+		gfx::BHandle m_pMesh;
+		int          m_LastUsedFrame;
+	};
+
+private:
+
+	static uint64_t GetKey(int _Level, int _X, int _Z);
+
+	bool LoadHeightmap(const char* _pPath);
+	float GetSample(int _X, int _Z) const;
+	float GetHeightAt(double _U, double _V) const;
+	void GetNodeBounds(int _Level, int _X, int _Z, float* _pMin, float* _pMax) const;
+
+	void BuildChunk(uint64_t _Key, SChunkData& _rData) const;
+	void CreateChunkMesh(SChunkData& _rData);
+
+	void SelectNode(int _Level, int _X, int _Z);
+	bool IsChunkReady(int _Level, int _X, int _Z);
+	void RequestChunk(uint64_t _Key);
+	void EvictChunks();
+
+	void RunWorker();
+
+private:
+
+	STerrainSettings   m_Settings;
+	gfx::BHandle       m_pMaterial;
+
+	int                m_HeightmapWidth;
+	int                m_HeightmapHeight;
+	std::vector<float> m_Heights;           // Heightmap values scaled to world units, rows along z.
+	float              m_MinHeight;
+	float              m_MaxHeight;
+
+	int                m_Frame;
+	float              m_LodDistanceScale;
+	float              m_CameraPosition[3];
+	SFrustum           m_Frustum;
+
+	std::unordered_map<uint64_t, SChunk> m_Chunks;      // The cached chunk meshes.
+	std::unordered_set<uint64_t>         m_Pending;     // Requested chunks which are not finished yet.
+	std::vector<uint64_t>                m_Selected;    // The visible chunks of this frame.
+	STerrainStatistics                   m_Statistics;
+
+	// The state shared with the worker threads, guarded by 'm_Mutex'.
+	std::vector<std::thread>  m_Workers;
+	std::mutex                m_Mutex;
+	std::condition_variable   m_WorkAvailable;
+	std::deque<uint64_t>      m_Jobs;
+	std::vector<SChunkData>   m_Finished;
+	bool                      m_IsStopping;
+};
@@ -0,0 +1,734 @@
+
+#include "texture_streaming.h"
+#include "dds_file.h"
+#include "resource_tracking.h"
+
+#include <ctype.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#include <direct.h>
+#endif
+
+using namespace gfx;
+
+namespace
+{
+	// -----------------------------------------------------------------------------
+	// Halves an RGBA image with a box filter. A side of one pixel stays one pixel.
+	// -----------------------------------------------------------------------------
+	void Downsample(const std::vector<unsigned char>& _rSource, int _Width, int _Height, std::vector<unsigned char>& _rTarget)
+	{
+		int TargetWidth  = std::max(_Width  / 2, 1);
+		int TargetHeight = std::max(_Height / 2, 1);
+
+		_rTarget.resize(static_cast<size_t>(TargetWidth) * TargetHeight * 4);
+
+		for(int Y = 0; Y < TargetHeight; ++ Y)
+		{
+			int Y0 = std::min(Y * 2,     _Height - 1);
+			int Y1 = std::min(Y * 2 + 1, _Height - 1);
+
+			for(int X = 0; X < TargetWidth; ++ X)
+			{
+				int X0 = std::min(X * 2,     _Width - 1);
+				int X1 = std::min(X * 2 + 1, _Width - 1);
+
+				for(int Channel = 0; Channel < 4; ++ Channel)
+				{
+					int Sum = _rSource[(static_cast<size_t>(Y0) * _Width + X0) * 4 + Channel]
+					        + _rSource[(static_cast<size_t>(Y0) * _Width + X1) * 4 + Channel]
+					        + _rSource[(static_cast<size_t>(Y1) * _Width + X0) * 4 + Channel]
+					        + _rSource[(static_cast<size_t>(Y1) * _Width + X1) * 4 + Channel];
+
+					_rTarget[(static_cast<size_t>(Y) * TargetWidth + X) * 4 + Channel] = static_cast<unsigned char>((Sum + 2) / 4);
+				}
+			}
+		}
+	}
+
+	// -----------------------------------------------------------------------------
+
+	int GetNumberOfLevels(int _Width, int _Height)
+	{
+		int NumberOfLevels = 1;
+
+		for(int Size = std::max(_Width, _Height); Size > 1; Size /= 2)
+		{
+			++ NumberOfLevels;
+		}
+
+		return NumberOfLevels;
+	}
+
+	// -----------------------------------------------------------------------------
+
+	bool HasExtension(const std::string& _rPath, const char* _pExtension)
+	{
+		size_t Length = strlen(_pExtension);
+
+		if(_rPath.size() < Length)
+		{
+			return false;
+		}
+
+		for(size_t IndexOfCharacter = 0; IndexOfCharacter < Length; ++ IndexOfCharacter)
+		{
+			if(tolower(_rPath[_rPath.size() - Length + IndexOfCharacter]) != tolower(_pExtension[IndexOfCharacter]))
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Creates the directory if it does not exist yet. Its parent has to exist.
+	// -----------------------------------------------------------------------------
+	bool MakeDirectory(const std::string& _rPath)
+	{
+		struct stat Status;
+
+		if(stat(_rPath.c_str(), &Status) == 0)
+		{
+			return (Status.st_mode & S_IFDIR) != 0;
+		}
+
+#ifdef _WIN32
+		return _mkdir(_rPath.c_str()) == 0;
+#else
+		return mkdir(_rPath.c_str(), 0777) == 0;
+#endif
+	}
+
+	// -----------------------------------------------------------------------------
+	// FNV-1a, keeps the cache files of textures with the same name in different
+	// directories apart.
+	// -----------------------------------------------------------------------------
+	uint32_t GetPathHash(const std::string& _rPath)
+	{
+		uint32_t Hash = 2166136261u;
+
+		for(char Character : _rPath)
+		{
+			Hash = (Hash ^ static_cast<unsigned char>(Character)) * 16777619u;
+		}
+
+		return Hash;
+	}
+} // namespace
+
+// -----------------------------------------------------------------------------
+
+STextureStreamingSettings::STextureStreamingSettings()
+	: m_BudgetInBytes  (4 * 1024 * 1024)
+	, m_MinResidentSize(32)
+	, m_EvictionDelay  (120)
+	, m_LevelBias      (0.0f)
+	, m_CacheDirectory ("..\\cache")
+{
+}
+
+// -----------------------------------------------------------------------------
+
+float GetProjectedSize(const float* _pProjectionMatrix, int _ScreenHeight, float _WorldSize, float _Distance)
+{
+	// -----------------------------------------------------------------------------
+	// The second diagonal entry of the projection is the cotangent of half the
+	// vertical view angle. It maps a height at distance one onto the -1..1 range
+	// of the screen, i.e. onto half of the screen height.
+	// -----------------------------------------------------------------------------
+	return _WorldSize * _pProjectionMatrix[5] * 0.5f * static_cast<float>(_ScreenHeight) / std::max(_Distance, 1.0e-3f);
+}
+
+// -----------------------------------------------------------------------------
+
+CTextureStreamer::CTextureStreamer()
+	: m_LatencySum(0.0)
+	, m_IsStopping(false)
+{
+	memset(&m_Statistics, 0, sizeof(m_Statistics));
+}
+
+// -----------------------------------------------------------------------------
+
+CTextureStreamer::~CTextureStreamer()
+{
+	Release();
+}
+
+// -----------------------------------------------------------------------------
+
+void CTextureStreamer::Create(const STextureStreamingSettings& _rSettings)
+{
+	Release();
+
+	m_Settings   = _rSettings;
+	m_LatencySum = 0.0;
+	m_IsStopping = false;
+
+	m_Settings.m_MinResidentSize = std::max(m_Settings.m_MinResidentSize, 1);
+	m_Settings.m_EvictionDelay   = std::max(m_Settings.m_EvictionDelay, 0);
+
+	memset(&m_Statistics, 0, sizeof(m_Statistics));
+
+	m_Statistics.m_BudgetInBytes = m_Settings.m_BudgetInBytes;
+
+	if(!MakeDirectory(m_Settings.m_CacheDirectory))
+	{
+		std::cout << "Can not create the texture cache directory " << m_Settings.m_CacheDirectory << ", textures are not streamed" << std::endl;
+	}
+
+	m_Worker = std::thread(&CTextureStreamer::RunWorker, this);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTextureStreamer::Release()
+{
+	if(m_Worker.joinable())
+	{
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+
+			m_IsStopping = true;
+		}
+
+		m_WorkAvailable.notify_all();
+
+		m_Worker.join();
+	}
+
+	m_Jobs    .clear();
+	m_Finished.clear();
+
+	for(BHandle pTexture : m_ReplacedTextures)
+	{
+		ReleaseTrackedTexture(pTexture);
+	}
+
+	for(STexture& rTexture : m_Textures)
+	{
+		ReleaseTrackedTexture(rTexture.m_pTexture);
+	}
+
+	m_ReplacedTextures.clear();
+	m_Textures        .clear();
+
+	m_Statistics.m_NumberOfTextures     = 0;
+	m_Statistics.m_NumberOfPendingLoads = 0;
+	m_Statistics.m_ResidentBytes        = 0;
+	m_Statistics.m_WantedBytes          = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+int CTextureStreamer::AddTexture(const char* _pPath)
+{
+	STexture Texture;
+	SDDSInfo Info;
+
+	Texture.m_Path             = _pPath;
+	Texture.m_Width            = 0;
+	Texture.m_Height           = 0;
+	Texture.m_pTexture         = nullptr;
+	Texture.m_MinResidentLevel = 0;
+	Texture.m_RequestedSize    = 0.0f;
+	Texture.m_CoarserFrames    = 0;
+
+	Texture.m_Residency.m_NumberOfLevels = 1;
+	Texture.m_Residency.m_ResidentLevel  = 0;
+	Texture.m_Residency.m_WantedLevel    = 0;
+	Texture.m_Residency.m_ResidentBytes  = 0;
+	Texture.m_Residency.m_IsStreamed     = false;
+	Texture.m_Residency.m_IsLoading      = false;
+
+	// -----------------------------------------------------------------------------
+	// Build the always resident levels right away. If the texture can not be
+	// streamed it is loaded as it is.
+	// -----------------------------------------------------------------------------
+	if(HasExtension(Texture.m_Path, ".dds") && ReadDDSInfo(_pPath, Info))
+	{
+		Texture.m_Info             = Info;
+		Texture.m_Width            = Info.m_Width;
+		Texture.m_Height           = Info.m_Height;
+		Texture.m_MinResidentLevel = GetNumberOfLevels(Info.m_Width, Info.m_Height) - GetNumberOfLevels(std::min(std::max(Info.m_Width, Info.m_Height), m_Settings.m_MinResidentSize), 1);
+
+		std::string CachePath = GetCachePath(Texture.m_Path, Texture.m_MinResidentLevel);
+
+		if(BuildLevels(Texture.m_Path, Texture.m_MinResidentLevel, CachePath))
+		{
+			CreateTrackedTexture(CachePath.c_str(), &Texture.m_pTexture, RESOURCE_SITE);
+
+			Texture.m_Residency.m_NumberOfLevels = GetNumberOfLevels(Info.m_Width, Info.m_Height);
+			Texture.m_Residency.m_ResidentLevel  = Texture.m_MinResidentLevel;
+			Texture.m_Residency.m_WantedLevel    = Texture.m_MinResidentLevel;
+			Texture.m_Residency.m_ResidentBytes  = GetLevelBytes(Texture, Texture.m_MinResidentLevel);
+			Texture.m_Residency.m_IsStreamed     = true;
+		}
+		else
+		{
+			std::cout << "Can not write " << CachePath << ", " << Texture.m_Path << " is not streamed" << std::endl;
+		}
+	}
+
+	if(Texture.m_pTexture == nullptr)
+	{
+		CreateTrackedTexture(_pPath, &Texture.m_pTexture, RESOURCE_SITE);
+	}
+
+	m_Textures.push_back(Texture);
+
+	m_Statistics.m_NumberOfTextures = static_cast<int>(m_Textures.size());
+	m_Statistics.m_ResidentBytes   += Texture.m_Residency.m_ResidentBytes;
+
+	return static_cast<int>(m_Textures.size()) - 1;
+}
+
+// -----------------------------------------------------------------------------
+
+BHandle CTextureStreamer::GetTexture(int _IndexOfTexture) const
+{
+	return m_Textures[_IndexOfTexture].m_pTexture;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTextureStreamer::RequestSize(int _IndexOfTexture, float _SizeInPixels)
+{
+	STexture& rTexture = m_Textures[_IndexOfTexture];
+
+	rTexture.m_RequestedSize = std::max(rTexture.m_RequestedSize, _SizeInPixels);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTextureStreamer::SetLevelBias(float _LevelBias)
+{
+	m_Settings.m_LevelBias = _LevelBias;
+}
+
+// -----------------------------------------------------------------------------
+
+bool CTextureStreamer::Update()
+{
+	std::vector<SLoad> Finished;
+
+	bool HasChanged = false;
+
+	// -----------------------------------------------------------------------------
+	// The materials were rebuilt with the new textures after the last update, so
+	// nothing uses the replaced ones anymore.
+	// -----------------------------------------------------------------------------
+	for(BHandle pTexture : m_ReplacedTextures)
+	{
+		ReleaseTrackedTexture(pTexture);
+	}
+
+	m_ReplacedTextures.clear();
+
+	// -----------------------------------------------------------------------------
+	// Take over the finished loads. Textures can only be created on this thread.
+	// -----------------------------------------------------------------------------
+	{
+		std::lock_guard<std::mutex> Lock(m_Mutex);
+
+		Finished.swap(m_Finished);
+	}
+
+	for(const SLoad& rLoad : Finished)
+	{
+		STexture& rTexture = m_Textures[rLoad.m_IndexOfTexture];
+
+		rTexture.m_Residency.m_IsLoading = false;
+
+		-- m_Statistics.m_NumberOfPendingLoads;
+
+		if(!rLoad.m_IsSuccessful)
+		{
+			std::cout << "Can not write " << rLoad.m_CachePath << ", " << rTexture.m_Path << " stays at level " << rTexture.m_Residency.m_ResidentLevel << std::endl;
+
+			// Keep what is resident and do not try again.
+			rTexture.m_Residency.m_IsStreamed = false;
+
+			continue;
+		}
+
+		BHandle pTexture = nullptr;
+
+		CreateTrackedTexture(rLoad.m_CachePath.c_str(), &pTexture, RESOURCE_SITE);
+
+		m_ReplacedTextures.push_back(rTexture.m_pTexture);
+
+		if(rLoad.m_Level > rTexture.m_Residency.m_ResidentLevel)
+		{
+			++ m_Statistics.m_NumberOfEvictions;
+		}
+
+		rTexture.m_pTexture                  = pTexture;
+		rTexture.m_Residency.m_ResidentLevel = rLoad.m_Level;
+		rTexture.m_Residency.m_ResidentBytes = GetLevelBytes(rTexture, rLoad.m_Level);
+
+		double Latency = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - rLoad.m_RequestTime).count();
+
+		++ m_Statistics.m_NumberOfLoads;
+
+		m_LatencySum += Latency;
+
+		m_Statistics.m_LastLatency    = Latency;
+		m_Statistics.m_AverageLatency = m_LatencySum / m_Statistics.m_NumberOfLoads;
+		m_Statistics.m_MaxLatency     = std::max(m_Statistics.m_MaxLatency, Latency);
+
+		HasChanged = true;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Derive the wanted level of each texture from the largest requested size.
+	// Textures without a request are not visible and only need their smallest
+	// levels.
+	// -----------------------------------------------------------------------------
+	size_t WantedBytes   = 0;
+	size_t ResidentBytes = 0;
+
+	for(STexture& rTexture : m_Textures)
+	{
+		if(rTexture.m_Residency.m_IsStreamed)
+		{
+			rTexture.m_Residency.m_WantedLevel = rTexture.m_RequestedSize > 0.0f ? GetNeededLevel(rTexture) : rTexture.m_MinResidentLevel;
+		}
+
+		rTexture.m_RequestedSize = 0.0f;
+
+		WantedBytes   += GetLevelBytes(rTexture, rTexture.m_Residency.m_WantedLevel);
+		ResidentBytes += rTexture.m_Residency.m_ResidentBytes;
+	}
+
+	// -----------------------------------------------------------------------------
+	// Coarsen the most expensive textures until the wanted levels fit into the
+	// budget. Each step halves the size of one texture.
+	// -----------------------------------------------------------------------------
+	while(WantedBytes > m_Settings.m_BudgetInBytes)
+	{
+		STexture* pLargest     = nullptr;
+		size_t    LargestBytes = 0;
+
+		for(STexture& rTexture : m_Textures)
+		{
+			size_t Bytes = GetLevelBytes(rTexture, rTexture.m_Residency.m_WantedLevel);
+
+			if(rTexture.m_Residency.m_IsStreamed && rTexture.m_Residency.m_WantedLevel < rTexture.m_MinResidentLevel && Bytes > LargestBytes)
+			{
+				pLargest     = &rTexture;
+				LargestBytes = Bytes;
+			}
+		}
+
+		if(pLargest == nullptr)
+		{
+			break;
+		}
+
+		++ pLargest->m_Residency.m_WantedLevel;
+
+		WantedBytes = WantedBytes - LargestBytes + GetLevelBytes(*pLargest, pLargest->m_Residency.m_WantedLevel);
+	}
+
+	// -----------------------------------------------------------------------------
+	// Finer levels are loaded right away. Coarser levels only replace the resident
+	// ones if they were wanted for a while or the memory is over the budget.
+	// -----------------------------------------------------------------------------
+	bool IsOverBudget = ResidentBytes > m_Settings.m_BudgetInBytes;
+
+	for(int IndexOfTexture = 0; IndexOfTexture < static_cast<int>(m_Textures.size()); ++ IndexOfTexture)
+	{
+		STexture&          rTexture   = m_Textures[IndexOfTexture];
+		STextureResidency& rResidency = rTexture.m_Residency;
+
+		if(!rResidency.m_IsStreamed || rResidency.m_IsLoading)
+		{
+			continue;
+		}
+
+		bool IsLoadNeeded = false;
+
+		if(rResidency.m_WantedLevel < rResidency.m_ResidentLevel)
+		{
+			IsLoadNeeded = true;
+		}
+		else if(rResidency.m_WantedLevel > rResidency.m_ResidentLevel)
+		{
+			++ rTexture.m_CoarserFrames;
+
+			IsLoadNeeded = IsOverBudget || rTexture.m_CoarserFrames > m_Settings.m_EvictionDelay;
+		}
+		else
+		{
+			rTexture.m_CoarserFrames = 0;
+		}
+
+		if(!IsLoadNeeded)
+		{
+			continue;
+		}
+
+		SLoad Load;
+
+		Load.m_IndexOfTexture = IndexOfTexture;
+		Load.m_Level          = rResidency.m_WantedLevel;
+		Load.m_SourcePath     = rTexture.m_Path;
+		Load.m_CachePath      = GetCachePath(rTexture.m_Path, rResidency.m_WantedLevel);
+		Load.m_RequestTime    = std::chrono::steady_clock::now();
+		Load.m_IsSuccessful   = false;
+
+		rResidency.m_IsLoading   = true;
+		rTexture.m_CoarserFrames = 0;
+
+		++ m_Statistics.m_NumberOfPendingLoads;
+
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+
+			m_Jobs.push_back(Load);
+		}
+
+		m_WorkAvailable.notify_one();
+	}
+
+	m_Statistics.m_ResidentBytes = 0;
+	m_Statistics.m_WantedBytes   = WantedBytes;
+
+	for(const STexture& rTexture : m_Textures)
+	{
+		m_Statistics.m_ResidentBytes += rTexture.m_Residency.m_ResidentBytes;
+	}
+
+	return HasChanged;
+}
+
+// -----------------------------------------------------------------------------
+
+const STextureResidency& CTextureStreamer::GetResidency(int _IndexOfTexture) const
+{
+	return m_Textures[_IndexOfTexture].m_Residency;
+}
+
+// -----------------------------------------------------------------------------
+
+const STextureStreamingStatistics& CTextureStreamer::GetStatistics() const
+{
+	return m_Statistics;
+}
+
+// -----------------------------------------------------------------------------
+
+void CTextureStreamer::PrintReport() const
+{
+	std::cout << "Texture streaming: " << m_Statistics.m_ResidentBytes / 1024 << " KB resident, " << m_Statistics.m_WantedBytes / 1024 << " KB wanted, budget " << m_Statistics.m_BudgetInBytes / 1024 << " KB" << std::endl;
+	std::cout << "    " << m_Statistics.m_NumberOfLoads << " loads, " << m_Statistics.m_NumberOfEvictions << " evictions, " << m_Statistics.m_NumberOfPendingLoads << " pending, latency ms: last " << m_Statistics.m_LastLatency << ", average " << m_Statistics.m_AverageLatency << ", max " << m_Statistics.m_MaxLatency << std::endl;
+
+	for(const STexture& rTexture : m_Textures)
+	{
+		const STextureResidency& rResidency = rTexture.m_Residency;
+
+		if(!rResidency.m_IsStreamed)
+		{
+			std::cout << "    " << rTexture.m_Path << ": not streamed" << std::endl;
+
+			continue;
+		}
+
+		std::cout << "    " << rTexture.m_Path << ": level " << rResidency.m_ResidentLevel << " (" << std::max(rTexture.m_Width >> rResidency.m_ResidentLevel, 1) << " x " << std::max(rTexture.m_Height >> rResidency.m_ResidentLevel, 1) << "), wanted " << rResidency.m_WantedLevel << ", " << rResidency.m_ResidentBytes / 1024 << " KB" << (rResidency.m_IsLoading ? ", loading" : "") << std::endl;
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+std::string CTextureStreamer::GetCachePath(const std::string& _rPath, int _Level) const
+{
+	size_t IndexOfName = _rPath.find_last_of("\\/");
+
+	std::string Name = IndexOfName == std::string::npos ? _rPath : _rPath.substr(IndexOfName + 1);
+
+	if(HasExtension(Name, ".dds"))
+	{
+		Name.resize(Name.size() - 4);
+	}
+
+	char Hash[16];
+
+	snprintf(Hash, sizeof(Hash), "%08x", GetPathHash(_rPath));
+
+	return m_Settings.m_CacheDirectory + "\\" + Name + "." + Hash + ".mip" + std::to_string(_Level) + ".dds";
+}
+
+// -----------------------------------------------------------------------------
+// A cache file from an earlier build can be used again if it is not older than
+// the source and has the size of the levels it should contain. The size also
+// catches files a crashed build left unfinished.
+// -----------------------------------------------------------------------------
+bool CTextureStreamer::IsCacheUpToDate(const std::string& _rPath, const SDDSInfo& _rInfo, int _Level, const std::string& _rCachePath)
+{
+	struct stat SourceStatus;
+	struct stat CacheStatus;
+
+	if(stat(_rPath.c_str(), &SourceStatus) != 0 || stat(_rCachePath.c_str(), &CacheStatus) != 0)
+	{
+		return false;
+	}
+
+	int Width          = std::max(_rInfo.m_Width  >> _Level, 1);
+	int Height         = std::max(_rInfo.m_Height >> _Level, 1);
+	int NumberOfLevels = GetNumberOfLevels(_rInfo.m_Width, _rInfo.m_Height) - _Level;
+
+	return CacheStatus.st_mtime >= SourceStatus.st_mtime && static_cast<size_t>(CacheStatus.st_size) == GetDDSFileSize(_rInfo, Width, Height, NumberOfLevels);
+}
+
+// -----------------------------------------------------------------------------
+// Writes the mip chain from the given level down to 1x1 into the cache file in
+// the format of the source. Levels stored in the source are copied, the missing
+// smaller ones are downsampled from the smallest stored level and encoded
+// again. Runs on the worker thread, except for the smallest levels which are
+// built when a texture is added.
+// -----------------------------------------------------------------------------
+bool CTextureStreamer::BuildLevels(const std::string& _rPath, int _Level, const std::string& _rCachePath)
+{
+	SDDSInfo Info;
+
+	if(!ReadDDSInfo(_rPath.c_str(), Info))
+	{
+		return false;
+	}
+
+	if(IsCacheUpToDate(_rPath, Info, _Level, _rCachePath))
+	{
+		return true;
+	}
+
+	std::vector<std::vector<unsigned char>> Levels;
+	std::vector<unsigned char>              Pixels;
+	std::vector<unsigned char>              Smaller;
+
+	int NumberOfLevels       = GetNumberOfLevels(Info.m_Width, Info.m_Height);
+	int NumberOfStoredLevels = std::min(static_cast<int>(Info.m_Levels.size()), NumberOfLevels);
+	int Width                = 0;
+	int Height               = 0;
+
+	for(int IndexOfLevel = std::min(_Level, NumberOfStoredLevels - 1); IndexOfLevel < NumberOfLevels; ++ IndexOfLevel)
+	{
+		std::vector<unsigned char> Data;
+
+		if(IndexOfLevel < NumberOfStoredLevels)
+		{
+			if(IndexOfLevel >= _Level && !ReadDDSLevelData(_rPath.c_str(), Info, IndexOfLevel, Data))
+			{
+				return false;
+			}
+
+			// The smallest stored level is the start of the missing ones.
+			if(IndexOfLevel == NumberOfStoredLevels - 1 && IndexOfLevel + 1 < NumberOfLevels)
+			{
+				if(!ReadDDSLevel(_rPath.c_str(), Info, IndexOfLevel, Pixels))
+				{
+					return false;
+				}
+
+				Width  = Info.m_Levels[IndexOfLevel].m_Width;
+				Height = Info.m_Levels[IndexOfLevel].m_Height;
+			}
+		}
+		else
+		{
+			Downsample(Pixels, Width, Height, Smaller);
+
+			Pixels.swap(Smaller);
+
+			Width  = std::max(Width  / 2, 1);
+			Height = std::max(Height / 2, 1);
+
+			if(IndexOfLevel >= _Level)
+			{
+				EncodeDDSLevel(Info, Width, Height, Pixels, Data);
+			}
+		}
+
+		if(IndexOfLevel >= _Level)
+		{
+			Levels.push_back(Data);
+		}
+	}
+
+	return WriteDDSLevels(_rCachePath.c_str(), Info, std::max(Info.m_Width >> _Level, 1), std::max(Info.m_Height >> _Level, 1), Levels);
+}
+
+// -----------------------------------------------------------------------------
+
+size_t CTextureStreamer::GetLevelBytes(const STexture& _rTexture, int _Level) const
+{
+	if(!_rTexture.m_Residency.m_IsStreamed && _rTexture.m_Width == 0)
+	{
+		return 0;
+	}
+
+	// The streamed levels keep the format of the source.
+	size_t Bytes = 0;
+
+	for(int IndexOfLevel = _Level; IndexOfLevel < GetNumberOfLevels(_rTexture.m_Width, _rTexture.m_Height); ++ IndexOfLevel)
+	{
+		Bytes += GetDDSLevelSize(_rTexture.m_Info, std::max(_rTexture.m_Width >> IndexOfLevel, 1), std::max(_rTexture.m_Height >> IndexOfLevel, 1));
+	}
+
+	return Bytes;
+}
+
+// -----------------------------------------------------------------------------
+// The finest level which still has at least one texel per pixel of the largest
+// instance on the screen.
+// -----------------------------------------------------------------------------
+int CTextureStreamer::GetNeededLevel(const STexture& _rTexture) const
+{
+	float TextureSize = static_cast<float>(std::max(_rTexture.m_Width, _rTexture.m_Height));
+	float Level       = floorf(log2f(TextureSize / std::max(_rTexture.m_RequestedSize, 1.0f)) + m_Settings.m_LevelBias);
+
+	return std::min(std::max(static_cast<int>(Level), 0), _rTexture.m_MinResidentLevel);
+}
+
+// -----------------------------------------------------------------------------
+
+void CTextureStreamer::RunWorker()
+{
+	for(;;)
+	{
+		SLoad Load;
+
+		{
+			std::unique_lock<std::mutex> Lock(m_Mutex);
+
+			m_WorkAvailable.wait(Lock, [this]() { return m_IsStopping || !m_Jobs.empty(); });
+
+			if(m_IsStopping)
+			{
+				return;
+			}
+
+			Load = m_Jobs.front();
+
+			m_Jobs.pop_front();
+		}
+
+		Load.m_IsSuccessful = BuildLevels(Load.m_SourcePath, Load.m_Level, Load.m_CachePath);
+
+		{
+			std::lock_guard<std::mutex> Lock(m_Mutex);
+
+			m_Finished.push_back(Load);
+		}
+	}
+}
@@ -0,0 +1,174 @@
+
+#pragma once
+
+#include "yoshix.h"
+#include "dds_file.h"
+
+#include <stddef.h>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Streams the mip levels of textures depending on how large they appear on the
+// screen. Most billboards are small or far away and only need a coarse level,
+// so keeping every texture at full resolution wastes texture memory.
+//
+// Each frame the application reports the projected size of the instances
+// using a texture. From the largest one the streamer derives the finest mip
+// level the texture needs. A worker thread writes the mip chain starting at
+// that level into a file in the cache directory ('name.1a2b3c4d.mip2.dds'). The
+// main thread then creates the YoshiX texture from it. YoshiX can only create
+// whole textures from files, so switching the level replaces the texture and
+// the materials using it have to be recreated.
+//
+// The cache files keep the format of the source, so DXT textures stay block
+// compressed. Levels stored in the source are copied as they are, only missing
+// smaller levels are built from the smallest stored one. A cache file newer
+// than its source and of the expected size is used again, also by later runs.
+//
+// Levels which are no longer needed are dropped after a delay, so a texture
+// does not flip between two levels. If the wanted levels of all textures do
+// not fit into the memory budget, the textures costing the most are coarsened
+// first. The smallest levels up to 'm_MinResidentSize' are always resident.
+//
+// Only uncompressed and DXT compressed DDS files are streamed. Other textures
+// are loaded as they are and never change.
+// -----------------------------------------------------------------------------
+
+struct STextureStreamingSettings
+{
+	STextureStreamingSettings();
+
+	size_t m_BudgetInBytes;             // The memory all streamed textures together may use.
+	int    m_MinResidentSize;           // Levels up to this width and height in pixels are always loaded.
+	int    m_EvictionDelay;             // The number of frames a finer level is kept after it is no longer needed.
+	float  m_LevelBias;                 // Added to the computed level, positive values load coarser levels.
+	std::string m_CacheDirectory;       // The directory of the cache files, created if it does not exist.
+};
+
+struct STextureResidency
+{
+	int    m_NumberOfLevels;            // The number of levels of the full mip chain.
+	int    m_ResidentLevel;             // The finest level currently loaded.
+	int    m_WantedLevel;               // The finest level needed by the last frames within the budget.
+	size_t m_ResidentBytes;             // The memory of the loaded levels.
+	bool   m_IsStreamed;
+	bool   m_IsLoading;
+};
+
+struct STextureStreamingStatistics
+{
+	int    m_NumberOfTextures;
+	int    m_NumberOfPendingLoads;      // Loads queued or running on the worker thread.
+	int    m_NumberOfLoads;             // Finished loads so far, including loads of coarser levels.
+	int    m_NumberOfEvictions;         // Loads which replaced a texture by a coarser level.
+	size_t m_ResidentBytes;             // The memory of all loaded levels.
+	size_t m_WantedBytes;               // The memory needed for the wanted levels.
+	size_t m_BudgetInBytes;
+	double m_LastLatency;               // Milliseconds from the request of a level until it was resident.
+	double m_AverageLatency;
+	double m_MaxLatency;
+};
+
+// Returns the height in pixels an object of the given world size appears with at the given distance.
+float GetProjectedSize(const float* _pProjectionMatrix, int _ScreenHeight, float _WorldSize, float _Distance);
+
+class CTextureStreamer
+{
+public:
+
+	CTextureStreamer();
+	~CTextureStreamer();
+
+public:
+
+	void Create(const STextureStreamingSettings& _rSettings);
+
+	// Releases all textures and stops the worker thread.
+	void Release();
+
+	// -----------------------------------------------------------------------------
+	// Adds a texture and loads its smallest levels right away, so it can be used
+	// immediately. Returns the index of the texture.
+	// -----------------------------------------------------------------------------
+	int AddTexture(const char* _pPath);
+
+	gfx::BHandle GetTexture(int _IndexOfTexture) const;
+
+	// Reports an instance using the texture with the given projected size in pixels.
+	void RequestSize(int _IndexOfTexture, float _SizeInPixels);
+
+	// Replaces 'm_LevelBias' of the settings, used from the next update on.
+	void SetLevelBias(float _LevelBias);
+
+	// -----------------------------------------------------------------------------
+	// Decides the wanted levels from the sizes requested since the last update,
+	// starts loads and takes over finished ones. Returns true if a texture handle
+	// changed and materials using it have to be recreated. The replaced handles
+	// are released with the next update.
+	// -----------------------------------------------------------------------------
+	bool Update();
+
+	const STextureResidency& GetResidency(int _IndexOfTexture) const;
+	const STextureStreamingStatistics& GetStatistics() const;
+
+	void PrintReport() const;
+
+private:
+
+	struct STexture
+	{
+		std::string       m_Path;
+		SDDSInfo          m_Info;               // The format of the source, which the cache files keep.
+		int               m_Width;              // The size of level 0.
+		int               m_Height;
+		gfx::BHandle      m_pTexture;
+		int               m_MinResidentLevel;   // The finest level which is always loaded.
+		float             m_RequestedSize;      // The largest size requested since the last update.
+		int               m_CoarserFrames;      // The number of frames in a row a coarser level was wanted.
+		STextureResidency m_Residency;
+	};
+
+	struct SLoad
+	{
+		int                                   m_IndexOfTexture;
+		int                                   m_Level;
+		std::string                           m_SourcePath;
+		std::string                           m_CachePath;
+		std::chrono::steady_clock::time_point m_RequestTime;
+		bool                                  m_IsSuccessful;
+	};
+
+private:
+
+	static bool IsCacheUpToDate(const std::string& _rPath, const SDDSInfo& _rInfo, int _Level, const std::string& _rCachePath);
+	static bool BuildLevels(const std::string& _rPath, int _Level, const std::string& _rCachePath);
+
+	std::string GetCachePath(const std::string& _rPath, int _Level) const;
+
+	size_t GetLevelBytes(const STexture& _rTexture, int _Level) const;
+	int GetNeededLevel(const STexture& _rTexture) const;
+
+	void RunWorker();
+
+private:
+
+	STextureStreamingSettings   m_Settings;
+	std::vector<STexture>       m_Textures;
+	std::vector<gfx::BHandle>   m_ReplacedTextures;     // Released with the next update.
+	double                      m_LatencySum;
+	STextureStreamingStatistics m_Statistics;
+
+	// The state shared with the worker thread, guarded by 'm_Mutex'.
+	std::thread                 m_Worker;
+	std::mutex                  m_Mutex;
+	std::condition_variable     m_WorkAvailable;
+	std::deque<SLoad>           m_Jobs;
+	std::vector<SLoad>          m_Finished;
+	bool                        m_IsStopping;
+};
@@ -0,0 +1,68 @@
+
+#include "billboard_polygon.h"
+#include "mesh_import.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <iostream>
+
+// -----------------------------------------------------------------------------
+// Command line tool which analyzes the alpha channel of billboard textures and
+// prints the tight polygon for each of them.
+//
+//     trim [-v <max vertices>] [-t <alpha threshold 0..1>] <texture.dds> ...
+// -----------------------------------------------------------------------------
+int main(int _NumberOfArguments, char** _ppArguments)
+{
+	SBillboardPolygonSettings Settings;
+
+	int NumberOfTextures = 0;
+
+	for(int IndexOfArgument = 1; IndexOfArgument < _NumberOfArguments; ++ IndexOfArgument)
+	{
+		const char* pArgument = _ppArguments[IndexOfArgument];
+
+		if(strcmp(pArgument, "-v") == 0 && IndexOfArgument + 1 < _NumberOfArguments)
+		{
+			Settings.m_MaxNumberOfVertices = atoi(_ppArguments[++ IndexOfArgument]);
+
+			continue;
+		}
+
+		if(strcmp(pArgument, "-t") == 0 && IndexOfArgument + 1 < _NumberOfArguments)
+		{
+			Settings.m_AlphaThreshold = static_cast<float>(atof(_ppArguments[++ IndexOfArgument]));
+
+			continue;
+		}
+
+		SBillboardPolygon Polygon;
+
+		if(!BuildBillboardPolygon(pArgument, Settings, Polygon))
+		{
+			continue;
+		}
+
+		PrintBillboardPolygonReport(pArgument, Polygon);
+
+		// Print position and texture coordinate of each vertex, the tangent frame
+		// is the same for all of them.
+		for(int IndexOfVertex = 0; IndexOfVertex < Polygon.GetNumberOfVertices(); ++ IndexOfVertex)
+		{
+			const float* pVertex = &Polygon.m_Vertices[IndexOfVertex * g_NumberOfFloatsPerImportedVertex];
+
+			std::cout << "    { " << pVertex[0] << ", " << pVertex[1] << " }  uv { " << pVertex[12] << ", " << pVertex[13] << " }" << std::endl;
+		}
+
+		++ NumberOfTextures;
+	}
+
+	if(NumberOfTextures == 0)
+	{
+		std::cout << "Usage: trim [-v <max vertices>] [-t <alpha threshold 0..1>] <texture.dds> ..." << std::endl;
+
+		return 1;
+	}
+
+	return 0;
+}